@@ -0,0 +1,71 @@
+#ifndef ALGORITHMPLUGINS_H
+#define ALGORITHMPLUGINS_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QPoint>
+#include "pathsearch.h"
+#include "gridmapplugin.h"
+
+class QLibrary;
+
+// 原生寻路插件（接口见 gridmapplugin.h）：每个插件占用一个 PathSearch::FirstPlugin 之后的算法编号
+// 只在启动时加载，之后只读，可以在任意线程中查询和调用；插件不会卸载
+class AlgorithmPlugins
+{
+    Q_DECLARE_TR_FUNCTIONS(AlgorithmPlugins)
+
+public:
+    static const int kMaxPlugins = 64;
+
+    static AlgorithmPlugins& instance();
+
+    // 加载默认目录中的插件：程序目录下的 plugins，以及 GRIDMAP_PLUGIN_PATH 列出的目录
+    // 只在第一次调用时扫描，失败的插件写入日志
+    void loadDefaultPlugins();
+    // 加载目录中的全部动态库，返回新加载的插件数；errors 收集无法加载的文件和原因
+    int loadDirectory(const QString& path, QStringList* errors = nullptr);
+    static QStringList defaultDirectories();
+
+    int count() const { return plugins.size(); }
+    QList<PathSearch::AlgorithmType> algorithms() const;
+    bool contains(PathSearch::AlgorithmType algorithm) const;
+    // 按名称查找（不区分大小写），找不到时返回 PathSearch::Unknown
+    PathSearch::AlgorithmType find(const QString& name) const;
+    QString name(PathSearch::AlgorithmType algorithm) const;
+    QString fileName(PathSearch::AlgorithmType algorithm) const;
+
+    // 在按行存放的栅格上调用插件（cells[y * stride + x]，只有 1 不可通行），这里不再拷贝 cells
+    // 成功运行时返回 true，path 为空表示未找到路径；插件报告错误时返回 false
+    bool search(PathSearch::AlgorithmType algorithm,
+                const quint8* cells,
+                int rows,
+                int cols,
+                int stride,
+                const QPoint& start,
+                const QPoint& end,
+                QList<QPoint>* path,
+                PathSearch::SearchStats* stats,
+                QString* error) const;
+
+private:
+    struct Plugin {
+        QLibrary* library = nullptr;
+        QString name;
+        gmp_search_fn search = nullptr;
+    };
+
+    AlgorithmPlugins();
+    Q_DISABLE_COPY(AlgorithmPlugins)
+
+    bool loadLibrary(const QString& filePath, QString* error);
+    const Plugin* plugin(PathSearch::AlgorithmType algorithm) const;
+
+    QVector<Plugin> plugins;
+    bool defaultsLoaded;
+};
+
+#endif // ALGORITHMPLUGINS_H
@@ -0,0 +1,26 @@
+#ifndef CHUNKEDSEARCH_H
+#define CHUNKEDSEARCH_H
+
+#include <QList>
+#include <QPoint>
+#include "pathsearch.h"
+
+class GridMap;
+
+// 直接在 GridMap 的块上运行内置算法（PathSearch::ChunkedLayout）：
+// 格子按块读取，整块同一个值的块不展开；工作记录也按地图块分配，只有搜索到的块才占内存
+// 展开成带边框的连续栅格放不下（或太占内存）的大地图用它运行，扩展顺序、路径和各项计数与 SearchKernel 相同
+class ChunkedSearch
+{
+public:
+    // algorithm 是 AStar、Dijkstra、BFS、DFS 或 DStar，其他算法返回空列表
+    // trace 按整张地图分配，只在地图不大时传入
+    static QList<QPoint> run(PathSearch::AlgorithmType algorithm,
+                             const GridMap& grid,
+                             const QPoint& start,
+                             const QPoint& end,
+                             PathSearch::SearchStats* stats,
+                             PathSearch::ExpansionTrace* trace);
+};
+
+#endif // CHUNKEDSEARCH_H
@@ -0,0 +1,74 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QList>
+#include <QVector>
+#include <QRect>
+
+class GridMap;
+
+// 编辑记录（撤销/重做）：只记录变化的格子，不保存整张地图
+// 一次鼠标拖动（或一次清空、生成）是一个编辑，编辑内同一行上相邻、前后取值相同的格子合并成一段
+// 所有编辑占用的内存不超过预算，超出时丢弃最早的编辑；撤销和重做只写回记录的格子，耗时与改动的格子数成正比
+// 路径显示的取值（Path、Current、VisitedPath）按空地记录，撤销不会恢复已经清除的路径
+class EditJournal
+{
+public:
+    // 同一行上从 (x, y) 开始的 length 个格子从 before 改成了 after
+    struct Run {
+        quint32 x;
+        quint32 y;
+        quint16 length;
+        quint8 before;
+        quint8 after;
+    };
+
+    static constexpr qint64 DefaultBudgetBytes = 16 * 1024 * 1024;
+
+    EditJournal();
+
+    void clear();
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return budgetBytes; }
+    qint64 memoryBytes() const { return usedBytes; }
+    bool canUndo() const { return !undoEdits.isEmpty(); }
+    bool canRedo() const { return !redoEdits.isEmpty(); }
+    int undoCount() const { return undoEdits.size(); }
+
+    // 开始和结束一个编辑，之间记录的改动一起撤销；没有开始编辑时 record 单独成为一个编辑
+    void beginEdit();
+    void endEdit();
+    bool isRecording() const { return recording; }
+    void record(int x, int y, int before, int after);
+    // 把 before 到 after 的全部差异记为一个编辑（两者尺寸相同）：只比较不共享存储的块，
+    // 整块同一个值的块按行整段记录
+    void recordDiff(const GridMap& before, const GridMap& after);
+
+    // 撤销（重做）一个编辑：写回格子并收回整块同一个值的块，changed 收到改动的行段
+    bool undo(GridMap* grid, QVector<Run>* changed);
+    bool redo(GridMap* grid, QVector<Run>* changed);
+
+    static QRect runRect(const Run& run) { return QRect(int(run.x), int(run.y), run.length, 1); }
+
+private:
+    struct Edit {
+        QVector<Run> runs;
+    };
+
+    static int journalValue(int value);
+    static qint64 editBytes(const Edit& edit);
+    void append(int x, int y, int length, int before, int after);
+    void commit();
+    void trim();
+    static void apply(GridMap* grid, const Edit& edit, bool forward);
+
+    QList<Edit> undoEdits;             // 最早的编辑在前
+    QList<Edit> redoEdits;             // 最近撤销的编辑在后
+    Edit pending;                      // 正在记录的编辑
+    bool recording;
+    bool overflow;                     // 正在记录的编辑已超出预算，结束时丢弃全部记录
+    qint64 budgetBytes;
+    qint64 usedBytes;                  // undoEdits 和 redoEdits 占用的字节数
+};
+
+#endif // EDITJOURNAL_H
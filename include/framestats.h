@@ -0,0 +1,46 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QStringList>
+
+// 界面性能计数：重绘耗时、绘制的格子数、每秒重新规划次数、编辑到新路径的延迟和事件循环卡顿分布
+// 只做计数和简单统计，由 GridEditor 在性能信息浮层中显示
+class FrameStats
+{
+public:
+    static const int StallBuckets = 6;
+
+    FrameStats();
+
+    void reset();
+    qint64 now() const { return clock.nsecsElapsed(); }
+
+    void addPaint(qint64 durationNs, int cellsDrawn);
+    void markEdit();                       // 栅格被编辑并且会重新规划
+    void cancelEdit();                     // 不再等待新路径（退出代码执行模式等）
+    void addReplan();                      // 收到新路径；若有未完成的编辑则记录延迟
+    void keepPath();                       // 编辑不影响当前路径，跳过了重新规划
+    void addTick(qint64 intervalNs);       // 事件循环探针：按定时器的延迟计入卡顿分布
+
+    QStringList summary() const;           // 浮层中显示的文字，每项一行
+
+private:
+    static int stallBucket(qint64 lateNs);
+    void pruneReplans(qint64 nowNs) const;
+
+    QElapsedTimer clock;
+    qint64 lastPaintNs;
+    double averagePaintNs;                 // 指数滑动平均
+    int lastCellsDrawn;
+    mutable QQueue<qint64> replanTimes;    // 最近一秒内的重新规划时刻
+    qint64 pendingEditNs;                  // 尚未得到新路径的最早一次编辑，-1 表示没有
+    qint64 editToPathNs;
+    int keptPaths;                         // 跳过的重新规划次数
+    qint64 lastTickNs;
+    qint64 maxStallNs;
+    int stallCounts[StallBuckets];
+};
+
+#endif // FRAMESTATS_H
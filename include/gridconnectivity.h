@@ -0,0 +1,67 @@
+#ifndef GRIDCONNECTIVITY_H
+#define GRIDCONNECTIVITY_H
+
+#include <QVector>
+#include <QPoint>
+#include <QList>
+
+// 栅格连通性引擎：在拆点后的栅格图上维护起点到终点的最大流
+// 每个普通格子拆成入点和出点，入点->出点容量为1，因此流量即为顶点不相交通路的数量
+// 障碍物的增删只修复受影响的那一条流路径，不需要对每个候选格子重新计算最大流
+class GridConnectivity
+{
+public:
+    // blocked[y][x] 为 true 表示障碍；limit 为需要维护的最大通路数量上限
+    GridConnectivity(const QVector<QVector<bool>>& blocked,
+                     const QPoint& start,
+                     const QPoint& end,
+                     int limit);
+
+    int flow() const { return flowValue; }          // 当前不相交通路数量（不超过上限）
+    int limit() const { return flowLimit; }
+    bool isBlocked(const QPoint& pos) const;
+    bool carriesFlow(const QPoint& pos) const;     // 该格子是否位于某条流路径上
+
+    int block(const QPoint& pos);                   // 设置障碍，返回新的通路数量
+    int unblock(const QPoint& pos);                 // 清除障碍，返回新的通路数量
+
+    QList<QPoint> flowCells() const;                // 所有位于流路径上的普通格子
+
+    // 最小顶点割：阻断这些格子即可使起点与终点不连通
+    // 需要在未设上限（limit不小于4）的最大流上调用；起点与终点相邻时不存在顶点割，返回空列表
+    QList<QPoint> minimumCut();
+
+private:
+    enum Direction { Up = 0, Right = 1, Down = 2, Left = 3 };
+
+    int index(int x, int y) const { return y * cols + x; }
+    int neighbor(int cell, int dir) const;          // 越界返回 -1
+    bool isTerminal(int cell) const { return cell == source || cell == sink; }
+
+    // 残量网络上的BFS，结果记录在visitStamp中
+    // uncappedEdges为true时把格子之间的边视为无穷容量，用于求只由格子组成的最小割
+    bool residualSearch(int fromNode, int toNode, bool uncappedEdges = false);
+    void applyPath(int toNode);                     // 沿搜索树把找到的路径写入流量
+    bool augment();                                 // 在残量网络中寻找一条增广路
+    bool rerouteAround(int cell);                   // 在局部绕开一个被阻断的流路径格子
+    void cancelFlowThrough(int cell);               // 撤销经过该格子的一单位流量
+    void recountFlow();
+
+    int rows;
+    int cols;
+    int source;
+    int sink;
+    int flowLimit;
+    int flowValue;
+
+    QVector<quint8> blockedCells;                   // 障碍标记
+    QVector<quint8> innerFlow;                      // 入点->出点的流量（0或1）
+    QVector<quint8> edgeFlow;                       // 出点->相邻入点的流量，按方向存储 cell*4+dir
+
+    // 增广搜索的工作区，按代数标记避免每次清空
+    QVector<int> visitStamp;                        // 节点编号 cell*2+side
+    QVector<int> parentNode;
+    int currentStamp;
+};
+
+#endif // GRIDCONNECTIVITY_H
@@ -8,6 +8,16 @@
 #include <QString>
 #include <QTimer>
 #include <QList>
+#include <QColor>
+#include <QImage>
+#include "gridmap.h"
+#include "pathsearch.h"
+#include "framestats.h"
+#include "editjournal.h"
+
+class ObstacleGenerator;
+class SearchDebugger;
+class QPainter;
 
 class GridEditor : public QWidget
 {
@@ -24,6 +34,12 @@ public:
         VisitedPath = 6 // 小车走过的路径（绿色）
     };
 
+    // 扩展热力图的着色方式
+    enum HeatmapMode {
+        ExpansionOrder = 0, // 按首次扩展的先后
+        ExpansionCount = 1  // 按扩展次数
+    };
+
     explicit GridEditor(QWidget *parent = nullptr);
 
     void createGrid(int rows, int cols);
@@ -32,11 +48,21 @@ public:
     CellState getCellState(const QPoint& pos) const;
     void setCurrentState(CellState state) { currentState = state; }
 
+    // 撤销和重做：一次鼠标拖动、一次清空或生成是一步，只写回这一步改动的格子
+    // 代码执行模式下不能撤销；预算默认 16 MB，可以用环境变量 GRIDMAP_UNDO_BUDGET_MB 设置
+    bool undo();
+    bool redo();
+    bool canUndo() const { return !codeExecutionMode && journal.canUndo(); }
+    bool canRedo() const { return !codeExecutionMode && journal.canRedo(); }
+    void setUndoBudget(qint64 bytes);
+    qint64 undoBudget() const { return journal.budget(); }
+
     // 新增：保存和读取地图的方法声明
     bool saveToJson(const QString& filename) const;
     bool loadFromJson(const QString& filename);
     
     // 路径执行功能
+    // 小车行进中收到从它走过的某个格子出发的路径（重新规划的结果）时接在走过的路线后面继续，不回到起点
     void executePathfinding(const QList<QPoint>& path);
     void clearPath();
     void clearPathSilently(); // 静默清除路径，不发出信号
@@ -44,17 +70,51 @@ public:
     void stopExecutionSilently(); // 静默停止执行，用于正常完成的情况
     QPoint getStartPos() const { return startPos; }
     QPoint getEndPos() const { return endPos; }
-    QVector<QVector<int>> getGridData() const;
+    const GridMap& gridMap() const { return grid; }   // 格子存储本身，不拷贝
+    GridSnapshot snapshot() const { return grid.snapshot(); }   // 当前版本的只读快照，O(1)
     bool hasValidStartAndEnd() const;
     
-    // 随机障碍生成
-    void generateRandomObstacles(double density, int connectivityType, int pathCount, bool useSeed, int seed);
+    // 随机障碍生成，返回实际保证的不相交通路数量
+    int generateRandomObstacles(double density, int connectivityType, int pathCount, bool useSeed, int seed);
+    
+    // 程序化生成（迷宫、洞穴、房间），pattern 取 ObstacleGenerator::Pattern，返回起点终点是否连通
+    bool generateProceduralMap(int pattern, double density, bool useSeed, int seed);
+    
+    // 叠加显示多条路径（算法竞速），每条路径一种颜色，不改变栅格状态
+    void setOverlayPaths(const QList<QList<QPoint>>& paths, const QList<QColor>& colors);
+    void clearOverlayPaths();
+    
+    // 节点扩展热力图：trace 来自寻路算法的扩展记录，着色结果缓存为每格一个像素的图像
+    void setExpansionHeatmap(const PathSearch::ExpansionTrace& trace);
+    void clearExpansionHeatmap();
+    void setHeatmapMode(HeatmapMode mode);
+    
+    // 单步调试：显示开放列表、已扩展的格子和当前扩展的格子，每次暂停只重绘状态变化的格子
+    void updateSearchDebug(const SearchDebugger& debugger, const QList<QPoint>& changedCells);
+    void clearSearchDebug();
+    
+    // 扩展断点：Ctrl+左键点击格子切换，单步调试运行到断点时在扩展这些格子后暂停
+    void toggleBreakpoint(const QPoint& pos);
+    void clearBreakpoints();
+    const QList<QPoint>& breakpoints() const { return breakpointCells; }
+    
+    // 性能信息浮层：重绘耗时、重新规划频率、编辑到新路径的延迟和事件循环卡顿
+    void setPerformanceHudVisible(bool visible);
+    bool isPerformanceHudVisible() const { return hudVisible; }
     
     // 执行状态管理
     void setCodeExecutionMode(bool enabled);
     bool isInExecutionMode() const { return codeExecutionMode; }
     bool hasPath() const; // 检查是否有路径显示
     bool isCarMoving() const { return isExecuting; } // 检查小车是否正在移动
+    // 实时重新规划前检查正在通知的这次编辑（只在 setCellState 发出的 gridChanged 处理期间有效）：
+    // 新障碍不在剩余路线上，或者移除的障碍离得太远、经过它的路线不可能更短时返回 true，
+    // 这时单位代价的最短路径算法得到的路线长度不变，当前路线可以保留
+    bool lastEditKeepsShortestPath() const;
+    void keepCurrentPath();            // 不重新规划，继续沿当前路线行进
+    void markReplanRequested();        // 这次编辑会重新规划，从现在开始计算编辑到新路径的延迟
+    bool isCarEnRoute() const { return isExecuting && currentStep > 0 && currentStep < currentPath.size(); } // 出发后还没到终点
+    QPoint getCarPos() const { return currentCarPos; }
     QString getLastErrorMessage() const { return lastErrorMessage; } // 获取最后的错误信息
 
 signals:
@@ -62,18 +122,21 @@ signals:
     void executionError(const QString& message);
     void gridChanged(); // 栅格发生变化时发出的信号
     void pathCleared(); // 路径被清除时发出的信号
+    void undoStateChanged(); // 能否撤销、重做可能变化
 
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private slots:
     void moveToNextPosition();
+    void onHudTick();
 
 private:
-    QVector<QVector<CellState>> grid;  // 存储栅格状态
+    GridMap grid;                      // 存储栅格状态
     int rows;                          // 行数
     int cols;                          // 列数
     int cellSize;                      // 单元格大小
@@ -92,21 +155,51 @@ private:
     bool isExecuting;                  // 是否正在执行
     bool codeExecutionMode;            // 是否处于代码执行模式
     QString lastErrorMessage;           // 存储最后的错误信息
+    QPoint editPos;                    // 正在通知的编辑，editPending 为 false 时无效
+    CellState editOldState;
+    CellState editNewState;
+    bool editPending;
+    EditJournal journal;               // 撤销记录
+    
+    // 叠加路径
+    QList<QList<QPoint>> overlayPaths;
+    QList<QColor> overlayColors;
+    
+    // 扩展热力图
+    PathSearch::ExpansionTrace heatmapTrace;
+    QImage heatmapImage;
+    HeatmapMode heatmapMode;
+    
+    // 单步调试
+    QImage searchDebugImage;           // 每格一个像素：开放列表和已扩展的格子
+    QPoint searchDebugCurrent;         // 当前扩展的格子
+    QList<QPoint> breakpointCells;
+    
+    // 性能信息浮层
+    FrameStats frameStats;
+    bool hudVisible;
+    QTimer* hudTimer;                  // 事件循环探针
+    int hudTickCount;
+    QRect hudRect;                     // 浮层占用的区域，刷新浮层时只重绘这里
 
     void updateCellSize();             // 更新单元格大小
     void updateGridOffset();           // 更新栅格偏移量
     QPoint pixelToGrid(const QPoint& pixel) const;  // 像素坐标转换为栅格坐标
     bool isValidGridPos(const QPoint& pos) const;   // 检查栅格坐标是否有效
+    QRect cellRect(const QPoint& pos) const;        // 格子在控件中的区域
     void loadImages();                 // 加载图片资源
+    void paintCell(QPainter& painter, int x, int y, int state);            // 绘制一个格子
+    void paintUniformCells(QPainter& painter, const QRect& cells, int state); // 绘制整块同一个值的格子区域
+    bool clearPathCells();             // 路径相关的格子改回空地，返回是否有改动
+    void drawOverlayPaths(QPainter& painter);       // 绘制叠加路径
+    void drawSearchDebug(QPainter& painter);        // 绘制单步调试状态和断点
+    void rebuildHeatmapImage();                     // 按当前着色方式重建热力图缓存
+    void drawPerformanceHud(QPainter& painter);     // 绘制性能信息浮层
     void handleRightClick(const QPoint& pos);       // 处理右键点击
-    
-    // 随机障碍生成的辅助方法
-    void generateObstaclesWithNoPath(class QRandomGenerator* generator, int targetObstacles);
-    void generateObstaclesWithOnePath(class QRandomGenerator* generator, int targetObstacles);
-    void generateObstaclesWithMultiplePaths(class QRandomGenerator* generator, int targetObstacles, int pathCount);
-    bool isPathExists(const QPoint& start, const QPoint& end);
-    QList<QPoint> findPathBFS(const QPoint& start, const QPoint& end);
-    int countPaths(const QPoint& start, const QPoint& end);
+    bool validatePath(const QList<QPoint>& path);   // 坐标有效、不经过障碍并且连续，否则发出 executionError
+    void spliceRemainingPath(const QList<QPoint>& path, int from); // 小车从 currentPath[from] 改走 path
+    void applyGeneratedObstacles(const ObstacleGenerator& obstacleGenerator); // 写回生成结果
+    void applyJournalRuns(const QVector<EditJournal::Run>& runs, bool forward); // 撤销或重做之后更新起点终点并重绘改动的格子
 };
 
 #endif // GRIDEDITOR_H 
\ No newline at end of file
@@ -0,0 +1,167 @@
+#ifndef GRIDMAP_H
+#define GRIDMAP_H
+
+#include <QVector>
+#include <QPoint>
+#include <QMutex>
+#include <QSharedPointer>
+
+class GridSnapshot;
+
+// 栅格地图存储，只依赖 Qt Core
+// 格子按 ChunkSize × ChunkSize 的块存放：整块都是同一个值的块只记录这个值，不分配格子，
+// 有不同取值的块才分配一份隐式共享的存储。内存随地图的复杂程度而不是面积增长，大片空地几乎不占内存
+// 拷贝 GridMap（快照）是 O(1) 的；块表按块行两级存放，每一行块和每一块的格子都单独隐式共享，
+// 快照后第一次写入某一块只复制行表、这一行块的表头和这一块的格子，与地图面积无关
+class GridMap
+{
+public:
+    // 格子取值，与 GridEditor::CellState 和地图文件一致
+    enum Cell {
+        Empty = 0,
+        Obstacle = 1,
+        Start = 2,
+        End = 3,
+        Path = 4,
+        Current = 5,
+        VisitedPath = 6
+    };
+
+    static constexpr int ChunkShift = 6;
+    static constexpr int ChunkSize = 1 << ChunkShift;
+    // 展开成一块连续内存（算法的带边框栅格、插件的栅格）时格子数的上限
+    static constexpr qint64 MaxContiguousCells = 0x7fffffff / 2;
+
+    GridMap();
+    GridMap(int rows, int cols, int value = Empty);
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    bool isEmpty() const { return rowCount <= 0 || colCount <= 0; }
+    bool contains(int x, int y) const { return x >= 0 && x < colCount && y >= 0 && y < rowCount; }
+    bool contains(const QPoint& pos) const { return contains(pos.x(), pos.y()); }
+    // 带一圈边框展开后不超过 MaxContiguousCells，内置算法和插件可以在整张地图上运行
+    bool fitsContiguous() const { return qint64(rowCount + 2) * (colCount + 2) <= MaxContiguousCells; }
+
+    int cell(int x, int y) const
+    {
+        const Chunk& chunk = chunkAt(x >> ChunkShift, y >> ChunkShift);
+        return chunk.cells.isEmpty() ? chunk.value : chunk.cells.at(chunkOffset(x, y));
+    }
+    int cell(const QPoint& pos) const { return cell(pos.x(), pos.y()); }
+    void setCell(int x, int y, int value)
+    {
+        const Chunk& current = chunkAt(x >> ChunkShift, y >> ChunkShift);
+        if (current.cells.isEmpty() && current.value == value) {
+            return;  // 整块已经是这个值，不分配格子
+        }
+        Chunk& chunk = chunks[y >> ChunkShift][x >> ChunkShift];
+        if (chunk.cells.isEmpty()) {
+            chunk.cells.fill(chunk.value, ChunkSize * ChunkSize);
+        }
+        chunk.cells[chunkOffset(x, y)] = static_cast<quint8>(value);
+        stamp = 0;
+    }
+    void setCell(const QPoint& pos, int value) { setCell(pos.x(), pos.y(), value); }
+    bool isBlocked(int x, int y) const { return cell(x, y) == Obstacle; }
+
+    void fill(int value);
+    // 把所有取值为 from 的格子改成 to，返回改动的格子数；整块的值直接修改，不逐个格子写入
+    qint64 replace(int from, int to);
+    // 是否有取值为 value 的格子；整块的值不用逐个格子检查
+    bool containsValue(int value) const;
+    // 把与 area 相交的块中已经变成同一个值的块收回成只记录这个值
+    void compact(int left, int top, int width, int height);
+    void compact() { compact(0, 0, colCount, rowCount); }
+
+    // 版本号：写入后第一次查询时取一个新的全局唯一值，版本号相同的两个 GridMap 内容一定相同
+    quint64 version() const;
+    // 当前内容的只读快照
+    GridSnapshot snapshot() const;
+
+    // 按块访问：块 (chunkX, chunkY) 覆盖 x / ChunkSize == chunkX、y / ChunkSize == chunkY 的格子，
+    // 块内按行存放（下标 (y % ChunkSize) * ChunkSize + x % ChunkSize），超出地图的部分不使用
+    int chunkCols() const { return chunkColCount; }
+    int chunkRows() const { return chunkRowCount; }
+    // 整块同一个值时返回空指针，值由 chunkValue 给出
+    const quint8* chunkData(int chunkX, int chunkY) const
+    {
+        const Chunk& chunk = chunkAt(chunkX, chunkY);
+        return chunk.cells.isEmpty() ? nullptr : chunk.cells.constData();
+    }
+    int chunkValue(int chunkX, int chunkY) const { return chunkAt(chunkX, chunkY).value; }
+    // 整块写入（按块读取地图文件时使用）：cells 为空时整块都是 value，否则是 ChunkSize × ChunkSize 个格子，
+    // 直接共享这份存储；写入后整块同一个值的块收回
+    void setChunk(int chunkX, int chunkY, int value, const QVector<quint8>& cells = QVector<quint8>());
+    bool isUniformChunk(int chunkX, int chunkY) const { return chunkData(chunkX, chunkY) == nullptr; }
+    // 两个 GridMap（同一地图的不同版本）的这一块是否是同一份存储或同一个值，是则内容一定相同
+    bool sharesChunk(const GridMap& other, int chunkX, int chunkY) const;
+    // 分配了格子的块数，以及格子存储占用的字节数（共享的块按各自一份计算）
+    int allocatedChunks() const;
+    qint64 memoryBytes() const;
+
+    // 第 y 行的 cols() 个格子写入 target
+    void readRow(int y, quint8* target) const;
+    // 按行连续存放的格子（下标 y * cols + x），需要一块连续内存的调用方（插件）使用
+    QVector<quint8> toRowMajor() const;
+
+    // 内置算法使用的栅格：0-可通行，1-障碍（只有障碍不可通行）
+    QVector<QVector<int>> toSearchGrid() const;
+
+    // 与 MapFile::MapData::cells 互相转换
+    QVector<QVector<int>> toCells() const;
+    static GridMap fromCells(const QVector<QVector<int>>& cells);
+
+private:
+    struct Chunk {
+        QVector<quint8> cells;     // 为空表示整块都是 value
+        quint8 value = Empty;
+    };
+
+    const Chunk& chunkAt(int chunkX, int chunkY) const { return chunks.at(chunkY).at(chunkX); }
+    static int chunkOffset(int x, int y) { return ((y & (ChunkSize - 1)) << ChunkShift) | (x & (ChunkSize - 1)); }
+    // 块在地图内的部分的宽和高（右边和下边的块可能不满）
+    int chunkWidth(int chunkX) const { return qMin(ChunkSize, colCount - (chunkX << ChunkShift)); }
+    int chunkHeight(int chunkY) const { return qMin(ChunkSize, rowCount - (chunkY << ChunkShift)); }
+    bool compactChunk(int chunkX, int chunkY);
+
+    int rowCount;
+    int colCount;
+    int chunkColCount;
+    int chunkRowCount;
+    QVector<QVector<Chunk>> chunks;    // chunks[chunkY][chunkX]
+    mutable quint64 stamp;             // 0 表示写入后还没有取版本号
+};
+
+// 某个版本的栅格的只读快照：与产生它的 GridMap 共享格子块，拷贝或交给工作线程都是 O(1)
+// 原来的 GridMap 之后写入时复制被写的块，快照的内容和版本号都不变，可以在多个线程中同时读取
+class GridSnapshot
+{
+public:
+    GridSnapshot() : stamp(0) {}
+
+    const GridMap& map() const { return grid; }
+    quint64 version() const { return stamp; }
+    bool isEmpty() const { return grid.isEmpty(); }
+
+    // 同 GridMap::toRowMajor，但第一次调用时才展开，之后同一快照的所有拷贝共用这一份（可以在多个线程中同时调用）
+    // 插件在同一版本的地图上反复运行（竞速、实时重新规划）时不再每次复制整张地图
+    QVector<quint8> rowMajor() const;
+
+private:
+    friend class GridMap;
+    struct RowMajorCache {
+        QMutex mutex;
+        bool ready = false;
+        QVector<quint8> cells;
+    };
+
+    explicit GridSnapshot(const GridMap& source)
+        : grid(source), stamp(source.version()), rowMajorCache(new RowMajorCache) {}
+
+    GridMap grid;
+    quint64 stamp;
+    QSharedPointer<RowMajorCache> rowMajorCache;
+};
+
+#endif // GRIDMAP_H
@@ -0,0 +1,81 @@
+#ifndef GRIDMAPCORE_C_H
+#define GRIDMAPCORE_C_H
+
+/*
+ * GridMapCore 的纯 C 接口：供其他语言或不使用 Qt 的程序加载地图、编辑格子并调用内置寻路算法
+ * 坐标约定与编辑器一致：x 为列，y 为行；格子取值 0-空白 1-障碍，只有障碍不可通行
+ * 句柄不是线程安全的，但不同句柄可以在不同线程中同时使用
+ * 任何入口都不会抛出 C++ 异常：返回指针的函数返回 NULL，返回状态的函数返回 GMC_INTERNAL_ERROR
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gmc_grid gmc_grid;
+
+/* 与 PathSearch::AlgorithmType 的取值一致 */
+enum gmc_algorithm {
+    GMC_ASTAR = 0,
+    GMC_DIJKSTRA = 1,
+    GMC_BFS = 2,
+    GMC_DFS = 3,
+    GMC_DSTAR = 4
+};
+
+enum gmc_status {
+    GMC_OK = 0,
+    GMC_NO_PATH = 1,                /* 搜索完成但起点和终点不连通 */
+    GMC_INVALID_ARGUMENT = -1,      /* 空句柄、坐标越界、未知算法或起点终点未设置 */
+    GMC_BUFFER_TOO_SMALL = -2,      /* 路径长度已写入 out_length，缓冲区未写入 */
+    GMC_IO_ERROR = -3,
+    GMC_INTERNAL_ERROR = -4         /* 核心库内部出错（例如内存不足），句柄保持调用前的状态 */
+};
+
+typedef struct gmc_search_stats {
+    int nodes_expanded;
+    int nodes_generated;
+    int peak_open_size;
+    long long workspace_bytes;
+    long long setup_time_ns;
+    long long search_time_ns;
+    long long reconstruction_time_ns;
+} gmc_search_stats;
+
+/* 创建 rows x cols 的空白地图，尺寸无效时返回 NULL */
+gmc_grid* gmc_grid_create(int rows, int cols);
+/* 读取地图文件（JSON，路径为 UTF-8），失败时返回 NULL */
+gmc_grid* gmc_grid_load(const char* path);
+int gmc_grid_save(const gmc_grid* grid, const char* path);
+void gmc_grid_destroy(gmc_grid* grid);
+
+int gmc_grid_rows(const gmc_grid* grid);
+int gmc_grid_cols(const gmc_grid* grid);
+/* 越界时 get 返回 -1，set 返回 GMC_INVALID_ARGUMENT */
+int gmc_grid_get_cell(const gmc_grid* grid, int x, int y);
+int gmc_grid_set_cell(gmc_grid* grid, int x, int y, int value);
+int gmc_grid_set_start(gmc_grid* grid, int x, int y);
+int gmc_grid_set_end(gmc_grid* grid, int x, int y);
+int gmc_grid_get_start(const gmc_grid* grid, int* x, int* y);
+int gmc_grid_get_end(const gmc_grid* grid, int* x, int* y);
+
+/*
+ * 在起点和终点之间搜索路径
+ * out_xy 按 x0,y0,x1,y1,... 写入路径（含起点和终点），capacity 为可容纳的点数
+ * out_length 返回路径点数（未找到路径时为 0）；stats 可以为 NULL
+ */
+int gmc_find_path(const gmc_grid* grid,
+                  int algorithm,
+                  int* out_xy,
+                  int capacity,
+                  int* out_length,
+                  gmc_search_stats* stats);
+
+/* 算法名称（静态字符串），未知算法返回 NULL */
+const char* gmc_algorithm_name(int algorithm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRIDMAPCORE_C_H */
@@ -0,0 +1,65 @@
+#ifndef GRIDMAPPLUGIN_H
+#define GRIDMAPPLUGIN_H
+
+/*
+ * 原生寻路插件接口：实现下面两个函数并编译成动态库（.dll / .so / .dylib），
+ * 放到编辑器程序所在目录的 plugins 子目录，或环境变量 GRIDMAP_PLUGIN_PATH 列出的目录中，
+ * 启动时自动加载，作为额外的算法出现在“示例代码 - 插件算法”菜单和算法竞速中
+ *
+ * 栅格是运行时快照按行展开的一份格子（编辑器按块存放格子，每个地图版本展开一次，
+ * 同一版本上的多次搜索和竞速共用这一份）：格子 (x, y) 为 cells[y * stride + x]，
+ * 取值与地图文件一致（0-空白 1-障碍 2-起点 3-终点 4~6-路径显示），只有 1 不可通行
+ * 搜索可能在多个线程中同时调用（算法竞速），插件不能依赖可变的全局状态
+ */
+
+#include "gridmapcore_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GRIDMAP_PLUGIN_ABI_VERSION 1
+
+#if defined(_WIN32)
+#define GRIDMAP_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define GRIDMAP_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct gmp_grid_view {
+    const unsigned char* cells;     /* 只读，只在 search 调用期间有效 */
+    int rows;
+    int cols;
+    int stride;                     /* 相邻两行的字节距离，不小于 cols */
+} gmp_grid_view;
+
+/*
+ * 加载时调用一次：abi_version 为编辑器的 GRIDMAP_PLUGIN_ABI_VERSION，不支持时返回非 0
+ * name 返回算法名称（UTF-8 静态字符串），显示在菜单、统计面板和竞速结果中
+ */
+typedef int (*gmp_init_fn)(int abi_version, const char** name);
+
+/*
+ * 在起点和终点之间搜索路径（起点和终点已检查在栅格内且可通行）
+ * out_xy 由调用方分配，按 x0,y0,x1,y1,... 写入路径（含起点和终点），capacity 为可容纳的点数
+ * 返回值与 gmc_find_path 相同：GMC_OK、GMC_NO_PATH，或路径超出 capacity 时
+ * 把需要的点数写入 out_length 并返回 GMC_BUFFER_TOO_SMALL（调用方会扩大缓冲区重试）
+ * stats 已清零，插件可以只填写自己统计的项；耗时都为 0 时由编辑器计时
+ */
+typedef int (*gmp_search_fn)(const gmp_grid_view* grid,
+                             int start_x, int start_y,
+                             int end_x, int end_y,
+                             int* out_xy,
+                             int capacity,
+                             int* out_length,
+                             gmc_search_stats* stats);
+
+/* 插件导出的符号名 */
+#define GRIDMAP_PLUGIN_INIT_SYMBOL "gridmap_plugin_init"
+#define GRIDMAP_PLUGIN_SEARCH_SYMBOL "gridmap_plugin_search"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRIDMAPPLUGIN_H */
@@ -0,0 +1,73 @@
+#ifndef INCREMENTALPLANNER_H
+#define INCREMENTALPLANNER_H
+
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include "pathsearch.h"
+#include "gridmap.h"
+
+// 增量重新规划（D* Lite）：从终点向起点反向搜索，每个格子到终点的距离在两次规划之间保留
+// 小车（起点）移动或格子变化后只修复受影响的格子，不重新搜索整张地图
+// 四连通、单位代价，得到最短路径：长度与 A*、Dijkstra、BFS、D* 相同，长度相同的路径中可能选择另一条
+class IncrementalPlanner
+{
+public:
+    IncrementalPlanner();
+
+    // 丢弃搜索状态，下一次规划重新开始
+    void reset();
+    bool isInitialized() const { return stride > 0; }
+
+    // 在 grid 上从 start 规划到 goal（只有障碍不可通行），找不到路径时返回空列表
+    // 地图尺寸或终点变化时重新开始，否则只处理上次规划之后变化的格子
+    // 工作数组按整张地图分配，PathSearch::needsChunkedSearch 的地图上返回空列表
+    QList<QPoint> plan(const GridMap& grid,
+                       const QPoint& start,
+                       const QPoint& goal,
+                       PathSearch::SearchStats* stats);
+
+private:
+    struct Entry {
+        qint64 key;
+        int index;
+    };
+
+    static bool later(const Entry& a, const Entry& b)
+    {
+        return a.key != b.key ? a.key > b.key : a.index > b.index;
+    }
+
+    void initialize(const GridMap& grid, const QPoint& start, const QPoint& goal);
+    int syncCells(const GridMap& grid);      // 只比较与上次不同的块，返回变化的格子数
+    int index(const QPoint& pos) const { return (pos.y() + 1) * stride + pos.x() + 1; }
+    QPoint point(int index) const { return QPoint(index % stride - 1, index / stride - 1); }
+    int heuristic(int from, int to) const;  // 曼哈顿距离
+    qint64 keyOf(int index) const;
+    int bestNeighbourCost(int index) const;  // min(g(邻居) + 1)，即 rhs 的定义
+    void updateCell(int index);
+    void push(int index, qint64 key);
+    void compactHeap();
+    void computeShortestPath();
+
+    int rowCount;
+    int colCount;
+    int stride;                    // 带一圈障碍边框，下标 (y + 1) * stride + x + 1
+    int goalIndex;
+    int startIndex;
+    int lastStartIndex;            // 上次规划时的起点，起点移动时累加 keyModifier
+    int keyModifier;               // D* Lite 的 km
+    GridMap synced;                // 上次同步的版本，与编辑器共享没有写过的块
+    QVector<quint8> blocked;
+    QVector<int> g;
+    QVector<int> rhs;
+    QVector<qint64> openKey;       // 开放列表中的键，-1 表示不在开放列表中
+    QVector<Entry> heap;           // 键变化后旧的条目留在堆中，出堆时跳过
+    int openCount;
+    int expanded;                  // 本次规划的统计
+    int generated;
+    int peakOpen;
+    QVector<int> changedCells;
+};
+
+#endif // INCREMENTALPLANNER_H
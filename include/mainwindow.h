@@ -21,6 +21,10 @@
 #include "examplecodedialog.h"
 #include "pathfindingexecutor.h"
 #include "randomobstacledialog.h"
+#include "pathfindingrace.h"
+#include "raceresultdialog.h"
+#include "searchstatsdock.h"
+#include "searchdebugger.h"
 
 class LineNumberArea;
 
@@ -79,12 +83,21 @@ private slots:
     void saveGridMap();
     void loadGridMap();
     void showExampleCode();
+    void selectPluginAlgorithm(PathSearch::AlgorithmType algorithm);
     void runCode();
     void stopExecution();
     void onAlgorithmTitleChanged();
     void updatePathInRealTime();
     void toggleCodeEditor();
     void generateRandomObstacles();
+    void startRace();
+    void onRaceEngineFinished(const PathfindingRace::EngineResult& result);
+    void exportTrace();
+    void startDebugging();
+    void debugStep();
+    void debugContinue();
+    void debugRunToEnd();
+    void stopDebugging();
 
 private:
     void createMenus();
@@ -92,6 +105,7 @@ private:
     void createThemeMenu();
     void createToolBar();
     void applyTheme(const QString &theme);
+    void updateDebugView();
 
 private:
     // 界面组件
@@ -106,6 +120,16 @@ private:
     PathfindingExecutor *executor;
     QString currentAlgorithmName;
     bool hasValidPathBeforeChange; // 记录修改前是否有有效路径
+    
+    // 搜索统计面板
+    SearchStatsDock *statsDock;
+    
+    // 算法竞速
+    PathfindingRace *race;
+    RaceResultDialog *raceDialog;
+    
+    // 单步调试
+    SearchDebugger debugger;
 
     // 菜单
     QMenu *fileMenu;
@@ -123,12 +147,27 @@ private:
     QAction *exitAction;
     QAction *newGridAction;
     QAction *clearGridAction;
+    QAction *undoAction;
+    QAction *redoAction;
     QAction *saveGridAction;
     QAction *loadGridAction;
     QAction *randomObstacleAction;
     QAction *exampleCodeAction;
     QAction *runCodeAction;
     QAction *stopExecutionAction;
+    QAction *raceAction;
+    QAction *heatmapAction;
+    QAction *heatmapOrderAction;
+    QAction *heatmapCountAction;
+    QActionGroup *heatmapModeGroup;
+    QAction *hudAction;
+    QAction *traceRecordAction;
+    QAction *traceExportAction;
+    QAction *debugStartAction;
+    QAction *debugStepAction;
+    QAction *debugContinueAction;
+    QAction *debugFinishAction;
+    QAction *debugStopAction;
     QActionGroup *themeGroup;
 };
 
@@ -0,0 +1,67 @@
+#ifndef MAPDATASETGENERATOR_H
+#define MAPDATASETGENERATOR_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QPoint>
+#include <functional>
+#include "mapfile.h"
+
+// 批量地图数据集生成器：无界面，在线程池上并行生成地图并逐个写入磁盘
+// 第 i 张地图的随机种子只由基础种子和 i 决定，因此输出与线程数无关、逐字节一致
+class MapDatasetGenerator
+{
+    Q_DECLARE_TR_FUNCTIONS(MapDatasetGenerator)
+
+public:
+    struct Options {
+        int rows = 100;
+        int cols = 100;
+        int count = 1000;                 // 地图数量
+        double density = 0.3;             // 障碍物密度
+        int pattern = 0;                  // 与 ObstacleGenerator::Pattern 一致，非随机噪声时忽略连通性
+        int connectivityType = 1;         // 与 ObstacleGenerator::ConnectivityType 一致
+        int pathCount = 2;                // 多通路模式下的通路数量
+        quint64 baseSeed = 12345;         // 基础种子
+        bool randomEndpoints = false;     // 是否随机放置起点和终点（否则为左上角和右下角）
+        int threads = 0;                  // 0 表示使用全部核心
+        QString outputDir;
+        QString filePrefix = QStringLiteral("map_");
+    };
+
+    // 每张地图的生成结果，用于写出清单文件
+    struct MapRecord {
+        int index = 0;
+        quint64 seed = 0;
+        QString fileName;
+        QPoint startPos;
+        QPoint endPos;
+        int guaranteedPaths = 0;
+        bool written = false;
+    };
+
+    explicit MapDatasetGenerator(const Options& options);
+
+    // 由基础种子派生第 index 张地图的种子（splitmix64）
+    static quint64 mapSeed(quint64 baseSeed, int index);
+
+    // 生成第 index 张地图（纯函数，可在任意线程调用）
+    MapFile::MapData generateMap(int index, MapRecord* record = nullptr) const;
+
+    // 并行生成全部地图，返回成功写出的数量；progress 在工作线程中调用
+    int run(const std::function<void(int finished, int total)>& progress = {});
+
+    const QVector<MapRecord>& records() const { return mapRecords; }
+    QString lastError() const { return errorMessage; }
+
+private:
+    QString filePathFor(int index) const;
+    bool writeManifest() const;
+
+    Options options;
+    QVector<MapRecord> mapRecords;
+    QString errorMessage;
+};
+
+#endif // MAPDATASETGENERATOR_H
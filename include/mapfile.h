@@ -0,0 +1,54 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QPoint>
+#include <QByteArray>
+#include "gridmap.h"
+
+// 地图文件（JSON）读写，不依赖界面
+// 格式：{"rows", "cols", "grid": [[...]], "startPos": {"x","y"}, "endPos": {"x","y"}}
+// 超过 MaxDenseCells 个格子的地图按块保存，"grid" 换成 "chunkSize" 和 "chunks"：
+//   [{"x", "y", "value"}（整块同一个值）或 {"x", "y", "cells"}（ChunkSize² 个字节压缩后的 base64）]，
+//   没有列出的块都是空白；读取时两种格式都接受
+class MapFile
+{
+    Q_DECLARE_TR_FUNCTIONS(MapFile)
+
+public:
+    // 格子取值与 GridEditor::CellState 一致，0-空白 1-障碍 2-起点 3-终点 ... 6-走过的路径
+    static const int MaxCellValue = 6;
+    // 按 "grid" 逐格保存的格子数上限，更大的地图按块保存
+    static constexpr qint64 MaxDenseCells = qint64(1) << 20;
+    // 行数和列数的上限（新建栅格和读取时）
+    static const int MaxSide = 65536;
+
+    struct MapData {
+        int rows = 0;
+        int cols = 0;
+        QVector<QVector<int>> cells;
+        QPoint startPos = QPoint(-1, -1);
+        QPoint endPos = QPoint(-1, -1);
+    };
+
+    // 按块存放的地图：编辑器和 C 接口使用，大地图读写时不展开成逐格的 cells
+    struct GridData {
+        GridMap grid;
+        QPoint startPos = QPoint(-1, -1);
+        QPoint endPos = QPoint(-1, -1);
+    };
+
+    static QByteArray toJson(const MapData& map);
+    static bool fromJson(const QByteArray& data, MapData* map, QString* errorMessage = nullptr);
+    static QByteArray toJson(const GridData& map);
+    static bool fromJson(const QByteArray& data, GridData* map, QString* errorMessage = nullptr);
+
+    static bool save(const QString& filename, const MapData& map);
+    static bool load(const QString& filename, MapData* map, QString* errorMessage = nullptr);
+    static bool save(const QString& filename, const GridData& map);
+    static bool load(const QString& filename, GridData* map, QString* errorMessage = nullptr);
+};
+
+#endif // MAPFILE_H
@@ -0,0 +1,73 @@
+#ifndef NATIVECODERUNNER_H
+#define NATIVECODERUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include "pathsearch.h"
+
+class QProcess;
+class SolverWorker;
+
+// 用本机C++编译器编译编辑器中的代码并在子进程中运行
+// 约定：代码中有一个类，构造函数接收 std::vector<std::vector<int>>& grid（grid[行][列]，0 表示可通行），
+// 成员函数 findPath(起点行, 起点列, 终点行, 终点列) 返回 std::vector<std::pair<int, int>>（行, 列），与示例代码一致
+//
+// 编译结果按源码哈希缓存；编译后的程序作为常驻的 SolverWorker 运行，
+// 同一份代码再次运行时只有写共享栅格和一次进程间往返的开销
+class NativeCodeRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NativeCodeRunner(QObject *parent = nullptr);
+    ~NativeCodeRunner() override;
+
+    // 是否找到了编译器（环境变量 CXX，或 PATH 中的 c++ / g++ / clang++）
+    bool isAvailable() const { return !compiler.isEmpty(); }
+    QString compilerPath() const { return compiler; }
+
+    // 代码中是否有可调用的求解类（含 findPath 的 class / struct）
+    static bool hasEntryPoint(const QString& code);
+
+    // code 已经编译完成时返回 true，否则开始编译（缓存命中时同步完成），编译结束后发出 compileFinished
+    bool prepare(const QString& code);
+    bool isCompiling() const { return compileProcess != nullptr; }
+
+    // 用已编译的代码开始求解，需要 prepare 返回 true 或收到成功的 compileFinished
+    // 开始后返回 true，结果通过 runFinished 发出；不能开始时返回 false，error 为错误信息
+    bool run(const GridMap& grid,
+             const QPoint& start,
+             const QPoint& end,
+             QString* error);
+    bool isRunning() const;
+
+signals:
+    void compileFinished(bool ok, const QString& message);
+    // 含义同 SolverWorker::finished
+    void runFinished(bool ok, const QList<QPoint>& path, const PathSearch::SearchStats& stats, const QString& error);
+
+private slots:
+    void onCompileFinished();
+
+private:
+    QString compiler;
+    QString cacheDir;
+
+    // 编译
+    QString readyHash;                 // 已编译、可以运行的源码哈希
+    QString compilingHash;
+    QProcess* compileProcess;
+
+    // 工作进程
+    SolverWorker* worker;
+    QString workerHash;                // 工作进程运行的源码哈希
+
+    static QString findCompiler();
+    QString sourceHash(const QString& code, QString* solverClass) const;
+    QString binaryPath(const QString& hash) const;
+};
+
+#endif // NATIVECODERUNNER_H
@@ -0,0 +1,68 @@
+#ifndef OBSTACLEGENERATOR_H
+#define OBSTACLEGENERATOR_H
+
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include <QPair>
+
+class QRandomGenerator;
+
+// 随机障碍生成器：不依赖界面，只操作一张障碍物掩码
+// GridEditor 和批量数据集生成器共用这一套生成逻辑
+class ObstacleGenerator
+{
+public:
+    enum ConnectivityType {
+        NoPath = 0,        // 无可通行通路
+        OnePath = 1,       // 一条可通行通路
+        MultiplePaths = 2  // 多条可通行通路
+    };
+
+    // 生成方式：随机噪声沿用连通性设置，其余为线性时间的程序化生成
+    enum Pattern {
+        UniformNoise = 0,  // 均匀随机噪声
+        Maze = 1,          // 递归回溯迷宫
+        Cave = 2,          // 元胞自动机洞穴
+        Rooms = 3          // 房间与走廊
+    };
+
+    ObstacleGenerator(int rows, int cols, const QPoint& start, const QPoint& end);
+
+    // 按密度和连通性生成障碍物，返回实际保证的不相交通路数量
+    int generate(double density, int connectivityType, int pathCount, QRandomGenerator* generator);
+
+    // 程序化生成，起点和终点始终保持连通，返回是否连通
+    // density 只对洞穴（初始填充率）和房间（额外走廊的稀疏程度）有效
+    bool generatePattern(int pattern, double density, QRandomGenerator* generator);
+
+    bool isObstacle(int x, int y) const { return blocked[y][x]; }
+    const QVector<QVector<bool>>& obstacles() const { return blocked; }
+
+    // 转换为地图文件使用的格子状态：0-空白，1-障碍，2-起点，3-终点
+    QVector<QVector<int>> toCellStates() const;
+
+private:
+    bool isInside(const QPoint& pos) const;
+    bool generateObstaclesWithNoPath(QRandomGenerator* generator, int targetObstacles);
+    QVector<QPoint> randomSeparatingBarrier(QRandomGenerator* generator, int budget);
+    void generateObstaclesWithOnePath(QRandomGenerator* generator, int targetObstacles);
+    int generateObstaclesWithMultiplePaths(QRandomGenerator* generator, int targetObstacles, int pathCount);
+    void generateMaze(QRandomGenerator* generator);
+    void generateCave(double density, QRandomGenerator* generator);
+    void generateRooms(double density, QRandomGenerator* generator);
+    // 在 width x height 的格子网络上生成随机生成树（递归回溯，显式栈），返回树边
+    QVector<QPair<int, int>> randomSpanningTree(int width, int height, QRandomGenerator* generator) const;
+    void carveCorridor(const QPoint& from, const QPoint& to, bool horizontalFirst);
+    bool connectEndpoints();          // 打通起点和终点所在的连通区域
+    bool isPathExists(const QPoint& start, const QPoint& end) const;
+    QList<QPoint> findPathBFS(const QPoint& start, const QPoint& end) const;
+
+    int rows;
+    int cols;
+    QPoint startPos;
+    QPoint endPos;
+    QVector<QVector<bool>> blocked;    // 障碍物掩码
+};
+
+#endif // OBSTACLEGENERATOR_H
@@ -6,20 +6,26 @@
 #include <QVector>
 #include <QPoint>
 #include <QList>
+#include "pathsearch.h"
+#include "pathscript.h"
+#include "incrementalplanner.h"
+#include "gridmap.h"
 
+class NativeCodeRunner;
+class PythonCodeRunner;
+
+// 运行编辑器中的代码并通过信号返回结果：
+// 寻路规则在进程内编译成字节码运行（PathScript），
+// C++ 代码在本机有编译器时编译运行（NativeCodeRunner），Python 代码在有解释器时交给常驻解释器（PythonCodeRunner），
+// 其余情况识别算法后运行对应的内置算法（PathSearch）或原生插件算法（AlgorithmPlugins，构造时加载）
+// 子进程中的用户代码异步运行，结果信号在 execute 返回后由事件循环发出；运行期间的新请求只保留最新的一个
 class PathfindingExecutor : public QObject
 {
     Q_OBJECT
 
 public:
-    enum AlgorithmType {
-        AStar,
-        Dijkstra,
-        BFS,
-        DFS,
-        DStar,
-        Unknown
-    };
+    typedef PathSearch::AlgorithmType AlgorithmType;
+    typedef PathSearch::SearchStats SearchStats;
 
     enum Language {
         CPlusPlus,
@@ -30,75 +36,120 @@ public:
 
     explicit PathfindingExecutor(QObject *parent = nullptr);
 
+    // 栅格都是编辑器的快照（GridEditor::snapshot()）：传入和保存都不拷贝格子，只有障碍不可通行
     // 执行寻路算法
     void executeCode(const QString& code, 
-                     const QVector<QVector<int>>& grid,
+                     const GridSnapshot& grid,
                      const QPoint& start,
                      const QPoint& end);
     
     // 静默执行寻路算法（不发出错误信号）
     void executeCodeSilently(const QString& code, 
-                              const QVector<QVector<int>>& grid,
+                              const GridSnapshot& grid,
                               const QPoint& start,
                               const QPoint& end);
     
     // 静默执行寻路算法，但会在无路径时清除显示
     void executeCodeSilentlyWithCallback(const QString& code, 
-                                         const QVector<QVector<int>>& grid,
+                                         const GridSnapshot& grid,
                                          const QPoint& start,
                                          const QPoint& end);
+    
+    // 小车行进中地图变化后从小车当前位置 from 重新规划，结果按 executeCodeSilentlyWithCallback 的方式发出
+    // 最短路径类的内置算法（A*、Dijkstra、BFS、D*）由增量规划器在上一次的结果上修复，不重新搜索整张地图；
+    // 寻路规则、插件、DFS 和用户代码从 from 重新运行
+    void replanFrom(const QString& code, const GridSnapshot& grid, const QPoint& from, const QPoint& end);
+    
+    // 代码按单位代价的最短路径内置算法（A*、Dijkstra、BFS、D*）运行时返回该算法，否则返回 Unknown
+    // 这些算法的重新规划交给增量规划器，编辑不影响最短路径时也可以保留当前路线
+    AlgorithmType shortestPathAlgorithm(const QString& code);
+    
+    // 开始执行路径时调用：增量规划器先算出整张地图到终点的距离，之后的重新规划只修复变化的部分
+    void prepareReplanning(const QString& code, const GridSnapshot& grid, const QPoint& start, const QPoint& end);
+    
+    // 代码是否交给子进程运行（本机能编译的C++代码、有解释器的Python代码），这时不按关键字换成内置算法
+    bool runsInSubprocess(const QString& code);
+    
+    // 提前编译或加载代码（例如刚打开代码文件时），之后第一次运行不用等待；错误在运行时报告
+    void prepareCode(const QString& code);
+    
+    // 选择插件算法时放入代码编辑器的内容，运行时据此识别插件
+    static QString pluginCode(AlgorithmType algorithm);
+    
+    // 识别代码对应的算法：寻路规则、插件，或者按关键字匹配的内置算法；无法识别时返回 Unknown
+    static AlgorithmType detectAlgorithm(const QString& code);
+    
+    // 节点扩展记录：开启后每次运行都会记录，发出结果信号时已经就绪
+    void setExpansionTracing(bool enabled);
+    bool isExpansionTracing() const { return traceExpansions; }
+    const PathSearch::ExpansionTrace& lastExpansionTrace() const { return expansionTrace; }
 
 signals:
-    void pathFound(const QList<QPoint>& path);
+    void pathFound(const QList<QPoint>& path, const PathSearch::SearchStats& stats);
     void executionError(const QString& message);
-    void noPathFound(const QString& message);
+    void noPathFound(const QString& message, const PathSearch::SearchStats& stats);
 
-private:
-    AlgorithmType detectAlgorithm(const QString& code);
-    Language detectLanguage(const QString& code);
-    
-    // 内置算法实现
-    QList<QPoint> executeAStar(const QVector<QVector<int>>& grid,
-                               const QPoint& start,
-                               const QPoint& end);
-    QList<QPoint> executeDijkstra(const QVector<QVector<int>>& grid,
-                                  const QPoint& start,
-                                  const QPoint& end);
-    QList<QPoint> executeBFS(const QVector<QVector<int>>& grid,
-                             const QPoint& start,
-                             const QPoint& end);
-    QList<QPoint> executeDFS(const QVector<QVector<int>>& grid,
-                             const QPoint& start,
-                             const QPoint& end);
-    QList<QPoint> executeDStar(const QVector<QVector<int>>& grid,
-                               const QPoint& start,
-                               const QPoint& end);
+private slots:
+    void onNativeCompileFinished(bool ok, const QString& message);
+    void onUserCodeFinished(bool ok, const QList<QPoint>& path, const PathSearch::SearchStats& stats,
+                            const QString& error);
 
-    // 辅助函数
-    bool isValid(int x, int y, const QVector<QVector<int>>& grid);
-    int heuristic(const QPoint& a, const QPoint& b);
-    QList<QPoint> reconstructPath(const QVector<QVector<QPoint>>& cameFrom,
-                                  const QPoint& start,
-                                  const QPoint& end);
+private:
+    // 三个 execute 入口对结果和错误的处理方式
+    enum RunMode {
+        NormalRun,        // executeCode：错误和无路径都发出信号
+        SilentRun,        // executeCodeSilently：只发出 pathFound
+        CallbackRun       // executeCodeSilentlyWithCallback：无路径时发出 noPathFound
+    };
 
-    // 内部数据结构
-    struct Node {
-        QPoint pos;
-        int g, h, f;
-        QPoint parent;
-        
-        Node() : pos(-1, -1), g(0), h(0), f(0), parent(-1, -1) {}
-        Node(const QPoint& p) : pos(p), g(0), h(0), f(0), parent(-1, -1) {}
-        
-        bool operator<(const Node& other) const {
-            return f > other.f; // 优先队列是最大堆，我们需要最小堆
-        }
+    // 用户代码的运行请求；等待编译或上一次运行时只保留最新的一个
+    struct PendingRun {
+        RunMode mode = NormalRun;
+        Language language = UnknownLanguage;
+        QString code;
+        GridSnapshot grid;
+        QPoint start;
+        QPoint end;
     };
+
+    Language detectLanguage(const QString& code);
+    // 运行内置算法或插件算法；插件报告错误时返回 false
+    bool runSearch(AlgorithmType algorithm,
+                   const GridSnapshot& grid,
+                   const QPoint& start,
+                   const QPoint& end,
+                   QList<QPoint>* path,
+                   SearchStats* stats,
+                   QString* error);
+    bool tryRunUserCode(RunMode mode, const QString& code,
+                        const GridSnapshot& grid,
+                        const QPoint& start, const QPoint& end);
+    // 代码能否在这张地图上运行：大地图上内置算法按块搜索，插件要求 GridMap::fitsContiguous，
+    // 寻路规则和用户代码读取展开的栅格，要求不需要按块搜索
+    bool canRunOn(const QString& code, const GridMap& map);
+    bool prepareScript(const QString& code, QString* error);
+    void runPendingUserCode();
+    void cancelUserCodeRuns();
+    void reportUserCodeError(RunMode mode, const QString& message);
+    void emitUserCodeResult(const PendingRun& run, bool ok, const QList<QPoint>& path,
+                            SearchStats stats, const QString& error);
+    
+    bool traceExpansions;
+    PathSearch::ExpansionTrace expansionTrace;
+    
+    IncrementalPlanner replanner;      // 小车行进中的重新规划，搜索状态在两次规划之间保留
+    
+    PathScript script;
+    QString scriptSource;              // script 对应的代码，代码不变时不重新编译
+    QString scriptError;
     
-    // Node结构体专用的reconstructPath函数
-    QList<QPoint> reconstructPath(const QVector<QVector<Node>>& nodeMap,
-                                  const QPoint& start,
-                                  const QPoint& end);
+    NativeCodeRunner* nativeRunner;
+    PythonCodeRunner* pythonRunner;
+    PendingRun pendingRun;
+    bool hasPendingRun;
+    PendingRun activeRun;              // 子进程正在运行的请求
+    bool hasActiveRun;
+    bool activeRunDiscarded;           // 代码已经换成不在子进程中运行的版本，结果不再发出
 };
 
-#endif // PATHFINDINGEXECUTOR_H 
\ No newline at end of file
+#endif // PATHFINDINGEXECUTOR_H
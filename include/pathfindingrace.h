@@ -0,0 +1,50 @@
+#ifndef PATHFINDINGRACE_H
+#define PATHFINDINGRACE_H
+
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include <QPoint>
+#include <QThreadPool>
+#include "pathsearch.h"
+#include "gridmap.h"
+
+// 算法竞速：在同一份栅格快照上，用线程池并行运行全部内置算法
+// 每个算法完成后都会在界面线程发出 engineFinished，全部完成后发出 raceFinished
+class PathfindingRace : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct EngineResult {
+        PathSearch::AlgorithmType algorithm = PathSearch::Unknown;
+        QList<QPoint> path;
+        PathSearch::SearchStats stats;
+        qint64 wallTimeNs = 0;     // 算法本身的耗时（不含排队等待）
+    };
+
+    explicit PathfindingRace(QObject *parent = nullptr);
+    ~PathfindingRace();
+
+    // 参赛的算法，顺序即结果表格的顺序
+    static QList<PathSearch::AlgorithmType> engines();
+
+    // 开始新一轮竞速；上一轮尚未完成的结果会被丢弃
+    void start(const GridSnapshot& grid, const QPoint& start, const QPoint& end);
+    bool isRunning() const { return pendingEngines > 0; }
+    const QVector<EngineResult>& results() const { return engineResults; }
+
+signals:
+    void engineFinished(const PathfindingRace::EngineResult& result);
+    void raceFinished();
+
+private:
+    void deliverResult(int raceId, int slot, const EngineResult& result);
+
+    QThreadPool pool;
+    QVector<EngineResult> engineResults;
+    int currentRaceId;
+    int pendingEngines;
+};
+
+#endif // PATHFINDINGRACE_H
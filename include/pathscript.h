@@ -0,0 +1,138 @@
+#ifndef PATHSCRIPT_H
+#define PATHSCRIPT_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include "pathsearch.h"
+
+// 寻路规则：在代码编辑器中用几行表达式描述一个最佳优先搜索，编译成字节码后在寄存器虚拟机中运行
+// 不需要编译器，也不启动子进程，修改规则后实时重新规划时只多一次编译（微秒级）
+//
+//   # 注释以 # 或 // 开头
+//   heuristic = dx + dy        启发值 h，默认 0
+//   cost = 1 + walls           从当前格子走到相邻格子的代价，必须为正数，默认 1
+//   priority = g + h           开放列表按 priority 从小到大扩展，默认 g + h
+//   tie = h                    priority 相同时按 tie 从小到大，默认 0
+//   order = fifo               priority 和 tie 都相同时先进先出（fifo，默认）或后进先出（lifo）
+//
+// 表达式中可以使用的变量（都针对正在加入开放列表的相邻格子）：
+//   g          到达该格子的代价（在 cost 中是当前格子的代价）
+//   h          heuristic 的值，只能在 priority 和 tie 中使用
+//   x, y       格子坐标；px, py 当前格子坐标；sx, sy 起点；ex, ey 终点；rows, cols 地图尺寸
+//   dx, dy     与终点的横向和纵向距离（绝对值）
+//   depth      从起点走到该格子的步数
+//   turn       这一步是否改变了移动方向（0 或 1）
+//   walls      该格子上下左右的障碍和边界数
+// 运算：+ - * /、比较（< <= > >= == !=，结果为 0 或 1）、条件 a ? b : c，函数 abs min max sqrt
+// 找到更小的 g 时格子重新加入开放列表（即使已经扩展过）；heuristic 不超过真实代价时找到的是代价最小的路径
+class PathScript
+{
+    Q_DECLARE_TR_FUNCTIONS(PathScript)
+
+public:
+    PathScript();
+
+    // 代码是否是寻路规则：每个非注释行都是 名称 = 表达式，并且至少有一条已知的规则
+    static bool looksLikeScript(const QString& code);
+
+    // 编译失败时返回 false，error 为带行号的错误信息
+    bool compile(const QString& source, QString* error);
+    bool isValid() const { return valid; }
+
+    // 在地图快照上运行已编译的规则，障碍物不可通行；读取快照缓存的按行展开副本（GridSnapshot::rowMajor），
+    // 同一版本的地图上反复运行时不再每次复制整张地图
+    // 成功运行时返回 true，path 为空表示未找到路径；表达式得到无效值（代价不是正数等）时返回 false
+    bool run(const GridSnapshot& grid,
+             const QPoint& start,
+             const QPoint& end,
+             QList<QPoint>* path,
+             PathSearch::SearchStats* stats,
+             PathSearch::ExpansionTrace* trace,
+             QString* error) const;
+
+    // 字节码的文本形式，便于检查编译结果
+    QString disassemble() const;
+
+    // 变量寄存器占用前 VariableCount 个寄存器，之后依次是常量和临时值
+    enum Variable {
+        VarG,
+        VarH,
+        VarX,
+        VarY,
+        VarPx,
+        VarPy,
+        VarSx,
+        VarSy,
+        VarEx,
+        VarEy,
+        VarDx,
+        VarDy,
+        VarDepth,
+        VarTurn,
+        VarWalls,
+        VarRows,
+        VarCols,
+        VariableCount
+    };
+
+    // 寄存器指令：dst = a op b（Select 为 dst = a ? b : c）
+    enum OpCode : quint8 {
+        OpAdd,
+        OpSub,
+        OpMul,
+        OpDiv,
+        OpNeg,
+        OpAbs,
+        OpMin,
+        OpMax,
+        OpSqrt,
+        OpLess,
+        OpLessEqual,
+        OpGreater,
+        OpGreaterEqual,
+        OpEqual,
+        OpNotEqual,
+        OpSelect
+    };
+
+    static const int kRegisterCount = 256;
+
+private:
+    struct Instruction {
+        quint8 op;
+        quint8 dst;
+        quint8 a;
+        quint8 b;
+        quint8 c;
+    };
+
+    // 一条规则的字节码：instructions[begin, end)，结果在 result 寄存器中
+    struct Expression {
+        int begin = 0;
+        int end = 0;
+        int result = 0;
+        int line = 0;             // 源码行号，默认规则为 0
+    };
+
+    enum Rule {
+        RuleHeuristic,
+        RuleCost,
+        RulePriority,
+        RuleTie,
+        RuleCount
+    };
+
+    QVector<Instruction> instructions;
+    QVector<double> constants;    // 依次装入 VariableCount 之后的寄存器
+    Expression rules[RuleCount];
+    bool lifo;
+    quint32 usedVariables;        // 按 Variable 编号的位掩码，未使用的变量不计算
+    bool valid;
+
+    friend class PathScriptCompiler;
+};
+
+#endif // PATHSCRIPT_H
@@ -0,0 +1,181 @@
+#ifndef PATHSEARCH_H
+#define PATHSEARCH_H
+
+#include <QCoreApplication>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include <QPoint>
+#include <QList>
+
+class GridMap;
+class GridSnapshot;
+
+// 内置寻路算法：只依赖 Qt Core，不访问任何共享状态，可以在任意线程调用
+// 栅格格式：grid[y][x]，0 表示可通行，其余不可通行；坐标 QPoint(x, y)
+class PathSearch
+{
+    Q_DECLARE_TR_FUNCTIONS(PathSearch)
+
+public:
+    enum AlgorithmType {
+        AStar,
+        Dijkstra,
+        BFS,
+        DFS,
+        DStar,
+        Unknown,
+        Script,            // 寻路规则（PathScript），不经过 runAlgorithm
+        FirstPlugin = 64   // 原生插件算法从这里开始编号（AlgorithmPlugins）
+    };
+
+    // 内置算法工作数组中格子的存放方式：只影响访存，路径和各项计数都相同
+    enum CellLayout {
+        RowMajorLayout,    // 按行存放
+        TiledLayout,       // 按 8×8 的小块存放，宽地图上上下邻居的访问更集中（SearchKernel::TiledGrid）
+        ChunkedLayout      // 直接读取 GridMap 的块，工作记录只为搜索到的块分配（ChunkedSearch）
+    };
+
+    // 内置算法在超过这么多格子的地图上自动按块搜索（ChunkedLayout），不再展开整张地图
+    static constexpr qint64 MaxDenseSearchCells = qint64(1) << 26;
+
+    // 单次搜索的统计信息
+    struct SearchStats {
+        AlgorithmType algorithm = Unknown;
+        int nodesExpanded = 0;     // 扩展（出队）的节点数
+        int nodesGenerated = 0;    // 加入开放列表的节点数
+        int peakOpenSize = 0;      // 开放列表（DFS为显式栈深度）的峰值大小
+        qint64 workspaceBytes = 0; // 峰值工作内存估算：状态数组 + 开放列表峰值
+        qint64 setupTimeNs = 0;           // 分配和初始化工作数组
+        qint64 searchTimeNs = 0;          // 主循环
+        qint64 reconstructionTimeNs = 0;  // 回溯生成路径
+        
+        qint64 totalTimeNs() const { return setupTimeNs + searchTimeNs + reconstructionTimeNs; }
+    };
+
+    // 扩展记录（可选）：每个格子的扩展次数和首次扩展序号，按行存放（下标 y * cols + x）
+    // 不需要时传空指针，算法中只多一次指针判断
+    struct ExpansionTrace {
+        int rows = 0;
+        int cols = 0;
+        int expansions = 0;          // 总扩展次数
+        int maxCount = 0;            // 单个格子的最大扩展次数
+        QVector<quint16> counts;     // 扩展次数，饱和到 65535
+        QVector<quint32> order;      // 首次扩展的序号，从 1 开始，0 表示未扩展
+
+        void reset(int rowCount, int colCount);
+        void record(const QPoint& pos)
+        {
+            const int index = pos.y() * cols + pos.x();
+            ++expansions;
+            if (order[index] == 0) {
+                order[index] = expansions;
+            }
+            if (counts[index] < 0xFFFF) {
+                ++counts[index];
+                maxCount = qMax(maxCount, int(counts[index]));
+            }
+        }
+        bool isEmpty() const { return expansions == 0; }
+    };
+
+    // 运行指定算法，未找到路径时返回空列表；trace 非空时记录每个格子的扩展情况
+    // 插件算法在这里需要先把栅格转换为按行存放的字节，没有扩展记录；ChunkedLayout 先转换成 GridMap
+    static QList<QPoint> runAlgorithm(AlgorithmType algorithm,
+                                      const QVector<QVector<int>>& grid,
+                                      const QPoint& start,
+                                      const QPoint& end,
+                                      SearchStats* stats = nullptr,
+                                      ExpansionTrace* trace = nullptr,
+                                      CellLayout layout = RowMajorLayout);
+    // 同上，直接读取 GridMap（或 GridSnapshot::map()）的格子，只有障碍不可通行，不经过 grid[y][x]
+    // needsChunkedSearch 的地图上内置算法按块搜索、没有扩展记录；插件在 fitsContiguous 不成立时返回空列表
+    static QList<QPoint> runAlgorithm(AlgorithmType algorithm,
+                                      const GridMap& grid,
+                                      const QPoint& start,
+                                      const QPoint& end,
+                                      SearchStats* stats = nullptr,
+                                      ExpansionTrace* trace = nullptr,
+                                      CellLayout layout = RowMajorLayout);
+    // 同上，插件读取快照缓存的按行格子（GridSnapshot::rowMajor），同一快照上多次运行只展开一次
+    static QList<QPoint> runAlgorithm(AlgorithmType algorithm,
+                                      const GridSnapshot& grid,
+                                      const QPoint& start,
+                                      const QPoint& end,
+                                      SearchStats* stats = nullptr,
+                                      ExpansionTrace* trace = nullptr,
+                                      CellLayout layout = RowMajorLayout);
+    // 地图太大、内置算法要按块搜索时返回 true；寻路规则和用户代码读取展开的栅格，这时不能运行
+    // （插件读取按行的字节，仍然只要求 GridMap::fitsContiguous）
+    static bool needsChunkedSearch(const GridMap& grid);
+    static QString algorithmName(AlgorithmType algorithm);
+    static bool isValid(int x, int y, const QVector<QVector<int>>& grid);
+
+private:
+    static void beginRun(AlgorithmType algorithm, int rows, int cols,
+                         SearchStats* stats, ExpansionTrace* trace);
+    // Source 是 QVector<QVector<int>> 或 GridMap，按 layout 构造内核使用的栅格
+    template <typename Source>
+    static QList<QPoint> runBuiltIn(AlgorithmType algorithm,
+                                    const Source& source,
+                                    const QPoint& start,
+                                    const QPoint& end,
+                                    SearchStats* stats,
+                                    ExpansionTrace* trace,
+                                    CellLayout layout);
+    // gridSetupNs：构造 grid 的耗时，计入准备阶段
+    template <typename Grid>
+    static QList<QPoint> runOnGrid(AlgorithmType algorithm,
+                                   const Grid& grid,
+                                   const QPoint& start,
+                                   const QPoint& end,
+                                   SearchStats* stats,
+                                   ExpansionTrace* trace,
+                                   qint64 gridSetupNs);
+    template <typename Grid>
+    static QList<QPoint> executeAStar(const Grid& grid,
+                                      const QPoint& start,
+                                      const QPoint& end,
+                                      SearchStats* stats,
+                                      ExpansionTrace* trace,
+                                      qint64 gridSetupNs);
+    template <typename Grid>
+    static QList<QPoint> executeDijkstra(const Grid& grid,
+                                         const QPoint& start,
+                                         const QPoint& end,
+                                         SearchStats* stats,
+                                         ExpansionTrace* trace,
+                                         qint64 gridSetupNs);
+    template <typename Grid>
+    static QList<QPoint> executeBFS(const Grid& grid,
+                                    const QPoint& start,
+                                    const QPoint& end,
+                                    SearchStats* stats,
+                                    ExpansionTrace* trace,
+                                    qint64 gridSetupNs);
+    template <typename Grid>
+    static QList<QPoint> executeDFS(const Grid& grid,
+                                    const QPoint& start,
+                                    const QPoint& end,
+                                    SearchStats* stats,
+                                    ExpansionTrace* trace,
+                                    qint64 gridSetupNs);
+    template <typename Grid>
+    static QList<QPoint> executeDStar(const Grid& grid,
+                                      const QPoint& start,
+                                      const QPoint& end,
+                                      SearchStats* stats,
+                                      ExpansionTrace* trace,
+                                      qint64 gridSetupNs);
+    static QList<QPoint> executePlugin(AlgorithmType algorithm,
+                                       const quint8* cells,
+                                       int rows,
+                                       int cols,
+                                       const QPoint& start,
+                                       const QPoint& end,
+                                       SearchStats* stats);
+};
+
+Q_DECLARE_METATYPE(PathSearch::SearchStats)
+
+#endif // PATHSEARCH_H
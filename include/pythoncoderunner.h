@@ -0,0 +1,78 @@
+#ifndef PYTHONCODERUNNER_H
+#define PYTHONCODERUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include <QByteArray>
+#include "gridmap.h"
+#include "pathsearch.h"
+
+class SolverWorker;
+
+// 在常驻的 Python 解释器中运行编辑器中的 Python 代码
+// 约定：代码中有一个类，构造函数接收 grid（list 的 list，grid[行][列]，0 表示可通行），
+// 方法 find_path(起点行, 起点列, 终点行, 终点列) 返回 (行, 列) 序列，与示例代码一致；
+// 也可以直接定义函数 find_path(grid, 起点行, 起点列, 终点行, 终点列)
+// 求解期间全局变量 grid_buffer 是共享栅格的只读二维 memoryview，可以用 numpy.asarray 零拷贝包装
+//
+// 解释器只启动一次，代码改变时重新加载，实时重新规划不需要每次启动解释器
+class PythonCodeRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PythonCodeRunner(QObject *parent = nullptr);
+
+    // 是否找到了 Python 3（环境变量 PYTHON，或 PATH 中的 python3 / python）
+    bool isAvailable() const { return !interpreter.isEmpty(); }
+    QString interpreterPath() const { return interpreter; }
+
+    // 代码中是否定义了 find_path
+    static bool hasEntryPoint(const QString& code);
+
+    // 启动解释器（已运行时直接使用）并开始加载代码，用于提前加载；代码未变或正在处理请求时什么也不做
+    // 解释器不能启动或不能发出加载请求时返回 false；加载中的错误在 run 时报告
+    bool prepare(const QString& code, QString* error);
+
+    // 开始用 code 求解，代码与已加载的不同时先加载；开始后返回 true，结果通过 runFinished 发出，
+    // 不能开始时返回 false，error 为错误信息；同一时间只运行一个请求
+    bool run(const QString& code,
+             const GridMap& grid,
+             const QPoint& start,
+             const QPoint& end,
+             QString* error);
+    bool isRunning() const { return hasQueuedRun; }
+
+signals:
+    // 含义同 SolverWorker::finished
+    void runFinished(bool ok, const QList<QPoint>& path, const PathSearch::SearchStats& stats, const QString& error);
+
+private slots:
+    void onWorkerFinished(bool ok, const QList<QPoint>& path, const PathSearch::SearchStats& stats,
+                          const QString& error);
+
+private:
+    QString interpreter;
+    QString workingDirectory;
+    SolverWorker* worker;
+    QByteArray loadedCode;             // 当前工作进程中已加载的代码
+    QByteArray loadingCode;            // 正在加载的代码
+
+    // run 的请求：加载代码后才能求解
+    bool hasQueuedRun;
+    QByteArray queuedCode;
+    GridMap queuedGrid;                // 地图快照，拷贝是 O(1) 的
+    QPoint queuedStart;
+    QPoint queuedEnd;
+
+    static QString findInterpreter();
+    bool startWorker(qint64 cellCount, QString* error);
+    bool load(const QByteArray& source, QString* error);
+    // 继续 run 的请求：需要时重启解释器、加载代码，然后求解
+    bool continueRun(QString* error);
+};
+
+#endif // PYTHONCODERUNNER_H
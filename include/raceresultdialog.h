@@ -0,0 +1,36 @@
+#ifndef RACERESULTDIALOG_H
+#define RACERESULTDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QColor>
+#include "pathfindingrace.h"
+
+// 算法竞速结果表：每个算法一行，完成一个填一行
+class RaceResultDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RaceResultDialog(QWidget *parent = nullptr);
+
+    // 第 slot 个参赛算法在栅格上的叠加颜色，表格中使用同一颜色
+    static QColor engineColor(int slot);
+
+    void resetRace();
+    void setEngineResult(int slot, const PathfindingRace::EngineResult& result);
+    void setRaceFinished();
+
+signals:
+    void overlayCleared();
+
+private:
+    QTableWidget *resultTable;
+    QLabel *statusLabel;
+    QPushButton *clearOverlayButton;
+    QPushButton *closeButton;
+};
+
+#endif // RACERESULTDIALOG_H
@@ -13,6 +13,7 @@
 #include <QPushButton>
 #include <QButtonGroup>
 #include <QGroupBox>
+#include <QComboBox>
 
 class RandomObstacleDialog : public QDialog
 {
@@ -25,9 +26,18 @@ public:
         MultiplePaths = 2  // 多条可通行通路
     };
 
+    // 与 ObstacleGenerator::Pattern 一致
+    enum GenerationPattern {
+        UniformNoise = 0,  // 随机噪声
+        Maze = 1,          // 迷宫（递归回溯）
+        Cave = 2,          // 洞穴（元胞自动机）
+        Rooms = 3          // 房间与走廊
+    };
+
     explicit RandomObstacleDialog(QWidget *parent = nullptr);
 
     // 获取设置的参数
+    GenerationPattern getPattern() const;
     double getObstacleDensity() const;
     ConnectivityType getConnectivityType() const;
     int getPathCount() const;
@@ -35,6 +45,7 @@ public:
     int getSeed() const;
 
 private slots:
+    void onPatternChanged();
     void onConnectivityChanged();
     void onUseSeedChanged();
 
@@ -42,10 +53,15 @@ private:
     void setupUI();
 
 private:
+    // 生成方式
+    QComboBox *patternComboBox;
+    QLabel *patternTip;
+    
     // 障碍物密度
     QDoubleSpinBox *densitySpinBox;
     
     // 连通性设置
+    QGroupBox *connectivityBox;
     QButtonGroup *connectivityGroup;
     QRadioButton *noPathRadio;
     QRadioButton *onePathRadio;
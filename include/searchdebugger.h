@@ -0,0 +1,73 @@
+#ifndef SEARCHDEBUGGER_H
+#define SEARCHDEBUGGER_H
+
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include <variant>
+#include "pathsearch.h"
+#include "searchkernel.h"
+#include "gridmap.h"
+
+// 单步调试内置算法：搜索实例（SearchKernel::Search）在两次单步之间保留，继续运行不会重新开始搜索
+// 暂停时可以查询每个格子在开放列表中还是已经扩展，以及上次暂停之后状态变化的格子
+// 插件、寻路规则和用户代码整体运行在动态库、字节码虚拟机或子进程中，不能单步
+class SearchDebugger
+{
+public:
+    enum CellState {
+        Unseen,
+        Open,      // 在开放列表中（DFS 为当前路径上的格子）
+        Closed     // 已经扩展
+    };
+
+    SearchDebugger();
+    ~SearchDebugger();
+
+    static bool supports(PathSearch::AlgorithmType algorithm);
+
+    // 开始新的调试会话，丢弃之前的会话；算法不支持单步或地图要按块搜索（PathSearch::needsChunkedSearch）时返回 false
+    bool start(PathSearch::AlgorithmType algorithm,
+               const GridMap& grid,
+               const QPoint& start,
+               const QPoint& end);
+    void stop();
+
+    bool isActive() const { return grid != nullptr; }
+    bool isFinished() const;
+    bool found() const;
+    PathSearch::AlgorithmType algorithm() const { return currentAlgorithm; }
+
+    // 扩展一个格子，搜索结束后返回 false
+    bool step();
+    // 运行到扩展断点中的某个格子或搜索结束；停在断点上时返回 true
+    bool runToBreakpoint(const QList<QPoint>& breakpoints);
+    void runToEnd();
+
+    QPoint lastExpanded() const;           // 最近扩展的格子，还没有扩展时为 (-1, -1)
+    CellState cellState(const QPoint& pos) const;
+    int openSize() const;
+    const PathSearch::SearchStats& stats() const { return searchStats; }
+    QList<QPoint> path() const;            // 从起点到终点，未找到时为空
+
+    // 上次调用之后状态变化过的格子（可能重复），界面只需要重绘这些格子
+    QList<QPoint> takeChangedCells();
+
+private:
+    Q_DISABLE_COPY(SearchDebugger)
+
+    typedef std::variant<std::monostate,
+                         SearchKernel::AStarSearch,
+                         SearchKernel::DijkstraSearch,
+                         SearchKernel::BreadthFirstSearch,
+                         SearchKernel::DepthFirstSearch> Kernel;
+
+    PathSearch::AlgorithmType currentAlgorithm;
+    SearchKernel::PaddedGrid* grid;        // 搜索实例引用其中的格子，会话结束时释放
+    Kernel kernel;
+    PathSearch::SearchStats searchStats;
+    QVector<int> changes;                  // 状态变化的格子下标（带边框栅格）
+    QVector<quint8> breakpointMask;        // runToBreakpoint 期间标记断点格子
+};
+
+#endif // SEARCHDEBUGGER_H
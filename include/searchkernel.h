@@ -0,0 +1,661 @@
+#ifndef SEARCHKERNEL_H
+#define SEARCHKERNEL_H
+
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include <algorithm>
+#include <cstdlib>
+#include "pathsearch.h"
+#include "gridmap.h"
+
+// 编译期特化的寻路内核：连通方式、启发函数、开放列表和代价模型都是模板参数，
+// PathSearch 的每个内置算法都只是这里的一个实例
+// 内核在四周多一圈障碍哨兵的栅格上运行，扩展邻居时不做边界检查，邻居偏移在构造时由常量表算出
+// 内核可以逐步运行：step() 每次扩展一个格子，中途暂停不需要重新开始搜索
+namespace SearchKernel {
+
+// 搜索内核通过栅格类型访问格子和邻居，不假设下标的排列方式，可以换用不同的存放顺序：
+//   index(x, y) / point(index)、column(index) / row(index)：地图坐标与下标互相转换
+//   neighbour(index, dx, dy)：相邻格子的下标；isOpen(index)：0 可通行，1 不可通行；size()：工作数组的长度
+//   Neighbours<Connectivity>：按方向表扩展邻居，neighbours(index, dir) 是方向 dir 上的邻居，可以预先算好偏移
+// 两种栅格都在四周多一圈障碍哨兵，扩展邻居时不做边界检查
+
+// 按行存放：(x, y) 的下标为 (y + 1) * stride + (x + 1)，上下邻居相隔一整行
+class PaddedGrid
+{
+public:
+    explicit PaddedGrid(const QVector<QVector<int>>& grid)
+        : rowCount(grid.size()),
+          colCount(grid.isEmpty() ? 0 : grid[0].size()),
+          stride(colCount + 2)
+    {
+        cells.fill(1, (rowCount + 2) * stride);
+        for (int y = 0; y < rowCount; ++y) {
+            const int* line = grid[y].constData();
+            quint8* target = cells.data() + index(0, y);
+            for (int x = 0; x < colCount; ++x) {
+                target[x] = line[x] == 0 ? 0 : 1;
+            }
+        }
+    }
+
+    // 直接从编辑器的格子存储（或快照）构造：只有障碍不可通行
+    explicit PaddedGrid(const GridMap& grid)
+        : rowCount(grid.rows()),
+          colCount(grid.cols()),
+          stride(colCount + 2)
+    {
+        cells.fill(1, (rowCount + 2) * stride);
+        for (int y = 0; y < rowCount; ++y) {
+            quint8* target = cells.data() + index(0, y);
+            grid.readRow(y, target);
+            for (int x = 0; x < colCount; ++x) {
+                target[x] = target[x] == GridMap::Obstacle ? 1 : 0;
+            }
+        }
+    }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int rowStride() const { return stride; }
+    int size() const { return cells.size(); }
+    bool contains(const QPoint& pos) const
+    {
+        return pos.x() >= 0 && pos.x() < colCount && pos.y() >= 0 && pos.y() < rowCount;
+    }
+    int index(int x, int y) const { return (y + 1) * stride + x + 1; }
+    int index(const QPoint& pos) const { return index(pos.x(), pos.y()); }
+    QPoint point(int index) const { return QPoint(column(index), row(index)); }
+    int column(int index) const { return index % stride - 1; }
+    int row(int index) const { return index / stride - 1; }
+    int neighbour(int index, int dx, int dy) const { return index + dy * stride + dx; }
+    bool isOpen(int index) const { return cells[index] == 0; }
+    const quint8* constData() const { return cells.constData(); }
+
+    // 每个方向的邻居与格子的下标相差固定的偏移
+    template <typename Connectivity>
+    class Neighbours
+    {
+    public:
+        explicit Neighbours(const PaddedGrid& grid)
+        {
+            for (int dir = 0; dir < Connectivity::kCount; ++dir) {
+                offsets[dir] = Connectivity::kDy[dir] * grid.stride + Connectivity::kDx[dir];
+            }
+        }
+        int operator()(int index, int dir) const { return index + offsets[dir]; }
+
+    private:
+        int offsets[Connectivity::kCount];
+    };
+
+private:
+    int rowCount;
+    int colCount;
+    int stride;
+    QVector<quint8> cells;
+};
+
+// 按 kTileSize × kTileSize 的小块存放：块按行排列，块内按行存放（坐标同样带一圈哨兵）
+// 一个块的格子和对应的工作记录在几条相邻的缓存行中，上下邻居大多在同一块内，宽地图上比按行存放少很多缓存缺失
+class TiledGrid
+{
+public:
+    static constexpr int kTileShift = 3;
+    static constexpr int kTileSize = 1 << kTileShift;
+    static constexpr int kTileMask = kTileSize - 1;
+    static constexpr int kTileCells = kTileSize * kTileSize;
+
+    explicit TiledGrid(const QVector<QVector<int>>& grid)
+        : TiledGrid(grid.size(), grid.isEmpty() ? 0 : grid[0].size())
+    {
+        QVector<quint8> line(colCount);
+        for (int y = 0; y < rowCount; ++y) {
+            const int* source = grid[y].constData();
+            for (int x = 0; x < colCount; ++x) {
+                line[x] = source[x] == 0 ? 0 : 1;
+            }
+            storeRow(y, line.constData());
+        }
+    }
+
+    // 直接从编辑器的格子存储（或快照）构造：只有障碍不可通行
+    explicit TiledGrid(const GridMap& grid)
+        : TiledGrid(grid.rows(), grid.cols())
+    {
+        QVector<quint8> line(colCount);
+        for (int y = 0; y < rowCount; ++y) {
+            grid.readRow(y, line.data());
+            for (int x = 0; x < colCount; ++x) {
+                line[x] = line[x] == GridMap::Obstacle ? 1 : 0;
+            }
+            storeRow(y, line.constData());
+        }
+    }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int size() const { return cells.size(); }
+    bool contains(const QPoint& pos) const
+    {
+        return pos.x() >= 0 && pos.x() < colCount && pos.y() >= 0 && pos.y() < rowCount;
+    }
+    int index(int x, int y) const { return paddedIndex(x + 1, y + 1); }
+    int index(const QPoint& pos) const { return index(pos.x(), pos.y()); }
+    QPoint point(int index) const { return QPoint(column(index), row(index)); }
+    int column(int index) const
+    {
+        return (((index >> (2 * kTileShift)) % tileCols) << kTileShift) + (index & kTileMask) - 1;
+    }
+    int row(int index) const
+    {
+        return (((index >> (2 * kTileShift)) / tileCols) << kTileShift) + ((index >> kTileShift) & kTileMask) - 1;
+    }
+    // 不在块的边上时就是块内相邻的下标，只有跨块时才需要换算
+    int neighbour(int index, int dx, int dy) const
+    {
+        if (dx != 0) {
+            const int x = (index & kTileMask) + dx;
+            index += (x & ~kTileMask) == 0 ? dx : dx * (kTileCells - kTileMask);
+        }
+        if (dy != 0) {
+            const int y = ((index >> kTileShift) & kTileMask) + dy;
+            index += (y & ~kTileMask) == 0 ? dy * kTileSize : dy * (tileCols * kTileCells - kTileMask * kTileSize);
+        }
+        return index;
+    }
+    bool isOpen(int index) const { return cells[index] == 0; }
+
+    template <typename Connectivity>
+    class Neighbours
+    {
+    public:
+        explicit Neighbours(const TiledGrid& grid) : grid(grid) {}
+        int operator()(int index, int dir) const
+        {
+            return grid.neighbour(index, Connectivity::kDx[dir], Connectivity::kDy[dir]);
+        }
+
+    private:
+        const TiledGrid& grid;
+    };
+
+private:
+    TiledGrid(int rows, int cols)
+        : rowCount(rows),
+          colCount(cols),
+          tileCols((cols + 2 + kTileMask) >> kTileShift)
+    {
+        // 哨兵和块中超出地图的部分都不可通行
+        const int tileRows = (rows + 2 + kTileMask) >> kTileShift;
+        cells.fill(1, tileCols * tileRows * kTileCells);
+    }
+
+    int paddedIndex(int x, int y) const
+    {
+        return (((y >> kTileShift) * tileCols + (x >> kTileShift)) << (2 * kTileShift))
+               | ((y & kTileMask) << kTileShift) | (x & kTileMask);
+    }
+
+    // 第 y 行的格子按块切开写入，每段最多 kTileSize 个
+    void storeRow(int y, const quint8* line)
+    {
+        for (int x = 0; x < colCount;) {
+            const int paddedX = x + 1;
+            const int length = qMin(colCount - x, kTileSize - (paddedX & kTileMask));
+            std::copy(line + x, line + x + length, cells.data() + paddedIndex(paddedX, y + 1));
+            x += length;
+        }
+    }
+
+    int rowCount;
+    int colCount;
+    int tileCols;
+    QVector<quint8> cells;
+};
+
+// 连通方式：邻居的扩展顺序就是表中的顺序
+struct FourConnected {
+    static constexpr int kCount = 4;
+    static constexpr int kDx[kCount] = { -1, 1, 0, 0 };
+    static constexpr int kDy[kCount] = { 0, 0, -1, 1 };
+};
+
+// 八连通：斜向移动要求两侧的直向格子都可通行（不切角）
+struct EightConnected {
+    static constexpr int kCount = 8;
+    static constexpr int kDx[kCount] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+    static constexpr int kDy[kCount] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+};
+
+// 代价模型：直向和斜向一步的代价
+struct UnitCost {
+    static constexpr int kStraight = 1;
+    static constexpr int kDiagonal = 1;
+};
+
+struct OctileCost {
+    static constexpr int kStraight = 10;
+    static constexpr int kDiagonal = 14;
+};
+
+// 启发函数：参数是到目标的横向和纵向距离（格子数），按代价模型换算成代价
+struct ZeroHeuristic {
+    template <typename Cost>
+    static int estimate(int, int) { return 0; }
+};
+
+struct ManhattanHeuristic {
+    template <typename Cost>
+    static int estimate(int dx, int dy) { return Cost::kStraight * (dx + dy); }
+};
+
+struct OctileHeuristic {
+    template <typename Cost>
+    static int estimate(int dx, int dy)
+    {
+        return Cost::kStraight * (dx + dy) + (Cost::kDiagonal - 2 * Cost::kStraight) * std::min(dx, dy);
+    }
+};
+
+// 开放列表：先进先出，代价改善时不调整位置（广度优先）
+class FifoQueue
+{
+public:
+    static constexpr bool kDepthFirst = false;
+    static constexpr int kEntryBytes = sizeof(int);
+    static constexpr int kCellBytes = 0;
+
+    void reset(int) { items.clear(); head = 0; }
+    bool isEmpty() const { return head == items.size(); }
+    int size() const { return items.size() - head; }
+    void push(int index, int) { items.append(index); }
+    void update(int, int) {}
+    int pop() { return items[head++]; }
+
+private:
+    QVector<int> items;
+    int head = 0;
+};
+
+// 开放列表：按优先级从小到大的二叉堆，优先级相同时先加入的先扩展
+// 代价改善时压入新条目并保留原来的加入顺序，过期条目在出队时跳过
+class MinHeapQueue
+{
+public:
+    static constexpr bool kDepthFirst = false;
+    static constexpr int kEntryBytes = sizeof(int) * 3;
+    static constexpr int kCellBytes = sizeof(int) * 2;
+
+    void reset(int cellCount)
+    {
+        heap.clear();
+        priority.fill(-1, cellCount);
+        sequence.resize(cellCount);
+        pushed = 0;
+        openCount = 0;
+    }
+    bool isEmpty() const { return openCount == 0; }
+    int size() const { return openCount; }
+    void push(int index, int value)
+    {
+        priority[index] = value;
+        sequence[index] = pushed++;
+        ++openCount;
+        append(Entry{ value, sequence[index], index });
+    }
+    void update(int index, int value)
+    {
+        priority[index] = value;
+        append(Entry{ value, sequence[index], index });
+    }
+    int pop()
+    {
+        for (;;) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            const Entry entry = heap.takeLast();
+            if (priority[entry.index] == entry.priority) {
+                priority[entry.index] = -1;
+                --openCount;
+                return entry.index;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        int priority;
+        int sequence;
+        int index;
+    };
+
+    static bool later(const Entry& a, const Entry& b)
+    {
+        return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+    }
+    void append(const Entry& entry)
+    {
+        heap.append(entry);
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    QVector<Entry> heap;
+    QVector<int> priority;    // 开放列表中格子的当前优先级，-1 表示不在开放列表中
+    QVector<int> sequence;    // 格子首次加入开放列表的顺序
+    int pushed = 0;
+    int openCount = 0;
+};
+
+// 深度优先：开放列表是当前路径上的格子，每个格子记录下一个要尝试的方向
+class DepthFirstStack
+{
+public:
+    static constexpr bool kDepthFirst = true;
+    static constexpr int kEntryBytes = sizeof(int) * 2;
+    static constexpr int kCellBytes = 0;
+
+    struct Frame {
+        int index;
+        int next;
+    };
+
+    void reset(int) { frames.clear(); }
+    bool isEmpty() const { return frames.isEmpty(); }
+    int size() const { return frames.size(); }
+    void push(int index, int) { frames.append(Frame{ index, 0 }); }
+    Frame& top() { return frames.last(); }
+    void pop() { frames.removeLast(); }
+    const QVector<Frame>& path() const { return frames; }
+
+private:
+    QVector<Frame> frames;
+};
+
+// 搜索实例：构造时只初始化工作数组，step() 扩展一个格子，run() 运行到结束
+// 最佳优先（FifoQueue、MinHeapQueue）：出队时检查目标，邻居的代价变小时更新父节点，已扩展的格子不再打开
+// 深度优先（DepthFirstStack）：沿当前路径回溯，到达的每个格子只进入一次；当前路径上的格子算作开放
+// changes 非空时记录每次状态变化的格子下标（单步调试按它局部刷新），不需要时只多一次指针判断
+template <typename Connectivity, typename Heuristic, typename Queue, typename Cost = UnitCost,
+          typename Grid = PaddedGrid>
+class Search
+{
+public:
+    enum CellState : quint8 {
+        Unseen,
+        Open,
+        Closed
+    };
+
+    Search(const Grid& grid,
+           const QPoint& start,
+           const QPoint& goal,
+           PathSearch::SearchStats* stats = nullptr,
+           PathSearch::ExpansionTrace* trace = nullptr,
+           QVector<int>* changes = nullptr)
+        : grid(grid),
+          stats(stats ? *stats : localStats),
+          trace(trace),
+          changes(changes),
+          lastIndex(-1),
+          startIndex(grid.index(start)),
+          goalIndex(grid.index(goal)),
+          neighbours(grid),
+          goalX(goal.x()),
+          goalY(goal.y()),
+          finished(false),
+          reached(false)
+    {
+        fixedBytes = qint64(grid.size()) * (sizeof(Record) + sizeof(quint8) + Queue::kCellBytes);
+        if (!grid.contains(start) || !grid.contains(goal)) {
+            finished = true;
+            return;
+        }
+        records.fill(Record(), grid.size());
+        queue.reset(grid.size());
+
+        if constexpr (Queue::kDepthFirst) {
+            // 起点就是终点时不扩展任何格子；起点不可通行时没有路径
+            if (startIndex == goalIndex) {
+                finished = reached = true;
+            } else if (!grid.isOpen(startIndex)) {
+                finished = true;
+            } else {
+                visit(startIndex);
+            }
+        } else {
+            Record& node = records[startIndex];
+            setState(startIndex, Open);
+            node.g = 0;
+            queue.push(startIndex, estimate(grid.column(startIndex), grid.row(startIndex)));
+            trackOpenSize();
+        }
+    }
+
+    // 扩展一个格子；搜索结束（到达目标或开放列表为空）后返回 false
+    bool step()
+    {
+        if (finished) {
+            return false;
+        }
+        if constexpr (Queue::kDepthFirst) {
+            stepDepthFirst();
+        } else {
+            stepBestFirst();
+        }
+        return !finished;
+    }
+
+    void run()
+    {
+        while (step()) {
+        }
+    }
+
+    bool isFinished() const { return finished; }
+    bool found() const { return reached; }
+    int openSize() const { return queue.size(); }
+    // 最近扩展的格子下标，还没有扩展时为 -1
+    int lastExpanded() const { return lastIndex; }
+    CellState cellState(int index) const { return records.isEmpty() ? Unseen : records[index].state; }
+
+    // 从起点到目标的路径，未找到时为空
+    QList<QPoint> path() const
+    {
+        QList<QPoint> result;
+        if (!reached) {
+            return result;
+        }
+        if constexpr (Queue::kDepthFirst) {
+            result.reserve(queue.size() + 1);
+            for (const typename Queue::Frame& frame : queue.path()) {
+                result.append(grid.point(frame.index));
+            }
+        } else {
+            for (int index = goalIndex; index != startIndex; index = records[index].parent) {
+                result.append(grid.point(index));
+            }
+            std::reverse(result.begin(), result.end());
+            result.prepend(grid.point(startIndex));
+            return result;
+        }
+        result.append(grid.point(goalIndex));
+        return result;
+    }
+
+private:
+    struct Record {
+        int g = 0;
+        int parent = -1;
+        CellState state = Unseen;
+    };
+
+    void setState(int index, CellState state)
+    {
+        records[index].state = state;
+        if (changes) {
+            changes->append(index);
+        }
+    }
+
+    int estimate(int x, int y) const
+    {
+        return Heuristic::template estimate<Cost>(std::abs(x - goalX), std::abs(y - goalY));
+    }
+
+    static constexpr bool isDiagonal(int dir)
+    {
+        return Connectivity::kDx[dir] != 0 && Connectivity::kDy[dir] != 0;
+    }
+
+    int neighbour(int index, int dir) const { return neighbours(index, dir); }
+
+    // 斜向一步两侧的直向格子都可通行时才能通过
+    bool sidesOpen(int index, int dir) const
+    {
+        if constexpr (Connectivity::kCount > 4) {
+            if (isDiagonal(dir)) {
+                return grid.isOpen(grid.neighbour(index, Connectivity::kDx[dir], 0))
+                       && grid.isOpen(grid.neighbour(index, 0, Connectivity::kDy[dir]));
+            }
+        }
+        return true;
+    }
+
+    bool canMove(int index, int dir) const
+    {
+        return grid.isOpen(neighbour(index, dir)) && sidesOpen(index, dir);
+    }
+
+    // 节点加入开放列表：计数，并记录开放列表的峰值和对应的峰值工作内存
+    void trackOpenSize()
+    {
+        ++stats.nodesGenerated;
+        const int openSize = queue.size();
+        if (openSize > stats.peakOpenSize) {
+            stats.peakOpenSize = openSize;
+            stats.workspaceBytes = fixedBytes + qint64(openSize) * Queue::kEntryBytes;
+        }
+    }
+
+    void record(int index)
+    {
+        lastIndex = index;
+        ++stats.nodesExpanded;
+        if (trace) {
+            trace->record(grid.point(index));
+        }
+    }
+
+    void stepBestFirst()
+    {
+        if (queue.isEmpty()) {
+            finished = true;
+            return;
+        }
+        const int current = queue.pop();
+        Record& node = records[current];
+        setState(current, Closed);
+        record(current);
+        if (current == goalIndex) {
+            finished = reached = true;
+            return;
+        }
+
+        const int x = grid.column(current);
+        const int y = grid.row(current);
+        for (int dir = 0; dir < Connectivity::kCount; ++dir) {
+            if (!canMove(current, dir)) {
+                continue;
+            }
+            const int next = neighbour(current, dir);
+            Record& neighbor = records[next];
+            if (neighbor.state == Closed) {
+                continue;
+            }
+            const int g = node.g + (isDiagonal(dir) ? Cost::kDiagonal : Cost::kStraight);
+            if (neighbor.state == Unseen) {
+                setState(next, Open);
+                neighbor.g = g;
+                neighbor.parent = current;
+                queue.push(next, g + estimate(x + Connectivity::kDx[dir], y + Connectivity::kDy[dir]));
+                trackOpenSize();
+            } else if (g < neighbor.g) {
+                neighbor.g = g;
+                neighbor.parent = current;
+                queue.update(next, g + estimate(x + Connectivity::kDx[dir], y + Connectivity::kDy[dir]));
+            }
+        }
+    }
+
+    // 到达的格子进入当前路径，作为一次扩展
+    void visit(int index)
+    {
+        setState(index, Open);
+        queue.push(index, 0);
+        record(index);
+        trackOpenSize();
+    }
+
+    // 沿当前路径尝试下一个方向，直到进入一个新格子、到达目标或回溯到起点之前
+    void stepDepthFirst()
+    {
+        while (!queue.isEmpty()) {
+            typename Queue::Frame& frame = queue.top();
+            if (frame.next == Connectivity::kCount) {
+                setState(frame.index, Closed);
+                queue.pop();
+                continue;
+            }
+            const int dir = frame.next++;
+            const int next = neighbour(frame.index, dir);
+            // 先检查目标再检查能否通行：目标格子本身不要求可通行
+            if (next == goalIndex && sidesOpen(frame.index, dir)) {
+                finished = reached = true;
+                return;
+            }
+            if (!canMove(frame.index, dir) || records[next].state != Unseen) {
+                continue;
+            }
+            visit(next);
+            return;
+        }
+        finished = true;
+    }
+
+    const Grid& grid;
+    PathSearch::SearchStats localStats;
+    PathSearch::SearchStats& stats;
+    PathSearch::ExpansionTrace* trace;
+    QVector<int>* changes;
+    int lastIndex;
+    const int startIndex;
+    const int goalIndex;
+    const typename Grid::template Neighbours<Connectivity> neighbours;
+    const int goalX;          // 目标的地图坐标
+    const int goalY;
+    qint64 fixedBytes;
+    QVector<Record> records;
+    Queue queue;
+    bool finished;
+    bool reached;
+};
+
+// 内置算法使用的实例（D* 是从终点向起点运行的 A*），Grid 是格子的存放方式
+template <typename Grid>
+using AStarKernel = Search<FourConnected, ManhattanHeuristic, MinHeapQueue, UnitCost, Grid>;
+template <typename Grid>
+using DijkstraKernel = Search<FourConnected, ZeroHeuristic, MinHeapQueue, UnitCost, Grid>;
+template <typename Grid>
+using BreadthFirstKernel = Search<FourConnected, ZeroHeuristic, FifoQueue, UnitCost, Grid>;
+template <typename Grid>
+using DepthFirstKernel = Search<FourConnected, ZeroHeuristic, DepthFirstStack, UnitCost, Grid>;
+
+using AStarSearch = AStarKernel<PaddedGrid>;
+using DijkstraSearch = DijkstraKernel<PaddedGrid>;
+using BreadthFirstSearch = BreadthFirstKernel<PaddedGrid>;
+using DepthFirstSearch = DepthFirstKernel<PaddedGrid>;
+
+} // namespace SearchKernel
+
+#endif // SEARCHKERNEL_H
@@ -0,0 +1,37 @@
+#ifndef SEARCHSTATSDOCK_H
+#define SEARCHSTATSDOCK_H
+
+#include <QDockWidget>
+#include <QTableWidget>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QTime>
+#include "pathsearch.h"
+
+// 搜索统计面板：记录最近 N 次寻路的统计信息，最新的一次在最上面
+// 每次寻路只在顶部插入一行，超出数量时从底部删除，已有的行不重建
+class SearchStatsDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SearchStatsDock(QWidget *parent = nullptr);
+
+    // pathLength 为 -1 表示未找到路径
+    void addRun(const PathSearch::SearchStats& stats, int pathLength);
+    void clearHistory();
+
+private slots:
+    void onHistoryLimitChanged(int limit);
+
+private:
+    void setRow(int row, const QTime& time, const PathSearch::SearchStats& stats, int pathLength);
+    // 从底部删除最早的记录，只保留 limit 行
+    void trimRows(int limit);
+
+    QTableWidget *historyTable;
+    QSpinBox *historyLimitSpinBox;
+    QPushButton *clearButton;
+};
+
+#endif // SEARCHSTATSDOCK_H
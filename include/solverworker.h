@@ -0,0 +1,123 @@
+#ifndef SOLVERWORKER_H
+#define SOLVERWORKER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPoint>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QProcessEnvironment>
+#include "pathsearch.h"
+
+class QProcess;
+class QTemporaryFile;
+class QTimer;
+
+// 常驻的求解子进程：栅格写入共享的映射文件（按行存放，每格一个字节，0 表示可通行），
+// 请求和结果通过标准输入输出以定长二进制记录传递；用户代码的输出被重定向到标准错误
+// NativeCodeRunner（编译后的C++程序）和 PythonCodeRunner（Python解释器）共用这一协议
+//
+// 请求是异步的：loadCode 和 solve 发出请求后立即返回，结果由事件循环收齐后通过 finished 发出，
+// 等待用户代码（最长 10 秒）时不阻塞调用线程；同一时间只有一个请求
+class SolverWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 请求记录：10 个 int32（本机字节序）
+    //   magic, command, rows, cols, startX, startY, endX, endY, sequence, payloadBytes，之后是 payloadBytes 字节的附加数据
+    // 结果记录：4 个 int32 + 2 个 int64
+    //   magic, sequence, status, length, setupNs, searchNs
+    //   status 为 PathFound 时之后是 length 对 int32 (x, y)；为 UserError 时之后是 length 字节的 UTF-8 错误信息
+    enum Command {
+        Solve = 1,
+        LoadCode = 2     // 附加数据为源码，只有解释器工作进程支持
+    };
+
+    enum Status {
+        PathFound = 0,
+        NoPath = 1,
+        UserError = 2    // 用户代码抛出异常或加载失败
+    };
+
+    static const qint32 kRequestMagic = 0x51524D47;   // "GMRQ"
+    static const qint32 kResponseMagic = 0x53524D47;  // "GMRS"
+
+    explicit SolverWorker(QObject *parent = nullptr);
+    ~SolverWorker() override;
+
+    // 当前平台能否限制子进程的资源（Unix 上用 setrlimit，Linux 上还有命名空间和 seccomp，见 solverworker.cpp）；
+    // 不能时 start 会给出警告
+    static bool canLimitResources();
+
+    // 启动子进程，命令行为 program arguments... 共享栅格文件 容量
+    // 子进程不继承编辑器的环境变量，只有 environment 中的变量
+    bool start(const QString& program,
+               const QStringList& arguments,
+               const QString& workingDirectory,
+               qint64 cellCount,
+               QString* error,
+               const QProcessEnvironment& environment = QProcessEnvironment());
+    // 停止子进程；正在等待的请求作废，不再发出 finished
+    void stop();
+    bool isRunning() const;
+    bool isBusy() const { return activeCommand != 0; }
+
+    // 栅格超出共享内存，或处理的请求过多（回收用户代码泄漏的内存）时需要重启
+    bool needsRestart(qint64 cellCount) const;
+
+    // 发出请求，请求发出后返回 true，结果通过 finished 发出；进程没有运行或正在处理请求时返回 false
+    bool loadCode(const QByteArray& code, QString* error);
+    bool solve(const GridMap& grid,
+               const QPoint& start,
+               const QPoint& end,
+               QString* error);
+
+signals:
+    // 请求的结果：ok 为 true 时 path 为空表示未找到路径（加载代码的请求 path 总是空的）；
+    // 用户代码出错、超时或工作进程异常时 ok 为 false，error 为错误信息
+    void finished(bool ok, const QList<QPoint>& path, const PathSearch::SearchStats& stats, const QString& error);
+
+private slots:
+    void onReadyRead();
+    void onTimeout();
+    void onProcessFinished();
+
+private:
+    struct Response {
+        qint32 status = NoPath;
+        qint32 length = 0;
+        qint64 setupNs = 0;
+        qint64 searchNs = 0;
+        QByteArray payload;
+    };
+
+    QProcess* process;
+    QTimer* timeoutTimer;
+    QTemporaryFile* gridFile;          // 共享栅格文件，没有时为空
+    uchar* gridMemory;
+    qint64 gridCapacity;
+    qint32 sequence;
+    int runs;                          // 本次启动后处理的请求数
+    QByteArray errorTail;              // 用户代码输出的末尾，出错时附在错误信息后
+
+    // 正在处理的请求
+    qint32 activeCommand;              // 0 表示没有请求
+    QElapsedTimer requestTimer;
+    bool headerReceived;
+    Response response;
+    qint64 payloadBytes;
+
+    bool ensureGridMemory(qint64 cellCount, QString* error);
+    void releaseGridMemory();
+    bool send(qint32 command, int rows, int cols, const QPoint& start, const QPoint& end,
+              const QByteArray& payload, QString* error);
+    void finishRequest();
+    void failRequest(const QString& message);
+    void collectOutput();
+};
+
+#endif // SOLVERWORKER_H
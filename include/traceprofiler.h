@@ -0,0 +1,88 @@
+#ifndef TRACEPROFILER_H
+#define TRACEPROFILER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+// 性能跟踪：在环形缓冲区中记录带起止时间的区间，导出为 Chrome/Perfetto 可读取的 JSON
+// 用 GRIDMAP_TRACE_SCOPE("名称") 在作用域内打点，名称必须是字符串字面量（只保存指针）
+// 未定义 GRIDMAP_ENABLE_TRACE 时打点宏展开为空；编译进来但未开启记录时只有一次原子读
+class TraceProfiler
+{
+public:
+    struct Event {
+        const char* name = nullptr;
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        quintptr threadId = 0;
+    };
+
+    // 作用域计时：构造时取开始时间，析构时写入一条记录
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : name(name), startNs(-1)
+        {
+            TraceProfiler& profiler = TraceProfiler::instance();
+            if (profiler.isEnabled()) {
+                startNs = profiler.now();
+            }
+        }
+        ~Scope()
+        {
+            if (startNs >= 0) {
+                TraceProfiler& profiler = TraceProfiler::instance();
+                profiler.record(name, startNs, profiler.now() - startNs);
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        const char* name;
+        qint64 startNs;
+    };
+
+    static TraceProfiler& instance();
+    static bool isCompiledIn();
+
+    // 开启时按容量分配缓冲区，关闭时保留已有记录以便导出
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled.loadRelaxed() != 0; }
+    void setCapacity(int events);
+    void clear();
+    // 缓冲区中是否有记录（关闭记录后也保留，可以导出）
+    bool hasRecords() const;
+
+    qint64 now() const { return clock.nsecsElapsed(); }
+    void record(const char* name, qint64 startNs, qint64 durationNs);
+
+    // 导出最近 windowNs 纳秒内开始的记录（Chrome trace event 格式）
+    QByteArray toChromeTrace(qint64 windowNs) const;
+    bool save(const QString& filename, qint64 windowNs) const;
+
+private:
+    TraceProfiler();
+    Q_DISABLE_COPY(TraceProfiler)
+
+    QElapsedTimer clock;
+    QAtomicInteger<int> enabled;
+    mutable QMutex mutex;              // 保护以下缓冲区
+    QVector<Event> events;
+    int capacity;
+    quint64 written;                   // 累计写入数量，写入位置为 written % capacity
+};
+
+#ifdef GRIDMAP_ENABLE_TRACE
+#define GRIDMAP_TRACE_CONCAT_IMPL(a, b) a##b
+#define GRIDMAP_TRACE_CONCAT(a, b) GRIDMAP_TRACE_CONCAT_IMPL(a, b)
+#define GRIDMAP_TRACE_SCOPE(name) TraceProfiler::Scope GRIDMAP_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+#define GRIDMAP_TRACE_SCOPE(name) do {} while (false)
+#endif
+
+#endif // TRACEPROFILER_H
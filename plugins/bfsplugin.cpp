@@ -0,0 +1,116 @@
+#include "../include/gridmapplugin.h"
+#include <chrono>
+#include <vector>
+
+// 插件示例：四连通广度优先搜索，在编辑器为当前地图版本按行展开的一份格子上运行
+// 只依赖 gridmapplugin.h，不链接 Qt 和 GridMapCore；自己的插件可以从这个文件开始改
+// 构建后位于 plugins 目录（GridMapExamplePlugin），编辑器启动时自动加载
+
+namespace {
+
+long long nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+extern "C" {
+
+GRIDMAP_PLUGIN_EXPORT int gridmap_plugin_init(int abi_version, const char** name)
+{
+    if (abi_version != GRIDMAP_PLUGIN_ABI_VERSION) {
+        return -1;
+    }
+    *name = "BFS (插件示例)";
+    return 0;
+}
+
+GRIDMAP_PLUGIN_EXPORT int gridmap_plugin_search(const gmp_grid_view* grid,
+                                                int start_x, int start_y,
+                                                int end_x, int end_y,
+                                                int* out_xy,
+                                                int capacity,
+                                                int* out_length,
+                                                gmc_search_stats* stats)
+{
+    static const int dx[] = { 0, 1, 0, -1 };
+    static const int dy[] = { -1, 0, 1, 0 };
+
+    *out_length = 0;
+    const int rows = grid->rows;
+    const int cols = grid->cols;
+    if (rows <= 0 || cols <= 0 || grid->stride < cols) {
+        return GMC_INVALID_ARGUMENT;
+    }
+
+    // 工作数组按调用分配，多个线程可以同时搜索
+    long long clock = nowNs();
+    const int cellCount = rows * cols;
+    std::vector<int> parent(cellCount, -1);    // 到达该格子的上一个格子，-1 表示未访问
+    std::vector<int> queue;
+    queue.reserve(cellCount);
+    const int startIndex = start_y * cols + start_x;
+    const int endIndex = end_y * cols + end_x;
+    parent[startIndex] = startIndex;
+    queue.push_back(startIndex);
+    stats->setup_time_ns = nowNs() - clock;
+
+    clock = nowNs();
+    size_t head = 0;
+    bool found = false;
+    while (head < queue.size()) {
+        const int current = queue[head++];
+        ++stats->nodes_expanded;
+        if (current == endIndex) {
+            found = true;
+            break;
+        }
+        const int x = current % cols;
+        const int y = current / cols;
+        for (int dir = 0; dir < 4; ++dir) {
+            const int nx = x + dx[dir];
+            const int ny = y + dy[dir];
+            if (nx < 0 || nx >= cols || ny < 0 || ny >= rows) {
+                continue;
+            }
+            const int next = ny * cols + nx;
+            if (parent[next] >= 0 || grid->cells[ny * grid->stride + nx] == 1) {
+                continue;
+            }
+            parent[next] = current;
+            queue.push_back(next);
+            ++stats->nodes_generated;
+        }
+        const int openSize = static_cast<int>(queue.size() - head);
+        if (openSize > stats->peak_open_size) {
+            stats->peak_open_size = openSize;
+        }
+    }
+    stats->workspace_bytes = static_cast<long long>(cellCount) * sizeof(int) * 2;
+    stats->search_time_ns = nowNs() - clock;
+    if (!found) {
+        return GMC_NO_PATH;
+    }
+
+    clock = nowNs();
+    int length = 1;
+    for (int index = endIndex; index != startIndex; index = parent[index]) {
+        ++length;
+    }
+    *out_length = length;
+    if (length > capacity) {
+        return GMC_BUFFER_TOO_SMALL;
+    }
+    int index = endIndex;
+    for (int i = length - 1; i >= 0; --i) {
+        out_xy[2 * i] = index % cols;
+        out_xy[2 * i + 1] = index / cols;
+        index = parent[index];
+    }
+    stats->reconstruction_time_ns = nowNs() - clock;
+    return GMC_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,243 @@
+#include "../include/algorithmplugins.h"
+#include "../include/traceprofiler.h"
+#include <QLibrary>
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QDebug>
+
+static const int kInitialPathCapacity = 1 << 16;   // 输出缓冲区的初始点数，不够时按插件报告的长度扩大
+
+AlgorithmPlugins::AlgorithmPlugins()
+    : defaultsLoaded(false)
+{
+}
+
+AlgorithmPlugins& AlgorithmPlugins::instance()
+{
+    static AlgorithmPlugins plugins;
+    return plugins;
+}
+
+QStringList AlgorithmPlugins::defaultDirectories()
+{
+    QStringList directories;
+    if (QCoreApplication::instance()) {
+        directories << QCoreApplication::applicationDirPath() + QStringLiteral("/plugins");
+    }
+    const QString extra = qEnvironmentVariable("GRIDMAP_PLUGIN_PATH");
+    for (const QString& path : extra.split(QDir::listSeparator(), Qt::SkipEmptyParts)) {
+        directories << path;
+    }
+    return directories;
+}
+
+void AlgorithmPlugins::loadDefaultPlugins()
+{
+    if (defaultsLoaded) {
+        return;
+    }
+    defaultsLoaded = true;
+
+    GRIDMAP_TRACE_SCOPE("AlgorithmPlugins::loadDefaultPlugins");
+    QStringList errors;
+    for (const QString& directory : defaultDirectories()) {
+        loadDirectory(directory, &errors);
+    }
+    for (const QString& error : errors) {
+        qWarning().noquote() << error;
+    }
+}
+
+int AlgorithmPlugins::loadDirectory(const QString& path, QStringList* errors)
+{
+    const QDir dir(path);
+    if (!dir.exists()) {
+        return 0;
+    }
+
+    int loaded = 0;
+    const QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Name);
+    for (const QFileInfo& file : files) {
+        if (!QLibrary::isLibrary(file.fileName())) {
+            continue;
+        }
+        QString error;
+        if (loadLibrary(file.absoluteFilePath(), &error)) {
+            ++loaded;
+        } else if (errors) {
+            errors->append(tr("无法加载插件 %1：%2").arg(QDir::toNativeSeparators(file.absoluteFilePath()), error));
+        }
+    }
+    return loaded;
+}
+
+bool AlgorithmPlugins::loadLibrary(const QString& filePath, QString* error)
+{
+    if (plugins.size() >= kMaxPlugins) {
+        *error = tr("插件数量超过上限 %1").arg(kMaxPlugins);
+        return false;
+    }
+    for (const Plugin& plugin : plugins) {
+        if (QFileInfo(plugin.library->fileName()) == QFileInfo(filePath)) {
+            *error = tr("已经加载");
+            return false;
+        }
+    }
+
+    QLibrary* library = new QLibrary(filePath);
+    if (!library->load()) {
+        *error = library->errorString();
+        delete library;
+        return false;
+    }
+
+    const gmp_init_fn init = reinterpret_cast<gmp_init_fn>(library->resolve(GRIDMAP_PLUGIN_INIT_SYMBOL));
+    const gmp_search_fn search = reinterpret_cast<gmp_search_fn>(library->resolve(GRIDMAP_PLUGIN_SEARCH_SYMBOL));
+    const char* name = nullptr;
+    if (!init || !search) {
+        *error = tr("没有导出 %1 和 %2").arg(QLatin1String(GRIDMAP_PLUGIN_INIT_SYMBOL),
+                                             QLatin1String(GRIDMAP_PLUGIN_SEARCH_SYMBOL));
+    } else if (init(GRIDMAP_PLUGIN_ABI_VERSION, &name) != 0) {
+        *error = tr("插件不支持接口版本 %1").arg(GRIDMAP_PLUGIN_ABI_VERSION);
+    } else if (!name || !*name) {
+        *error = tr("插件没有提供算法名称");
+    } else if (find(QString::fromUtf8(name)) != PathSearch::Unknown) {
+        *error = tr("算法名称 %1 与已加载的插件重复").arg(QString::fromUtf8(name));
+    } else {
+        Plugin plugin;
+        plugin.library = library;
+        plugin.name = QString::fromUtf8(name);
+        plugin.search = search;
+        plugins.append(plugin);
+        return true;
+    }
+    library->unload();
+    delete library;
+    return false;
+}
+
+QList<PathSearch::AlgorithmType> AlgorithmPlugins::algorithms() const
+{
+    QList<PathSearch::AlgorithmType> result;
+    for (int i = 0; i < plugins.size(); ++i) {
+        result.append(static_cast<PathSearch::AlgorithmType>(PathSearch::FirstPlugin + i));
+    }
+    return result;
+}
+
+const AlgorithmPlugins::Plugin* AlgorithmPlugins::plugin(PathSearch::AlgorithmType algorithm) const
+{
+    const int index = int(algorithm) - PathSearch::FirstPlugin;
+    return index >= 0 && index < plugins.size() ? &plugins[index] : nullptr;
+}
+
+bool AlgorithmPlugins::contains(PathSearch::AlgorithmType algorithm) const
+{
+    return plugin(algorithm) != nullptr;
+}
+
+PathSearch::AlgorithmType AlgorithmPlugins::find(const QString& name) const
+{
+    for (int i = 0; i < plugins.size(); ++i) {
+        if (plugins[i].name.compare(name.trimmed(), Qt::CaseInsensitive) == 0) {
+            return static_cast<PathSearch::AlgorithmType>(PathSearch::FirstPlugin + i);
+        }
+    }
+    return PathSearch::Unknown;
+}
+
+QString AlgorithmPlugins::name(PathSearch::AlgorithmType algorithm) const
+{
+    const Plugin* entry = plugin(algorithm);
+    return entry ? entry->name : QString();
+}
+
+QString AlgorithmPlugins::fileName(PathSearch::AlgorithmType algorithm) const
+{
+    const Plugin* entry = plugin(algorithm);
+    return entry ? entry->library->fileName() : QString();
+}
+
+bool AlgorithmPlugins::search(PathSearch::AlgorithmType algorithm,
+                              const quint8* cells,
+                              int rows,
+                              int cols,
+                              int stride,
+                              const QPoint& start,
+                              const QPoint& end,
+                              QList<QPoint>* path,
+                              PathSearch::SearchStats* stats,
+                              QString* error) const
+{
+    GRIDMAP_TRACE_SCOPE("AlgorithmPlugins::search");
+    path->clear();
+    *stats = PathSearch::SearchStats();
+    stats->algorithm = algorithm;
+
+    const Plugin* entry = plugin(algorithm);
+    if (!entry) {
+        *error = tr("插件算法不存在！");
+        return false;
+    }
+
+    gmp_grid_view view;
+    view.cells = cells;
+    view.rows = rows;
+    view.cols = cols;
+    view.stride = stride;
+
+    // 每个线程一个输出缓冲区，跨调用复用；路径点数不会超过格子数
+    thread_local QVector<int> buffer;
+    const int initialSize = 2 * int(qMin<qint64>(qint64(rows) * cols, kInitialPathCapacity));
+    if (buffer.size() < initialSize) {
+        buffer.resize(initialSize);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    gmc_search_stats pluginStats;
+    int length = 0;
+    int status;
+    for (;;) {
+        pluginStats = gmc_search_stats();
+        length = 0;
+        status = entry->search(&view, start.x(), start.y(), end.x(), end.y(),
+                               buffer.data(), buffer.size() / 2, &length, &pluginStats);
+        if (status != GMC_BUFFER_TOO_SMALL || length <= buffer.size() / 2
+            || qint64(length) > qint64(rows) * cols) {
+            break;
+        }
+        buffer.resize(2 * length);
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    if (status != GMC_OK && status != GMC_NO_PATH) {
+        *error = tr("插件 %1 返回错误 %2").arg(entry->name).arg(status);
+        return false;
+    }
+    if (status == GMC_OK && (length < 0 || length > buffer.size() / 2)) {
+        *error = tr("插件 %1 返回的路径长度无效（%2）").arg(entry->name).arg(length);
+        return false;
+    }
+
+    stats->nodesExpanded = pluginStats.nodes_expanded;
+    stats->nodesGenerated = pluginStats.nodes_generated;
+    stats->peakOpenSize = pluginStats.peak_open_size;
+    stats->workspaceBytes = pluginStats.workspace_bytes;
+    stats->setupTimeNs = pluginStats.setup_time_ns;
+    stats->searchTimeNs = pluginStats.search_time_ns;
+    stats->reconstructionTimeNs = pluginStats.reconstruction_time_ns;
+
+    if (status == GMC_OK) {
+        path->reserve(length);
+        for (int i = 0; i < length; ++i) {
+            path->append(QPoint(buffer[2 * i], buffer[2 * i + 1]));
+        }
+    }
+    // 插件没有自己计时时，整个调用都计入搜索时间
+    if (stats->totalTimeNs() == 0) {
+        stats->searchTimeNs = elapsedNs;
+    }
+    return true;
+}
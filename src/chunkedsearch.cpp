@@ -0,0 +1,390 @@
+#include "../include/chunkedsearch.h"
+#include "../include/gridmap.h"
+#include "../include/traceprofiler.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 与 SearchKernel::FourConnected 相同的扩展顺序
+static const int kDirections = 4;
+static const int kDx[kDirections] = { -1, 1, 0, 0 };
+static const int kDy[kDirections] = { 0, 0, -1, 1 };
+
+static const int kChunkCells = GridMap::ChunkSize * GridMap::ChunkSize;
+static const int kChunkMask = GridMap::ChunkSize - 1;
+
+// 先进先出的开放列表出队超过这么多格子、且超过一半时收回前面的空间
+static const int kFifoCompactThreshold = 4096;
+
+// 一次搜索：开放列表和 SearchKernel 的三种一一对应，出队和入队的顺序相同
+class ChunkedRun
+{
+public:
+    enum Mode {
+        BestFirst,      // MinHeapQueue
+        BreadthFirst,   // FifoQueue
+        DepthFirst      // DepthFirstStack
+    };
+
+    ChunkedRun(const GridMap& grid, Mode mode, bool heuristic,
+               const QPoint& start, const QPoint& goal,
+               PathSearch::SearchStats& stats, PathSearch::ExpansionTrace* trace)
+        : grid(grid),
+          mode(mode),
+          heuristic(heuristic),
+          start(start),
+          goal(goal),
+          stats(stats),
+          trace(trace),
+          pushed(0),
+          openCount(0),
+          fifoHead(0),
+          blockBytes(0),
+          finished(false),
+          reached(false)
+    {
+        if (!grid.contains(start) || !grid.contains(goal)) {
+            finished = true;
+            return;
+        }
+        blocks.resize(grid.chunkRows() * grid.chunkCols());
+
+        if (mode == DepthFirst) {
+            // 起点就是终点时不扩展任何格子；起点不可通行时没有路径
+            if (start == goal) {
+                finished = reached = true;
+            } else if (!isOpen(start.x(), start.y())) {
+                finished = true;
+            } else {
+                visit(start.x(), start.y());
+            }
+        } else {
+            Record& node = recordAt(start.x(), start.y());
+            node.state = Open;
+            node.g = 0;
+            push(start.x(), start.y(), node, estimate(start.x(), start.y()));
+            trackOpenSize();
+        }
+    }
+
+    void run()
+    {
+        while (!finished) {
+            if (mode == DepthFirst) {
+                stepDepthFirst();
+            } else {
+                stepBestFirst();
+            }
+        }
+    }
+
+    QList<QPoint> path()
+    {
+        QList<QPoint> result;
+        if (!reached) {
+            return result;
+        }
+        if (mode == DepthFirst) {
+            result.reserve(frames.size() + 1);
+            for (const Frame& frame : frames) {
+                result.append(QPoint(frame.x, frame.y));
+            }
+            result.append(goal);
+            return result;
+        }
+        // 每个格子记录从父节点走过来的方向，沿反方向走回起点
+        int x = goal.x();
+        int y = goal.y();
+        while (x != start.x() || y != start.y()) {
+            result.append(QPoint(x, y));
+            const int dir = recordAt(x, y).parent - 1;
+            x -= kDx[dir];
+            y -= kDy[dir];
+        }
+        std::reverse(result.begin(), result.end());
+        result.prepend(start);
+        return result;
+    }
+
+private:
+    enum CellState : quint8 {
+        Unseen,
+        Open,
+        Closed
+    };
+
+    struct Record {
+        int g = 0;
+        int priority = -1;     // 在开放列表（堆）中的当前优先级，-1 表示不在
+        int sequence = 0;      // 首次加入开放列表的顺序
+        quint8 state = Unseen;
+        quint8 parent = 0;     // 从父节点走过来的方向 + 1，起点为 0
+    };
+
+    struct Entry {
+        int priority;
+        int sequence;
+        int x;
+        int y;
+    };
+
+    struct Frame {
+        int x;
+        int y;
+        int next;
+    };
+
+    static bool later(const Entry& a, const Entry& b)
+    {
+        return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+    }
+
+    bool isOpen(int x, int y) const { return grid.contains(x, y) && !grid.isBlocked(x, y); }
+
+    int estimate(int x, int y) const
+    {
+        return heuristic ? std::abs(x - goal.x()) + std::abs(y - goal.y()) : 0;
+    }
+
+    // 格子所在地图块的工作记录，第一次访问这一块时才分配
+    Record& recordAt(int x, int y)
+    {
+        QVector<Record>& block = blocks[(y >> GridMap::ChunkShift) * grid.chunkCols() + (x >> GridMap::ChunkShift)];
+        if (block.isEmpty()) {
+            block.resize(kChunkCells);
+            blockBytes += qint64(kChunkCells) * sizeof(Record);
+        }
+        return block[((y & kChunkMask) << GridMap::ChunkShift) | (x & kChunkMask)];
+    }
+
+    int openSize() const
+    {
+        switch (mode) {
+            case BestFirst:
+                return openCount;
+            case BreadthFirst:
+                return fifo.size() - fifoHead;
+            default:
+                return frames.size();
+        }
+    }
+
+    qint64 entryBytes() const
+    {
+        switch (mode) {
+            case BestFirst:
+                return sizeof(Entry);
+            case BreadthFirst:
+                return sizeof(QPoint);
+            default:
+                return sizeof(Frame);
+        }
+    }
+
+    void push(int x, int y, Record& node, int priority)
+    {
+        if (mode == BreadthFirst) {
+            fifo.append(QPoint(x, y));
+            return;
+        }
+        node.priority = priority;
+        node.sequence = pushed++;
+        ++openCount;
+        heap.append(Entry{ priority, node.sequence, x, y });
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    // 代价改善：堆中压入新条目并保留原来的加入顺序，先进先出的开放列表不调整
+    void update(int x, int y, Record& node, int priority)
+    {
+        if (mode == BreadthFirst) {
+            return;
+        }
+        node.priority = priority;
+        heap.append(Entry{ priority, node.sequence, x, y });
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    QPoint pop()
+    {
+        if (mode == BreadthFirst) {
+            const QPoint next = fifo.at(fifoHead++);
+            if (fifoHead > kFifoCompactThreshold && fifoHead * 2 > fifo.size()) {
+                fifo.remove(0, fifoHead);
+                fifoHead = 0;
+            }
+            return next;
+        }
+        for (;;) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            const Entry entry = heap.takeLast();
+            Record& node = recordAt(entry.x, entry.y);
+            if (node.priority == entry.priority) {
+                node.priority = -1;
+                --openCount;
+                return QPoint(entry.x, entry.y);
+            }
+        }
+    }
+
+    void trackOpenSize()
+    {
+        ++stats.nodesGenerated;
+        const int size = openSize();
+        if (size > stats.peakOpenSize) {
+            stats.peakOpenSize = size;
+            stats.workspaceBytes = blockBytes + qint64(size) * entryBytes();
+        }
+    }
+
+    void record(const QPoint& pos)
+    {
+        ++stats.nodesExpanded;
+        if (trace) {
+            trace->record(pos);
+        }
+    }
+
+    void stepBestFirst()
+    {
+        if (openSize() == 0) {
+            finished = true;
+            return;
+        }
+        const QPoint current = pop();
+        Record& node = recordAt(current.x(), current.y());
+        node.state = Closed;
+        record(current);
+        if (current == goal) {
+            finished = reached = true;
+            return;
+        }
+
+        // 不同块的记录是各自的存储，分配新块不影响 node
+        for (int dir = 0; dir < kDirections; ++dir) {
+            const int x = current.x() + kDx[dir];
+            const int y = current.y() + kDy[dir];
+            if (!isOpen(x, y)) {
+                continue;
+            }
+            Record& neighbor = recordAt(x, y);
+            if (neighbor.state == Closed) {
+                continue;
+            }
+            const int g = node.g + 1;
+            if (neighbor.state == Unseen) {
+                neighbor.state = Open;
+                neighbor.g = g;
+                neighbor.parent = quint8(dir + 1);
+                push(x, y, neighbor, g + estimate(x, y));
+                trackOpenSize();
+            } else if (g < neighbor.g) {
+                neighbor.g = g;
+                neighbor.parent = quint8(dir + 1);
+                update(x, y, neighbor, g + estimate(x, y));
+            }
+        }
+    }
+
+    void visit(int x, int y)
+    {
+        recordAt(x, y).state = Open;
+        frames.append(Frame{ x, y, 0 });
+        record(QPoint(x, y));
+        trackOpenSize();
+    }
+
+    void stepDepthFirst()
+    {
+        while (!frames.isEmpty()) {
+            Frame& frame = frames.last();
+            if (frame.next == kDirections) {
+                recordAt(frame.x, frame.y).state = Closed;
+                frames.removeLast();
+                continue;
+            }
+            const int dir = frame.next++;
+            const int x = frame.x + kDx[dir];
+            const int y = frame.y + kDy[dir];
+            // 先检查目标再检查能否通行：目标格子本身不要求可通行
+            if (x == goal.x() && y == goal.y()) {
+                finished = reached = true;
+                return;
+            }
+            if (!isOpen(x, y) || recordAt(x, y).state != Unseen) {
+                continue;
+            }
+            visit(x, y);
+            return;
+        }
+        finished = true;
+    }
+
+    const GridMap& grid;
+    const Mode mode;
+    const bool heuristic;
+    const QPoint start;
+    const QPoint goal;
+    PathSearch::SearchStats& stats;
+    PathSearch::ExpansionTrace* trace;
+    QVector<QVector<Record>> blocks;   // 按地图块的行顺序，没有搜索到的块为空
+    QVector<Entry> heap;
+    QVector<QPoint> fifo;
+    QVector<Frame> frames;
+    int pushed;
+    int openCount;
+    int fifoHead;
+    qint64 blockBytes;                 // 已分配的工作记录
+    bool finished;
+    bool reached;
+};
+
+} // namespace
+
+QList<QPoint> ChunkedSearch::run(PathSearch::AlgorithmType algorithm,
+                                 const GridMap& grid,
+                                 const QPoint& start,
+                                 const QPoint& end,
+                                 PathSearch::SearchStats* stats,
+                                 PathSearch::ExpansionTrace* trace)
+{
+    GRIDMAP_TRACE_SCOPE("ChunkedSearch::run");
+    ChunkedRun::Mode mode = ChunkedRun::BestFirst;
+    bool heuristic = false;
+    switch (algorithm) {
+        case PathSearch::AStar:
+        case PathSearch::DStar:
+            heuristic = true;
+            break;
+        case PathSearch::Dijkstra:
+            break;
+        case PathSearch::BFS:
+            mode = ChunkedRun::BreadthFirst;
+            break;
+        case PathSearch::DFS:
+            mode = ChunkedRun::DepthFirst;
+            break;
+        default:
+            return QList<QPoint>();
+    }
+
+    PathSearch::SearchStats localStats;
+    PathSearch::SearchStats& searchStats = stats ? *stats : localStats;
+    // D* 同 PathSearch::executeDStar：从终点向起点的 A*，路径反过来
+    const bool reversed = algorithm == PathSearch::DStar;
+    QElapsedTimer timer;
+    timer.start();
+    ChunkedRun search(grid, mode, heuristic, reversed ? end : start, reversed ? start : end, searchStats, trace);
+    searchStats.setupTimeNs = timer.nsecsElapsed();
+    search.run();
+    searchStats.searchTimeNs = timer.nsecsElapsed() - searchStats.setupTimeNs;
+    QList<QPoint> path = search.path();
+    if (reversed) {
+        std::reverse(path.begin(), path.end());
+    }
+    searchStats.reconstructionTimeNs = timer.nsecsElapsed() - searchStats.setupTimeNs - searchStats.searchTimeNs;
+    return path;
+}
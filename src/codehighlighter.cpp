@@ -32,7 +32,10 @@ void CodeHighlighter::setupHighlightingRules()
         "\\bexcept\\b", "\\bin\\b", "\\braise\\b", "\\breturn\\b",
         // Java关键字
         "\\babstract\\b", "\\bextends\\b", "\\bimplements\\b", "\\bthrows\\b",
-        "\\bsynchronized\\b", "\\bvolatile\\b", "\\btransient\\b"
+        "\\bsynchronized\\b", "\\bvolatile\\b", "\\btransient\\b",
+        // 寻路规则（PathScript）
+        "^\\s*heuristic\\b", "^\\s*cost\\b", "^\\s*priority\\b", "^\\s*tie\\b",
+        "^\\s*order\\b", "\\bfifo\\b", "\\blifo\\b"
     };
 
     for (const QString &pattern : keywordPatterns) {
@@ -0,0 +1,245 @@
+#include "../include/editjournal.h"
+#include "../include/gridmap.h"
+#include "../include/traceprofiler.h"
+#include <QSet>
+
+// 一段最多的格子数（Run::length 是 16 位）
+static const int kMaxRunLength = 0xffff;
+
+EditJournal::EditJournal()
+    : recording(false), overflow(false), budgetBytes(DefaultBudgetBytes), usedBytes(0)
+{
+}
+
+void EditJournal::clear()
+{
+    undoEdits.clear();
+    redoEdits.clear();
+    pending = Edit();
+    recording = false;
+    overflow = false;
+    usedBytes = 0;
+}
+
+void EditJournal::setBudget(qint64 bytes)
+{
+    budgetBytes = qMax(qint64(0), bytes);
+    trim();
+}
+
+void EditJournal::beginEdit()
+{
+    recording = true;
+}
+
+void EditJournal::endEdit()
+{
+    if (!recording) {
+        return;
+    }
+    recording = false;
+    commit();
+}
+
+void EditJournal::record(int x, int y, int before, int after)
+{
+    const int from = journalValue(before);
+    const int to = journalValue(after);
+    if (from != to) {
+        append(x, y, 1, from, to);
+    }
+    if (!recording) {
+        commit();
+    }
+}
+
+void EditJournal::recordDiff(const GridMap& before, const GridMap& after)
+{
+    GRIDMAP_TRACE_SCOPE("EditJournal::recordDiff");
+    if (before.rows() != after.rows() || before.cols() != after.cols()) {
+        return;
+    }
+    QVector<int> changedChunks;
+    for (int chunkY = 0; chunkY < after.chunkRows() && !overflow; ++chunkY) {
+        changedChunks.clear();
+        for (int chunkX = 0; chunkX < after.chunkCols(); ++chunkX) {
+            if (!after.sharesChunk(before, chunkX, chunkY)) {
+                changedChunks.append(chunkX);
+            }
+        }
+        if (changedChunks.isEmpty()) {
+            continue;
+        }
+        // 按行遍历变化的块，同一行上跨块相邻的格子也能合并成一段
+        const int top = chunkY * GridMap::ChunkSize;
+        const int height = qMin(GridMap::ChunkSize, after.rows() - top);
+        for (int row = 0; row < height && !overflow; ++row) {
+            const int y = top + row;
+            for (int chunkX : changedChunks) {
+                const int left = chunkX * GridMap::ChunkSize;
+                const int width = qMin(GridMap::ChunkSize, after.cols() - left);
+                const quint8* from = before.chunkData(chunkX, chunkY);
+                const quint8* to = after.chunkData(chunkX, chunkY);
+                if (!from && !to) {
+                    const int fromValue = journalValue(before.chunkValue(chunkX, chunkY));
+                    const int toValue = journalValue(after.chunkValue(chunkX, chunkY));
+                    if (fromValue != toValue) {
+                        append(left, y, width, fromValue, toValue);
+                    }
+                    continue;
+                }
+                const int offset = row * GridMap::ChunkSize;
+                for (int x = 0; x < width; ++x) {
+                    const int fromValue = journalValue(from ? from[offset + x] : before.chunkValue(chunkX, chunkY));
+                    const int toValue = journalValue(to ? to[offset + x] : after.chunkValue(chunkX, chunkY));
+                    if (fromValue != toValue) {
+                        append(left + x, y, 1, fromValue, toValue);
+                    }
+                }
+            }
+        }
+    }
+    if (!recording) {
+        commit();
+    }
+}
+
+bool EditJournal::undo(GridMap* grid, QVector<Run>* changed)
+{
+    GRIDMAP_TRACE_SCOPE("EditJournal::undo");
+    endEdit();
+    if (undoEdits.isEmpty()) {
+        return false;
+    }
+    Edit edit = undoEdits.takeLast();
+    apply(grid, edit, false);
+    if (changed) {
+        *changed = edit.runs;
+    }
+    redoEdits.append(edit);
+    return true;
+}
+
+bool EditJournal::redo(GridMap* grid, QVector<Run>* changed)
+{
+    GRIDMAP_TRACE_SCOPE("EditJournal::redo");
+    endEdit();
+    if (redoEdits.isEmpty()) {
+        return false;
+    }
+    Edit edit = redoEdits.takeLast();
+    apply(grid, edit, true);
+    if (changed) {
+        *changed = edit.runs;
+    }
+    undoEdits.append(edit);
+    return true;
+}
+
+int EditJournal::journalValue(int value)
+{
+    return value == GridMap::Path || value == GridMap::Current || value == GridMap::VisitedPath
+        ? int(GridMap::Empty) : value;
+}
+
+qint64 EditJournal::editBytes(const Edit& edit)
+{
+    return qint64(sizeof(Edit)) + qint64(edit.runs.size()) * sizeof(Run);
+}
+
+void EditJournal::append(int x, int y, int length, int before, int after)
+{
+    if (overflow) {
+        return;
+    }
+    QVector<Run>& runs = pending.runs;
+    // 接在上一段的左边或右边
+    if (!runs.isEmpty()) {
+        Run& last = runs.last();
+        if (last.y == quint32(y) && last.before == before && last.after == after) {
+            const int room = qMin(length, kMaxRunLength - last.length);
+            if (room > 0 && quint32(x) == last.x + last.length) {
+                last.length += room;
+                x += room;
+                length -= room;
+            } else if (room == length && quint32(x + length) == last.x) {
+                last.x = quint32(x);
+                last.length += length;
+                length = 0;
+            }
+        }
+    }
+    while (length > 0) {
+        const int part = qMin(length, kMaxRunLength);
+        runs.append(Run{ quint32(x), quint32(y), quint16(part),
+                         static_cast<quint8>(before), static_cast<quint8>(after) });
+        x += part;
+        length -= part;
+    }
+    // 一个编辑本身超出预算时不再继续记录
+    if (qint64(runs.size()) * sizeof(Run) > budgetBytes) {
+        overflow = true;
+        pending = Edit();
+    }
+}
+
+void EditJournal::commit()
+{
+    if (overflow) {
+        // 没有记下来的编辑之前的记录已经对不上当前地图
+        clear();
+        return;
+    }
+    if (pending.runs.isEmpty()) {
+        return;
+    }
+    for (const Edit& edit : redoEdits) {
+        usedBytes -= editBytes(edit);
+    }
+    redoEdits.clear();
+    pending.runs.squeeze();
+    usedBytes += editBytes(pending);
+    undoEdits.append(pending);
+    pending = Edit();
+    trim();
+}
+
+void EditJournal::trim()
+{
+    while (usedBytes > budgetBytes && !undoEdits.isEmpty()) {
+        usedBytes -= editBytes(undoEdits.first());
+        undoEdits.removeFirst();
+    }
+    // 离当前最远的重做记录
+    while (usedBytes > budgetBytes && !redoEdits.isEmpty()) {
+        usedBytes -= editBytes(redoEdits.first());
+        redoEdits.removeFirst();
+    }
+}
+
+void EditJournal::apply(GridMap* grid, const Edit& edit, bool forward)
+{
+    // 撤销时倒序写回，同一个格子在编辑中改过多次时得到最早的值
+    const int count = edit.runs.size();
+    QSet<qint64> touchedChunks;
+    for (int i = 0; i < count; ++i) {
+        const Run& run = edit.runs.at(forward ? i : count - 1 - i);
+        const int x = int(run.x);
+        const int y = int(run.y);
+        if (!grid->contains(x, y) || !grid->contains(x + run.length - 1, y)) {
+            continue;
+        }
+        const int value = forward ? run.after : run.before;
+        for (int j = 0; j < run.length; ++j) {
+            grid->setCell(x + j, y, value);
+        }
+        const qint64 chunkY = y >> GridMap::ChunkShift;
+        for (int chunkX = x >> GridMap::ChunkShift; chunkX <= (x + run.length - 1) >> GridMap::ChunkShift; ++chunkX) {
+            touchedChunks.insert((chunkY << 32) | chunkX);
+        }
+    }
+    // 写回后整块同一个值的块收回格子存储，只检查写过的块
+    for (qint64 key : touchedChunks) {
+        grid->compact(int(key & 0xffffffff) << GridMap::ChunkShift, int(key >> 32) << GridMap::ChunkShift, 1, 1);
+    }
+}
@@ -41,6 +41,7 @@ void ExampleCodeDialog::setupUI()
     languageComboBox->addItem("C++");
     languageComboBox->addItem("Java");
     languageComboBox->addItem("Python");
+    languageComboBox->addItem(tr("寻路规则"));
     
     selectionLayout->addWidget(algorithmLabel);
     selectionLayout->addWidget(algorithmComboBox);
@@ -719,7 +720,7 @@ private:
             return true;
         }
         
-        if (visited[x][y] || !isValid(x, y)) {
+        if (!isValid(x, y) || visited[x][y]) {
             return false;
         }
         
@@ -786,7 +787,7 @@ public class DFS {
             return true;
         }
         
-        if (visited[x][y] || !isValid(x, y)) {
+        if (!isValid(x, y) || visited[x][y]) {
             return false;
         }
         
@@ -1093,7 +1094,7 @@ public:
         for (int i = 0; i < rows; i++) {
             nodeMap[i].resize(cols);
             for (int j = 0; j < cols; j++) {
-                nodeMap[i][j] = new Node(j, i);
+                nodeMap[i][j] = new Node(i, j);
             }
         }
     }
@@ -1103,12 +1104,12 @@ public:
         goalY = endY;
         
         // 初始化目标节点
-        Node* goal = nodeMap[endY][endX];
+        Node* goal = nodeMap[endX][endY];
         goal->h = 0;
         goal->g = 0;
         insert(goal, 0);
         
-        Node* start = nodeMap[startY][startX];
+        Node* start = nodeMap[startX][startY];
         
         // 运行D*算法
         while (true) {
@@ -1311,7 +1312,7 @@ class DStar:
         for i in range(self.rows):
             row = []
             for j in range(self.cols):
-                row.append(Node(j, i))
+                row.append(Node(i, j))
             self.node_map.append(row)
         
         self.open_list = []
@@ -1319,7 +1320,7 @@ class DStar:
         self.goal_y = 0
     
     def is_valid(self, x: int, y: int) -> bool:
-        return 0 <= x < self.cols and 0 <= y < self.rows and self.grid[y][x] == 0
+        return 0 <= x < self.rows and 0 <= y < self.cols and self.grid[x][y] == 0
     
     def heuristic(self, x1: int, y1: int, x2: int, y2: int) -> int:
         return abs(x1 - x2) + abs(y1 - y2)
@@ -1353,7 +1354,7 @@ class DStar:
             for dx, dy in directions:
                 nx, ny = node.x + dx, node.y + dy
                 if self.is_valid(nx, ny):
-                    neighbor = self.node_map[ny][nx]
+                    neighbor = self.node_map[nx][ny]
                     if neighbor.h <= k_old and node.h > neighbor.h + 1:
                         node.backpointer = neighbor
                         node.h = neighbor.h + 1
@@ -1364,7 +1365,7 @@ class DStar:
             for dx, dy in directions:
                 nx, ny = node.x + dx, node.y + dy
                 if self.is_valid(nx, ny):
-                    neighbor = self.node_map[ny][nx]
+                    neighbor = self.node_map[nx][ny]
                     if not neighbor.in_closed_list or neighbor.h > node.h + 1:
                         neighbor.backpointer = node
                         self.insert(neighbor, node.h + 1)
@@ -1376,12 +1377,12 @@ class DStar:
         self.goal_y = end_y
         
         # 初始化目标节点
-        goal = self.node_map[end_y][end_x]
+        goal = self.node_map[end_x][end_y]
         goal.h = 0
         goal.g = 0
         self.insert(goal, 0)
         
-        start = self.node_map[start_y][start_x]
+        start = self.node_map[start_x][start_y]
         
         # 运行D*算法
         while True:
@@ -1402,6 +1403,33 @@ class DStar:
             return path
         
         return []  # 未找到路径)";
+
+    // 寻路规则：编译成字节码在编辑器内运行，可以直接修改启发函数、代价和扩展顺序
+    exampleCodes["A* 算法-寻路规则"] = R"(# A*：按 f = g + h 从小到大扩展
+# h 为到终点的曼哈顿距离；f 相同时优先扩展离终点近的格子
+heuristic = dx + dy
+priority = g + h
+tie = h
+
+# 可以尝试的变体：
+#   priority = g + 2 * h            加权A*，扩展更少但路径可能变长
+#   tie = h + turn * 0.5            f 相同时少拐弯
+#   cost = 1 + walls                远离障碍物（代价不再是步数）)";
+
+    exampleCodes["Dijkstra 算法-寻路规则"] = R"(# Dijkstra：按到起点的代价 g 从小到大扩展，不使用启发函数
+priority = g
+
+# 代价可以是任意正数，例如贴着障碍物走的代价更高：
+#   cost = 1 + 0.5 * walls)";
+
+    exampleCodes["BFS 广度优先搜索-寻路规则"] = R"(# BFS：按步数逐层扩展，同一层先进先出
+priority = depth
+order = fifo)";
+
+    exampleCodes["DFS 深度优先搜索-寻路规则"] = R"(# DFS：不排序，后加入的格子先扩展
+# 找到的路径不一定最短
+priority = 0
+order = lifo)";
 }
 
 void ExampleCodeDialog::onAlgorithmChanged()
@@ -0,0 +1,127 @@
+#include "../include/framestats.h"
+#include <QCoreApplication>
+
+namespace {
+
+// 卡顿分布的区间上界（毫秒），最后一档没有上界
+const int kStallBoundsMs[FrameStats::StallBuckets - 1] = {2, 8, 16, 50, 200};
+
+QString milliseconds(double ns)
+{
+    return QString::number(ns / 1000000.0, 'f', 2);
+}
+
+} // namespace
+
+FrameStats::FrameStats()
+{
+    clock.start();
+    reset();
+}
+
+void FrameStats::reset()
+{
+    lastPaintNs = 0;
+    averagePaintNs = 0;
+    lastCellsDrawn = 0;
+    replanTimes.clear();
+    pendingEditNs = -1;
+    editToPathNs = -1;
+    keptPaths = 0;
+    lastTickNs = -1;
+    maxStallNs = 0;
+    for (int i = 0; i < StallBuckets; ++i) {
+        stallCounts[i] = 0;
+    }
+}
+
+void FrameStats::addPaint(qint64 durationNs, int cellsDrawn)
+{
+    lastPaintNs = durationNs;
+    lastCellsDrawn = cellsDrawn;
+    averagePaintNs = averagePaintNs == 0 ? durationNs : averagePaintNs * 0.9 + durationNs * 0.1;
+}
+
+void FrameStats::markEdit()
+{
+    // 连续编辑时从第一次编辑开始计算，反映用户实际等待的时间
+    if (pendingEditNs < 0) {
+        pendingEditNs = now();
+    }
+}
+
+void FrameStats::cancelEdit()
+{
+    pendingEditNs = -1;
+}
+
+void FrameStats::addReplan()
+{
+    const qint64 nowNs = now();
+    replanTimes.enqueue(nowNs);
+    pruneReplans(nowNs);
+    if (pendingEditNs >= 0) {
+        editToPathNs = nowNs - pendingEditNs;
+        pendingEditNs = -1;
+    }
+}
+
+void FrameStats::keepPath()
+{
+    // 路径不需要更新，这次编辑不再等待新路径
+    ++keptPaths;
+    pendingEditNs = -1;
+}
+
+void FrameStats::addTick(qint64 intervalNs)
+{
+    const qint64 nowNs = now();
+    if (lastTickNs >= 0) {
+        const qint64 lateNs = qMax<qint64>(0, nowNs - lastTickNs - intervalNs);
+        ++stallCounts[stallBucket(lateNs)];
+        maxStallNs = qMax(maxStallNs, lateNs);
+    }
+    lastTickNs = nowNs;
+}
+
+int FrameStats::stallBucket(qint64 lateNs)
+{
+    for (int i = 0; i < StallBuckets - 1; ++i) {
+        if (lateNs < kStallBoundsMs[i] * 1000000LL) {
+            return i;
+        }
+    }
+    return StallBuckets - 1;
+}
+
+void FrameStats::pruneReplans(qint64 nowNs) const
+{
+    while (!replanTimes.isEmpty() && nowNs - replanTimes.head() > 1000000000LL) {
+        replanTimes.dequeue();
+    }
+}
+
+QStringList FrameStats::summary() const
+{
+    pruneReplans(now());
+
+    QStringList lines;
+    lines << QCoreApplication::translate("FrameStats", "重绘: %1 ms（平均 %2 ms）")
+                 .arg(milliseconds(lastPaintNs), milliseconds(averagePaintNs));
+    lines << QCoreApplication::translate("FrameStats", "绘制格子: %1").arg(lastCellsDrawn);
+    lines << QCoreApplication::translate("FrameStats", "重新规划: %1 次/秒").arg(replanTimes.size());
+    lines << QCoreApplication::translate("FrameStats", "跳过的重新规划: %1").arg(keptPaths);
+    lines << QCoreApplication::translate("FrameStats", "编辑到新路径: %1")
+                 .arg(editToPathNs < 0 ? QStringLiteral("-") : milliseconds(editToPathNs) + " ms");
+
+    QStringList buckets;
+    for (int i = 0; i < StallBuckets; ++i) {
+        const QString range = i < StallBuckets - 1
+            ? QStringLiteral("<%1").arg(kStallBoundsMs[i])
+            : QStringLiteral(">=%1").arg(kStallBoundsMs[StallBuckets - 2]);
+        buckets << QStringLiteral("%1:%2").arg(range).arg(stallCounts[i]);
+    }
+    lines << QCoreApplication::translate("FrameStats", "事件循环延迟(ms) %1").arg(buckets.join(' '));
+    lines << QCoreApplication::translate("FrameStats", "最大延迟: %1 ms").arg(milliseconds(maxStallNs));
+    return lines;
+}
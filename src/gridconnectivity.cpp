@@ -0,0 +1,366 @@
+#include "../include/gridconnectivity.h"
+
+// 方向顺序：上、右、下、左，相反方向为 (dir + 2) % 4
+static const int kDirX[4] = {0, 1, 0, -1};
+static const int kDirY[4] = {-1, 0, 1, 0};
+
+GridConnectivity::GridConnectivity(const QVector<QVector<bool>>& blocked,
+                                   const QPoint& start,
+                                   const QPoint& end,
+                                   int limit)
+    : rows(blocked.size()), cols(blocked.isEmpty() ? 0 : blocked[0].size()),
+      source(-1), sink(-1), flowLimit(qMax(0, limit)), flowValue(0), currentStamp(0)
+{
+    int cellCount = rows * cols;
+    blockedCells.fill(0, cellCount);
+    innerFlow.fill(0, cellCount);
+    edgeFlow.fill(0, cellCount * 4);
+    visitStamp.fill(0, cellCount * 2);
+    parentNode.fill(-1, cellCount * 2);
+
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            blockedCells[index(x, y)] = blocked[y][x] ? 1 : 0;
+        }
+    }
+
+    if (start.x() < 0 || start.x() >= cols || start.y() < 0 || start.y() >= rows ||
+        end.x() < 0 || end.x() >= cols || end.y() < 0 || end.y() >= rows || start == end) {
+        return; // 起终点无效时保持零流量
+    }
+
+    source = index(start.x(), start.y());
+    sink = index(end.x(), end.y());
+    // 起点和终点本身不受障碍影响
+    blockedCells[source] = 0;
+    blockedCells[sink] = 0;
+
+    while (flowValue < flowLimit && augment()) {
+    }
+}
+
+bool GridConnectivity::isBlocked(const QPoint& pos) const
+{
+    if (pos.x() < 0 || pos.x() >= cols || pos.y() < 0 || pos.y() >= rows) {
+        return true;
+    }
+    return blockedCells[index(pos.x(), pos.y())] != 0;
+}
+
+bool GridConnectivity::carriesFlow(const QPoint& pos) const
+{
+    if (pos.x() < 0 || pos.x() >= cols || pos.y() < 0 || pos.y() >= rows) {
+        return false;
+    }
+    return innerFlow[index(pos.x(), pos.y())] != 0;
+}
+
+int GridConnectivity::block(const QPoint& pos)
+{
+    if (source < 0 || pos.x() < 0 || pos.x() >= cols || pos.y() < 0 || pos.y() >= rows) {
+        return flowValue;
+    }
+
+    int cell = index(pos.x(), pos.y());
+    if (isTerminal(cell) || blockedCells[cell]) {
+        return flowValue;
+    }
+
+    blockedCells[cell] = 1;
+
+    // 不在流路径上的格子变成障碍不会影响当前的最大流
+    if (!innerFlow[cell]) {
+        return flowValue;
+    }
+
+    // 先尝试在局部绕开该格子（通常只需要几步），流量不变
+    if (rerouteAround(cell)) {
+        return flowValue;
+    }
+
+    // 无法局部绕开时撤销经过该格子的那条路径，再全局增广一次
+    // 删除一个顶点最多使最大流减少1，因此一次增广就足够恢复
+    cancelFlowThrough(cell);
+    recountFlow();
+    if (flowValue < flowLimit) {
+        augment();
+    }
+    return flowValue;
+}
+
+int GridConnectivity::unblock(const QPoint& pos)
+{
+    if (source < 0 || pos.x() < 0 || pos.x() >= cols || pos.y() < 0 || pos.y() >= rows) {
+        return flowValue;
+    }
+
+    int cell = index(pos.x(), pos.y());
+    if (isTerminal(cell) || !blockedCells[cell]) {
+        return flowValue;
+    }
+
+    blockedCells[cell] = 0;
+
+    // 增加一个顶点最多使最大流增加1
+    if (flowValue < flowLimit) {
+        augment();
+    }
+    return flowValue;
+}
+
+QList<QPoint> GridConnectivity::flowCells() const
+{
+    QList<QPoint> cells;
+    for (int cell = 0; cell < rows * cols; ++cell) {
+        if (innerFlow[cell]) {
+            cells.append(QPoint(cell % cols, cell / cols));
+        }
+    }
+    return cells;
+}
+
+int GridConnectivity::neighbor(int cell, int dir) const
+{
+    int x = cell % cols + kDirX[dir];
+    int y = cell / cols + kDirY[dir];
+    if (x < 0 || x >= cols || y < 0 || y >= rows) {
+        return -1;
+    }
+    return index(x, y);
+}
+
+QList<QPoint> GridConnectivity::minimumCut()
+{
+    QList<QPoint> cut;
+    if (source < 0) {
+        return cut;
+    }
+
+    // 起点与终点相邻时任何格子都无法将它们分开
+    for (int dir = 0; dir < 4; ++dir) {
+        if (neighbor(source, dir) == sink) {
+            return cut;
+        }
+    }
+
+    // 格子之间的边按无穷容量处理，最大流不变，但割只会落在格子的内部边上
+    if (residualSearch(source * 2 + 1, sink * 2, true)) {
+        return cut; // 流量未达到最大（limit设置过小），无法给出最小割
+    }
+
+    // 入点可达而出点不可达的格子构成最小割
+    for (int cell = 0; cell < rows * cols; ++cell) {
+        if (!isTerminal(cell) &&
+            visitStamp[cell * 2] == currentStamp &&
+            visitStamp[cell * 2 + 1] != currentStamp) {
+            cut.append(QPoint(cell % cols, cell / cols));
+        }
+    }
+    return cut;
+}
+
+bool GridConnectivity::residualSearch(int fromNode, int toNode, bool uncappedEdges)
+{
+    ++currentStamp;
+    QVector<int> queue;
+    queue.reserve(64);
+    queue.append(fromNode);
+    visitStamp[fromNode] = currentStamp;
+    parentNode[fromNode] = -1;
+
+    bool found = false;
+    for (int head = 0; head < queue.size() && !found; ++head) {
+        int node = queue[head];
+        int cell = node >> 1;
+        bool outSide = node & 1;
+
+        auto visit = [&](int next) {
+            if (visitStamp[next] == currentStamp) {
+                return;
+            }
+            visitStamp[next] = currentStamp;
+            parentNode[next] = node;
+            if (next == toNode) {
+                found = true;
+            }
+            queue.append(next);
+        };
+
+        if (outSide) {
+            // 反向内部边：撤销该格子的占用
+            if (!isTerminal(cell) && innerFlow[cell]) {
+                visit(cell * 2);
+            }
+            // 正向外部边：出点 -> 相邻格子的入点（不允许流回起点）
+            for (int dir = 0; dir < 4 && !found; ++dir) {
+                int next = neighbor(cell, dir);
+                if (next < 0 || next == source || blockedCells[next] ||
+                    (edgeFlow[cell * 4 + dir] && !uncappedEdges)) {
+                    continue;
+                }
+                visit(next * 2);
+            }
+        } else {
+            // 正向内部边：入点 -> 出点
+            if (!isTerminal(cell) && !blockedCells[cell] && !innerFlow[cell]) {
+                visit(cell * 2 + 1);
+            }
+            // 反向外部边：撤销相邻格子流入本格的流量
+            for (int dir = 0; dir < 4 && !found; ++dir) {
+                int prev = neighbor(cell, dir);
+                if (prev < 0 || !edgeFlow[prev * 4 + (dir + 2) % 4]) {
+                    continue;
+                }
+                visit(prev * 2 + 1);
+            }
+        }
+    }
+
+    return found;
+}
+
+bool GridConnectivity::augment()
+{
+    if (source < 0) {
+        return false;
+    }
+
+    // 节点编号：cell*2 为入点，cell*2+1 为出点
+    // 源点取起点的出点，汇点取终点的入点
+    const int sinkNode = sink * 2;
+    if (!residualSearch(source * 2 + 1, sinkNode)) {
+        return false;
+    }
+
+    applyPath(sinkNode);
+    ++flowValue;
+    return true;
+}
+
+bool GridConnectivity::rerouteAround(int cell)
+{
+    // 找到流入和流出该格子的相邻格子
+    int prev = -1;
+    int next = -1;
+    int inDir = -1;
+    int outDir = -1;
+    for (int dir = 0; dir < 4; ++dir) {
+        int other = neighbor(cell, dir);
+        if (other < 0) {
+            continue;
+        }
+        if (edgeFlow[cell * 4 + dir]) {
+            next = other;
+            outDir = dir;
+        }
+        if (edgeFlow[other * 4 + (dir + 2) % 4]) {
+            prev = other;
+            inDir = (dir + 2) % 4;
+        }
+    }
+    if (prev < 0 || next < 0) {
+        return false;
+    }
+
+    // 暂时断开 prev -> cell -> next，然后在残量网络中寻找 prev出点 -> next入点 的绕行路径
+    edgeFlow[prev * 4 + inDir] = 0;
+    edgeFlow[cell * 4 + outDir] = 0;
+    innerFlow[cell] = 0;
+
+    const int toNode = next * 2;
+    if (residualSearch(prev * 2 + 1, toNode)) {
+        applyPath(toNode);
+        return true;
+    }
+
+    // 找不到绕行路径，恢复原状交给全局修复
+    edgeFlow[prev * 4 + inDir] = 1;
+    edgeFlow[cell * 4 + outDir] = 1;
+    innerFlow[cell] = 1;
+    return false;
+}
+
+void GridConnectivity::applyPath(int toNode)
+{
+    // 沿父指针回溯并更新流量
+    for (int node = toNode; parentNode[node] >= 0; node = parentNode[node]) {
+        int prev = parentNode[node];
+        int prevCell = prev >> 1;
+        int cell = node >> 1;
+
+        if (prevCell == cell) {
+            // 内部边：入->出为占用，出->入为释放
+            innerFlow[cell] = (node & 1) ? 1 : 0;
+            continue;
+        }
+
+        int dir = 0;
+        while (neighbor(prevCell, dir) != cell) {
+            ++dir;
+        }
+        if (prev & 1) {
+            edgeFlow[prevCell * 4 + dir] = 1;                // 正向外部边
+        } else {
+            edgeFlow[cell * 4 + (dir + 2) % 4] = 0;          // 撤销 cell -> prevCell 的流量
+        }
+    }
+}
+
+void GridConnectivity::cancelFlowThrough(int cell)
+{
+    // 顺着流量方向走到终点（或绕回自身，即一个环流）
+    bool isCycle = false;
+    int current = cell;
+    while (true) {
+        int dir = 0;
+        while (dir < 4 && !edgeFlow[current * 4 + dir]) {
+            ++dir;
+        }
+        if (dir == 4) {
+            break;
+        }
+        edgeFlow[current * 4 + dir] = 0;
+        int next = neighbor(current, dir);
+        if (next == sink) {
+            break;
+        }
+        if (next == cell) {
+            isCycle = true;
+            break;
+        }
+        innerFlow[next] = 0;
+        current = next;
+    }
+
+    // 逆着流量方向走回起点
+    current = cell;
+    while (!isCycle) {
+        int dir = 0;
+        int prev = -1;
+        for (; dir < 4; ++dir) {
+            prev = neighbor(current, dir);
+            if (prev >= 0 && edgeFlow[prev * 4 + (dir + 2) % 4]) {
+                break;
+            }
+        }
+        if (dir == 4) {
+            break;
+        }
+        edgeFlow[prev * 4 + (dir + 2) % 4] = 0;
+        if (prev == source) {
+            break;
+        }
+        innerFlow[prev] = 0;
+        current = prev;
+    }
+
+    innerFlow[cell] = 0;
+}
+
+void GridConnectivity::recountFlow()
+{
+    flowValue = 0;
+    for (int dir = 0; dir < 4; ++dir) {
+        flowValue += edgeFlow[source * 4 + dir];
+    }
+}
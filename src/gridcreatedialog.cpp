@@ -1,4 +1,5 @@
 #include "../include/gridcreatedialog.h"
+#include "../include/mapfile.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -15,11 +16,11 @@ GridCreateDialog::GridCreateDialog(QWidget *parent)
     colsLabel = new QLabel(tr("列数:"), this);
     
     rowsSpinBox = new QSpinBox(this);
-    rowsSpinBox->setRange(1, 100);
+    rowsSpinBox->setRange(1, MapFile::MaxSide);
     rowsSpinBox->setValue(10);
     
     colsSpinBox = new QSpinBox(this);
-    colsSpinBox->setRange(1, 100);
+    colsSpinBox->setRange(1, MapFile::MaxSide);
     colsSpinBox->setValue(10);
 
     okButton = new QPushButton(tr("OK"), this);
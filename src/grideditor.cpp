@@ -1,20 +1,29 @@
 #include "../include/grideditor.h"
+#include "../include/obstaclegenerator.h"
+#include "../include/mapfile.h"
+#include "../include/traceprofiler.h"
+#include "../include/searchdebugger.h"
 #include <QPainter>
+#include <QPolygonF>
 #include <QMouseEvent>
 #include <QResizeEvent>
+#include <QPaintEvent>
+#include <QFontMetrics>
 #include <QDebug>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
-#include <QFile>
 #include <QRandomGenerator>
-#include <QSet>
-#include <QQueue>
+
+// 单步调试一次暂停中状态变化的格子超过这个数量时整体重绘，不再逐格合并重绘区域
+static const int kDebugRepaintCellLimit = 256;
+// 撤销或重做改动的行段超过这个数量时整体重绘
+static const int kUndoRepaintRunLimit = 256;
 
 GridEditor::GridEditor(QWidget *parent)
     : QWidget(parent), rows(0), cols(0), cellSize(20), currentState(Obstacle),
       startPos(-1, -1), endPos(-1, -1), currentStep(0), currentCarPos(-1, -1),
-      isExecuting(false), codeExecutionMode(false)
+      isExecuting(false), codeExecutionMode(false), editOldState(Empty), editNewState(Empty),
+      editPending(false), heatmapMode(ExpansionOrder),
+      searchDebugCurrent(-1, -1),
+      hudVisible(false), hudTickCount(0)
 {
     setMinimumSize(200, 200);
     setBackgroundRole(QPalette::Base);
@@ -25,6 +34,19 @@ GridEditor::GridEditor(QWidget *parent)
     executionTimer = new QTimer(this);
     connect(executionTimer, &QTimer::timeout, this, &GridEditor::moveToNextPosition);
     executionTimer->setInterval(500); // 500ms间隔
+    
+    // 性能浮层的事件循环探针：按定时器实际触发的延迟统计卡顿
+    hudTimer = new QTimer(this);
+    hudTimer->setTimerType(Qt::PreciseTimer);
+    hudTimer->setInterval(16);
+    connect(hudTimer, &QTimer::timeout, this, &GridEditor::onHudTick);
+
+    // 撤销记录的内存预算（MB）
+    bool budgetSet = false;
+    const qint64 budgetMegabytes = qEnvironmentVariable("GRIDMAP_UNDO_BUDGET_MB").toLongLong(&budgetSet);
+    if (budgetSet) {
+        journal.setBudget(budgetMegabytes * 1024 * 1024);
+    }
 }
 
 void GridEditor::loadImages()
@@ -47,34 +69,44 @@ void GridEditor::createGrid(int newRows, int newCols)
 {
     rows = newRows;
     cols = newCols;
-    grid.resize(rows);
-    for (int i = 0; i < rows; ++i) {
-        grid[i].resize(cols);
-        for (int j = 0; j < cols; ++j) {
-            grid[i][j] = Empty;
-        }
-    }
+    grid = GridMap(rows, cols, Empty);
     startPos = QPoint(-1, -1);
     endPos = QPoint(-1, -1);
+    overlayPaths.clear();
+    overlayColors.clear();
+    heatmapTrace = PathSearch::ExpansionTrace();
+    heatmapImage = QImage();
+    searchDebugImage = QImage();
+    searchDebugCurrent = QPoint(-1, -1);
+    breakpointCells.clear();
+    journal.clear();
     updateCellSize();
     updateGridOffset();
     update();
+    emit undoStateChanged();
 }
 
 void GridEditor::clearGrid()
 {
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            grid[i][j] = Empty;
-        }
-    }
+    // 清空前的版本与清空后的地图共享没有内容的块，撤销记录只比较其余的块
+    const GridMap before = grid;
+    grid.fill(Empty);
+    journal.recordDiff(before, grid);
     startPos = QPoint(-1, -1);
     endPos = QPoint(-1, -1);
+    overlayPaths.clear();
+    overlayColors.clear();
+    heatmapTrace = PathSearch::ExpansionTrace();
+    heatmapImage = QImage();
+    searchDebugImage = QImage();
+    searchDebugCurrent = QPoint(-1, -1);
     update();
+    emit undoStateChanged();
 }
 
 void GridEditor::setCellState(const QPoint& pos, CellState state)
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::setCellState");
     if (!isValidGridPos(pos)) return;
 
     // 在代码执行模式下，限制修改操作
@@ -85,19 +117,24 @@ void GridEditor::setCellState(const QPoint& pos, CellState state)
         }
         
         // 不允许修改现有的起点和终点
-        if (grid[pos.y()][pos.x()] == Start || grid[pos.y()][pos.x()] == End) {
+        if (grid.cell(pos) == Start || grid.cell(pos) == End) {
+            return;
+        }
+        
+        // 重新规划从小车所在的格子出发，不能在小车上放障碍
+        if (isExecuting && pos == currentCarPos) {
             return;
         }
     }
 
     bool hasChanged = false;
-    CellState oldState = grid[pos.y()][pos.x()];
+    CellState oldState = static_cast<CellState>(grid.cell(pos));
 
     // 如果要设置的位置已经有起点或终点，先清除它
-    if (grid[pos.y()][pos.x()] == Start) {
+    if (grid.cell(pos) == Start) {
         startPos = QPoint(-1, -1);
     }
-    else if (grid[pos.y()][pos.x()] == End) {
+    else if (grid.cell(pos) == End) {
         endPos = QPoint(-1, -1);
     }
 
@@ -105,22 +142,26 @@ void GridEditor::setCellState(const QPoint& pos, CellState state)
     if (state == Start) {
         // 如果已经有起点，先清除原来的起点
         if (startPos != QPoint(-1, -1)) {
-            grid[startPos.y()][startPos.x()] = Empty;
+            journal.record(startPos.x(), startPos.y(), grid.cell(startPos), Empty);
+            grid.setCell(startPos, Empty);
         }
         startPos = pos;
         // 清除该位置的其他状态（如VisitedPath等）
-        grid[pos.y()][pos.x()] = Start;
+        journal.record(pos.x(), pos.y(), oldState, Start);
+        grid.setCell(pos, Start);
         hasChanged = true;
     }
     // 如果是设置终点
     else if (state == End) {
         // 如果已经有终点，先清除原来的终点
         if (endPos != QPoint(-1, -1)) {
-            grid[endPos.y()][endPos.x()] = Empty;
+            journal.record(endPos.x(), endPos.y(), grid.cell(endPos), Empty);
+            grid.setCell(endPos, Empty);
         }
         endPos = pos;
         // 清除该位置的其他状态
-        grid[pos.y()][pos.x()] = End;
+        journal.record(pos.x(), pos.y(), oldState, End);
+        grid.setCell(pos, End);
         hasChanged = true;
     }
     // 如果是设置为空或障碍
@@ -132,23 +173,136 @@ void GridEditor::setCellState(const QPoint& pos, CellState state)
         if (pos == endPos) {
             endPos = QPoint(-1, -1);
         }
-        // 设置新的状态
-        grid[pos.y()][pos.x()] = state;
+        // 设置新的状态；擦除或填满后整块同一个值时收回这一块的格子存储
+        journal.record(pos.x(), pos.y(), oldState, state);
+        grid.setCell(pos, state);
+        grid.compact(pos.x(), pos.y(), 1, 1);
         hasChanged = (oldState != state);
     }
 
     // 如果栅格发生了变化，发出信号
     if (hasChanged) {
+        GRIDMAP_TRACE_SCOPE("GridEditor::gridChanged");
+        editPos = pos;
+        editOldState = oldState;
+        editNewState = state;
+        editPending = true;
         emit gridChanged();
+        editPending = false;
+        // 鼠标拖动中的改动在松开时才成为一步
+        if (!journal.isRecording()) {
+            emit undoStateChanged();
+        }
     }
 
     update();
 }
 
+bool GridEditor::undo()
+{
+    GRIDMAP_TRACE_SCOPE("GridEditor::undo");
+    QVector<EditJournal::Run> runs;
+    if (codeExecutionMode || !journal.undo(&grid, &runs)) {
+        return false;
+    }
+    applyJournalRuns(runs, false);
+    return true;
+}
+
+bool GridEditor::redo()
+{
+    GRIDMAP_TRACE_SCOPE("GridEditor::redo");
+    QVector<EditJournal::Run> runs;
+    if (codeExecutionMode || !journal.redo(&grid, &runs)) {
+        return false;
+    }
+    applyJournalRuns(runs, true);
+    return true;
+}
+
+void GridEditor::setUndoBudget(qint64 bytes)
+{
+    journal.setBudget(bytes);
+    emit undoStateChanged();
+}
+
+void GridEditor::applyJournalRuns(const QVector<EditJournal::Run>& runs, bool forward)
+{
+    // 起点和终点跟随写回的格子：先清除被覆盖的，再设置新写入的，与写回的先后顺序无关
+    for (const EditJournal::Run& run : runs) {
+        const QRect cells = EditJournal::runRect(run);
+        const int replaced = forward ? run.before : run.after;
+        if (replaced == Start && cells.contains(startPos)) {
+            startPos = QPoint(-1, -1);
+        } else if (replaced == End && cells.contains(endPos)) {
+            endPos = QPoint(-1, -1);
+        }
+    }
+    for (const EditJournal::Run& run : runs) {
+        const int written = forward ? run.after : run.before;
+        if (written == Start) {
+            startPos = QPoint(int(run.x), int(run.y));
+        } else if (written == End) {
+            endPos = QPoint(int(run.x), int(run.y));
+        }
+    }
+
+    // 只重绘改动的格子
+    if (runs.size() > kUndoRepaintRunLimit) {
+        update();
+    } else {
+        for (const EditJournal::Run& run : runs) {
+            const QRect first = cellRect(QPoint(int(run.x), int(run.y)));
+            update(QRect(first.topLeft(), QSize(first.width() * run.length, first.height())));
+        }
+    }
+
+    emit gridChanged();
+    emit undoStateChanged();
+}
+
+bool GridEditor::lastEditKeepsShortestPath() const
+{
+    if (!editPending || !isExecuting || currentPath.isEmpty()) {
+        return false;
+    }
+    // 剩余路线从小车所在的格子开始
+    const int first = qMax(currentStep - 1, 0);
+    if (first >= currentPath.size()) {
+        return false;
+    }
+
+    if (editNewState == Obstacle) {
+        for (int i = first; i < currentPath.size(); ++i) {
+            if (currentPath[i] == editPos) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (editOldState == Obstacle) {
+        // 经过 editPos 的路线至少有两段曼哈顿距离之和那么长
+        const QPoint& from = currentPath[first];
+        const int through = (editPos - from).manhattanLength() + (endPos - editPos).manhattanLength();
+        return through >= currentPath.size() - 1 - first;
+    }
+    return false;
+}
+
+void GridEditor::keepCurrentPath()
+{
+    frameStats.keepPath();
+}
+
+void GridEditor::markReplanRequested()
+{
+    frameStats.markEdit();
+}
+
 GridEditor::CellState GridEditor::getCellState(const QPoint& pos) const
 {
     if (!isValidGridPos(pos)) return Empty;
-    return grid[pos.y()][pos.x()];
+    return static_cast<CellState>(grid.cell(pos));
 }
 
 void GridEditor::updateCellSize()
@@ -180,8 +334,9 @@ void GridEditor::updateGridOffset()
     gridOffset.setY((height() - gridHeight) / 2);
 }
 
-void GridEditor::paintEvent(QPaintEvent * /* event */)
+void GridEditor::paintEvent(QPaintEvent *event)
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::paintEvent");
     if (rows <= 0 || cols <= 0) {
         // 如果还没有创建栅格，显示提示信息
         QPainter painter(this);
@@ -190,106 +345,495 @@ void GridEditor::paintEvent(QPaintEvent * /* event */)
         return;
     }
 
+    const qint64 paintStartNs = frameStats.now();
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
-    // 绘制栅格
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QRect cell(gridOffset.x() + j * cellSize,
-                      gridOffset.y() + i * cellSize,
-                      cellSize, cellSize);
-            
-            // 先填充背景
-            painter.fillRect(cell, Qt::white);
-            
-            // 检查当前位置是否是起点或终点
-            QPoint currentPos(j, i);
-            bool isStartPosition = (currentPos == startPos);
-            bool isEndPosition = (currentPos == endPos);
-            
-            // 根据状态绘制单元格背景
-            if (isStartPosition) {
-                // 起点：如果小车不在起点，显示淡绿色背景
-                if (!isExecuting || currentCarPos != startPos) {
-                    painter.fillRect(cell, QColor(0, 255, 0, 50)); // 淡绿色起点背景
+    // 只绘制与重绘区域相交的格子（局部刷新时不必遍历整张地图）
+    // 单步调试时重绘区域由分散的几个格子组成，逐个矩形绘制而不是绘制它们的外接矩形
+    const QRect dirty = event->rect();
+    int paintedCells = 0;
+    for (const QRect& area : event->region()) {
+        const int firstRow = qBound(0, (area.top() - gridOffset.y()) / cellSize, rows - 1);
+        const int lastRow = qBound(0, (area.bottom() - gridOffset.y()) / cellSize, rows - 1);
+        const int firstCol = qBound(0, (area.left() - gridOffset.x()) / cellSize, cols - 1);
+        const int lastCol = qBound(0, (area.right() - gridOffset.x()) / cellSize, cols - 1);
+        paintedCells += (lastRow - firstRow + 1) * (lastCol - firstCol + 1);
+
+        // 按块绘制：整块同一个值的块一次填充背景、按行列画网格线，不逐个格子查询和绘制
+        for (int chunkY = firstRow >> GridMap::ChunkShift; chunkY <= lastRow >> GridMap::ChunkShift; ++chunkY) {
+            for (int chunkX = firstCol >> GridMap::ChunkShift; chunkX <= lastCol >> GridMap::ChunkShift; ++chunkX) {
+                const int top = qMax(firstRow, chunkY << GridMap::ChunkShift);
+                const int bottom = qMin(lastRow, ((chunkY + 1) << GridMap::ChunkShift) - 1);
+                const int left = qMax(firstCol, chunkX << GridMap::ChunkShift);
+                const int right = qMin(lastCol, ((chunkX + 1) << GridMap::ChunkShift) - 1);
+                if (grid.isUniformChunk(chunkX, chunkY)) {
+                    paintUniformCells(painter, QRect(QPoint(left, top), QPoint(right, bottom)),
+                                      grid.chunkValue(chunkX, chunkY));
+                    continue;
                 }
-            } else if (isEndPosition) {
-                // 终点背景（可选）
-                // painter.fillRect(cell, QColor(255, 0, 0, 50)); // 可以添加终点背景色
-            } else {
-                // 其他位置根据grid状态绘制
-                switch (grid[i][j]) {
-                    case Obstacle:
-                        painter.fillRect(cell, Qt::black);
-                        break;
-                    case Path:
-                        painter.fillRect(cell, QColor(0, 0, 255, 100)); // 半透明蓝色路径
-                        break;
-                    case VisitedPath:
-                        painter.fillRect(cell, QColor(0, 255, 0, 150)); // 绿色走过的路径
-                        break;
-                    case Current:
-                        painter.drawPixmap(cell, carImage);
-                        break;
-                    default:
-                        break;
+                for (int i = top; i <= bottom; ++i) {
+                    for (int j = left; j <= right; ++j) {
+                        paintCell(painter, j, i, grid.cell(j, i));
+                    }
                 }
             }
-            
-            // 绘制图标层（在背景之上）
-            if (isStartPosition) {
-                // 起点始终显示小车图标
-                painter.drawPixmap(cell, carImage);
-            } else if (isEndPosition) {
-                // 终点始终显示旗帜
-                painter.drawPixmap(cell, flagImage);
-            }
-            
-            // 如果小车在执行中且在非起点终点的位置，绘制移动的小车
-            if (isExecuting && currentPos == currentCarPos && !isStartPosition && !isEndPosition) {
+        }
+    }
+    
+    // 热力图每格一个像素，按单元格大小放大绘制（不做平滑，保持格子边界清晰）
+    if (!heatmapImage.isNull()) {
+        painter.drawImage(QRect(gridOffset, QSize(cols * cellSize, rows * cellSize)), heatmapImage);
+    }
+    
+    drawSearchDebug(painter);
+    drawOverlayPaths(painter);
+    
+    // 只刷新性能浮层时不计入重绘统计
+    if (!(hudVisible && hudRect.contains(dirty))) {
+        frameStats.addPaint(frameStats.now() - paintStartNs, paintedCells);
+    }
+    if (hudVisible) {
+        drawPerformanceHud(painter);
+    }
+}
+
+void GridEditor::paintCell(QPainter& painter, int j, int i, int state)
+{
+    QRect cell(gridOffset.x() + j * cellSize,
+              gridOffset.y() + i * cellSize,
+              cellSize, cellSize);
+
+    // 先填充背景
+    painter.fillRect(cell, Qt::white);
+
+    // 检查当前位置是否是起点或终点
+    QPoint currentPos(j, i);
+    bool isStartPosition = (currentPos == startPos);
+    bool isEndPosition = (currentPos == endPos);
+
+    // 根据状态绘制单元格背景
+    if (isStartPosition) {
+        // 起点：如果小车不在起点，显示淡绿色背景
+        if (!isExecuting || currentCarPos != startPos) {
+            painter.fillRect(cell, QColor(0, 255, 0, 50)); // 淡绿色起点背景
+        }
+    } else if (isEndPosition) {
+        // 终点背景（可选）
+        // painter.fillRect(cell, QColor(255, 0, 0, 50)); // 可以添加终点背景色
+    } else {
+        // 其他位置根据grid状态绘制
+        switch (state) {
+            case Obstacle:
+                painter.fillRect(cell, Qt::black);
+                break;
+            case Path:
+                painter.fillRect(cell, QColor(0, 0, 255, 100)); // 半透明蓝色路径
+                break;
+            case VisitedPath:
+                painter.fillRect(cell, QColor(0, 255, 0, 150)); // 绿色走过的路径
+                break;
+            case Current:
                 painter.drawPixmap(cell, carImage);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // 绘制图标层（在背景之上）
+    if (isStartPosition) {
+        // 起点始终显示小车图标
+        painter.drawPixmap(cell, carImage);
+    } else if (isEndPosition) {
+        // 终点始终显示旗帜
+        painter.drawPixmap(cell, flagImage);
+    }
+
+    // 如果小车在执行中且在非起点终点的位置，绘制移动的小车
+    if (isExecuting && currentPos == currentCarPos && !isStartPosition && !isEndPosition) {
+        painter.drawPixmap(cell, carImage);
+    }
+
+    // 绘制网格线
+    painter.setPen(Qt::gray);
+    painter.drawRect(cell);
+}
+
+void GridEditor::paintUniformCells(QPainter& painter, const QRect& cells, int state)
+{
+    const QRect area(gridOffset.x() + cells.left() * cellSize, gridOffset.y() + cells.top() * cellSize,
+                     cells.width() * cellSize, cells.height() * cellSize);
+    painter.fillRect(area, Qt::white);
+    switch (state) {
+        case Obstacle:
+            painter.fillRect(area, Qt::black);
+            break;
+        case Path:
+            painter.fillRect(area, QColor(0, 0, 255, 100));
+            break;
+        case VisitedPath:
+            painter.fillRect(area, QColor(0, 255, 0, 150));
+            break;
+        default:
+            break;
+    }
+
+    // 与逐格绘制的边框重合的网格线
+    painter.setPen(Qt::gray);
+    for (int i = 0; i <= cells.height(); ++i) {
+        const int y = area.top() + i * cellSize;
+        painter.drawLine(area.left(), y, area.left() + area.width(), y);
+    }
+    for (int j = 0; j <= cells.width(); ++j) {
+        const int x = area.left() + j * cellSize;
+        painter.drawLine(x, area.top(), x, area.top() + area.height());
+    }
+
+    // 起点、终点和小车按自己的方式绘制（通常不会落在整块同一个值的块中）
+    for (const QPoint& pos : { startPos, endPos, currentCarPos }) {
+        if (cells.contains(pos)) {
+            paintCell(painter, pos.x(), pos.y(), state);
+        }
+    }
+}
+
+void GridEditor::setPerformanceHudVisible(bool visible)
+{
+    if (hudVisible == visible) {
+        return;
+    }
+    hudVisible = visible;
+    if (visible) {
+        frameStats.reset();
+        hudTickCount = 0;
+        hudTimer->start();
+    } else {
+        hudTimer->stop();
+    }
+    update();
+}
+
+void GridEditor::onHudTick()
+{
+    frameStats.addTick(qint64(hudTimer->interval()) * 1000000LL);
+    
+    // 约每半秒刷新一次浮层，只重绘浮层所在的区域
+    if (++hudTickCount % 30 == 0) {
+        update(hudRect);
+    }
+}
+
+void GridEditor::drawPerformanceHud(QPainter& painter)
+{
+    QStringList lines = frameStats.summary();
+    lines << tr("地图内存: %1 KB（%2/%3 块分配了格子）")
+                 .arg(grid.memoryBytes() / 1024)
+                 .arg(grid.allocatedChunks())
+                 .arg(grid.chunkCols() * grid.chunkRows());
+    lines << tr("撤销记录: %1 / %2 KB（%3 步）")
+                 .arg(journal.memoryBytes() / 1024)
+                 .arg(journal.budget() / 1024)
+                 .arg(journal.undoCount());
+    
+    painter.save();
+    QFont font(QStringLiteral("Consolas"));
+    font.setStyleHint(QFont::Monospace);
+    font.setPointSize(9);
+    painter.setFont(font);
+    
+    const QFontMetrics metrics(font);
+    int textWidth = 0;
+    for (const QString& line : lines) {
+        textWidth = qMax(textWidth, metrics.horizontalAdvance(line));
+    }
+    const int padding = 6;
+    QRect panel(8, 8, textWidth + 2 * padding, lines.size() * metrics.height() + 2 * padding);
+    
+    // 浮层只会变大，避免内容变短后旧的文字残留在刷新区域之外
+    hudRect = hudRect.united(panel);
+    painter.fillRect(panel, QColor(0, 0, 0, 170));
+    painter.setPen(Qt::white);
+    for (int i = 0; i < lines.size(); ++i) {
+        painter.drawText(panel.left() + padding, panel.top() + padding + i * metrics.height() + metrics.ascent(),
+                         lines[i]);
+    }
+    painter.restore();
+}
+
+void GridEditor::drawOverlayPaths(QPainter& painter)
+{
+    if (overlayPaths.isEmpty()) {
+        return;
+    }
+    
+    // 每条路径沿对角方向错开一点，重合的路段也能分辨
+    const int count = overlayPaths.size();
+    const double spacing = cellSize * 0.5 / qMax(1, count);
+    const double penWidth = qMax(2.0, cellSize / 8.0);
+    
+    for (int k = 0; k < count; ++k) {
+        const QList<QPoint>& path = overlayPaths[k];
+        if (path.size() < 2) {
+            continue;
+        }
+        
+        double offset = (k - (count - 1) / 2.0) * spacing;
+        QPolygonF polyline;
+        polyline.reserve(path.size());
+        for (const QPoint& pos : path) {
+            polyline.append(QPointF(gridOffset.x() + (pos.x() + 0.5) * cellSize + offset,
+                                    gridOffset.y() + (pos.y() + 0.5) * cellSize + offset));
+        }
+        
+        QColor color = k < overlayColors.size() ? overlayColors[k] : QColor(Qt::blue);
+        painter.setPen(QPen(color, penWidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        painter.drawPolyline(polyline);
+    }
+}
+
+void GridEditor::setOverlayPaths(const QList<QList<QPoint>>& paths, const QList<QColor>& colors)
+{
+    overlayPaths = paths;
+    overlayColors = colors;
+    update();
+}
+
+void GridEditor::clearOverlayPaths()
+{
+    if (overlayPaths.isEmpty()) {
+        return;
+    }
+    overlayPaths.clear();
+    overlayColors.clear();
+    update();
+}
+
+void GridEditor::setExpansionHeatmap(const PathSearch::ExpansionTrace& trace)
+{
+    // 记录与当前栅格尺寸不符（例如运行后又新建了栅格）时不显示
+    if (trace.isEmpty() || trace.rows != rows || trace.cols != cols) {
+        clearExpansionHeatmap();
+        return;
+    }
+    heatmapTrace = trace;
+    rebuildHeatmapImage();
+    update();
+}
+
+void GridEditor::clearExpansionHeatmap()
+{
+    if (heatmapImage.isNull()) {
+        return;
+    }
+    heatmapTrace = PathSearch::ExpansionTrace();
+    heatmapImage = QImage();
+    update();
+}
+
+void GridEditor::setHeatmapMode(HeatmapMode mode)
+{
+    if (heatmapMode == mode) {
+        return;
+    }
+    heatmapMode = mode;
+    if (!heatmapImage.isNull()) {
+        rebuildHeatmapImage();
+        update();
+    }
+}
+
+void GridEditor::rebuildHeatmapImage()
+{
+    GRIDMAP_TRACE_SCOPE("GridEditor::rebuildHeatmapImage");
+    // 色表：蓝（早/少）-> 红（晚/多），半透明以便看清下面的障碍和路径
+    static QVector<QRgb> palette;
+    if (palette.isEmpty()) {
+        palette.resize(256);
+        for (int i = 0; i < 256; ++i) {
+            palette[i] = QColor::fromHsv(240 - i * 240 / 255, 255, 255, 150).rgba();
+        }
+    }
+    
+    const PathSearch::ExpansionTrace& trace = heatmapTrace;
+    const double range = heatmapMode == ExpansionOrder ? trace.expansions - 1 : trace.maxCount - 1;
+    
+    heatmapImage = QImage(trace.cols, trace.rows, QImage::Format_ARGB32);
+    for (int y = 0; y < trace.rows; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(heatmapImage.scanLine(y));
+        const int rowStart = y * trace.cols;
+        for (int x = 0; x < trace.cols; ++x) {
+            const quint32 order = trace.order[rowStart + x];
+            if (order == 0) {
+                line[x] = qRgba(0, 0, 0, 0);
+                continue;
             }
-            
-            // 绘制网格线
-            painter.setPen(Qt::gray);
-            painter.drawRect(cell);
+            const double value = heatmapMode == ExpansionOrder ? order - 1 : trace.counts[rowStart + x] - 1;
+            const int level = range > 0 ? int(value * 255 / range) : 0;
+            line[x] = palette[level];
+        }
+    }
+}
+
+QRect GridEditor::cellRect(const QPoint& pos) const
+{
+    return QRect(gridOffset.x() + pos.x() * cellSize, gridOffset.y() + pos.y() * cellSize, cellSize, cellSize);
+}
+
+void GridEditor::updateSearchDebug(const SearchDebugger& debugger, const QList<QPoint>& changedCells)
+{
+    GRIDMAP_TRACE_SCOPE("GridEditor::updateSearchDebug");
+    if (searchDebugImage.isNull() || searchDebugImage.width() != cols || searchDebugImage.height() != rows) {
+        searchDebugImage = QImage(cols, rows, QImage::Format_ARGB32);
+        searchDebugImage.fill(Qt::transparent);
+    }
+    
+    // 开放列表为黄色，已扩展为浅蓝色，都是半透明的
+    static const QRgb kOpenColor = qRgba(255, 200, 0, 140);
+    static const QRgb kClosedColor = qRgba(70, 150, 255, 110);
+    const bool repaintAll = changedCells.size() > kDebugRepaintCellLimit;
+    for (const QPoint& pos : changedCells) {
+        if (!isValidGridPos(pos)) {
+            continue;
+        }
+        QRgb color = qRgba(0, 0, 0, 0);
+        switch (debugger.cellState(pos)) {
+            case SearchDebugger::Open:
+                color = kOpenColor;
+                break;
+            case SearchDebugger::Closed:
+                color = kClosedColor;
+                break;
+            default:
+                break;
+        }
+        searchDebugImage.setPixel(pos, color);
+        if (!repaintAll) {
+            update(cellRect(pos));
+        }
+    }
+    
+    // 当前扩展的格子用边框标出，旧位置和新位置都要重绘
+    const QPoint current = debugger.lastExpanded();
+    if (current != searchDebugCurrent) {
+        if (isValidGridPos(searchDebugCurrent) && !repaintAll) {
+            update(cellRect(searchDebugCurrent));
         }
+        searchDebugCurrent = current;
+        if (isValidGridPos(searchDebugCurrent) && !repaintAll) {
+            update(cellRect(searchDebugCurrent));
+        }
+    }
+    if (repaintAll) {
+        update();
+    }
+}
+
+void GridEditor::clearSearchDebug()
+{
+    if (searchDebugImage.isNull()) {
+        return;
+    }
+    searchDebugImage = QImage();
+    searchDebugCurrent = QPoint(-1, -1);
+    update();
+}
+
+void GridEditor::toggleBreakpoint(const QPoint& pos)
+{
+    if (!isValidGridPos(pos)) {
+        return;
+    }
+    if (!breakpointCells.removeOne(pos)) {
+        breakpointCells.append(pos);
+    }
+    update(cellRect(pos));
+}
+
+void GridEditor::clearBreakpoints()
+{
+    if (breakpointCells.isEmpty()) {
+        return;
+    }
+    breakpointCells.clear();
+    update();
+}
+
+void GridEditor::drawSearchDebug(QPainter& painter)
+{
+    if (!searchDebugImage.isNull()) {
+        painter.drawImage(QRect(gridOffset, QSize(cols * cellSize, rows * cellSize)), searchDebugImage);
+        if (isValidGridPos(searchDebugCurrent)) {
+            const int penWidth = qMax(2, cellSize / 8);
+            painter.setPen(QPen(QColor(255, 80, 0), penWidth));
+            painter.setBrush(Qt::NoBrush);
+            painter.drawRect(cellRect(searchDebugCurrent).adjusted(penWidth / 2, penWidth / 2,
+                                                                   -penWidth / 2, -penWidth / 2));
+        }
+    }
+    
+    // 断点画成格子中间的红点
+    if (!breakpointCells.isEmpty()) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(220, 30, 30));
+        const int radius = qMax(3, cellSize / 5);
+        for (const QPoint& pos : breakpointCells) {
+            painter.drawEllipse(cellRect(pos).center(), radius, radius);
+        }
+        painter.setBrush(Qt::NoBrush);
     }
 }
 
 void GridEditor::mousePressEvent(QMouseEvent *event)
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::mousePressEvent");
     QPoint gridPos = pixelToGrid(event->pos());
     if (!isValidGridPos(gridPos)) return;
 
     if (event->button() == Qt::RightButton) {
+        journal.beginEdit();
         handleRightClick(gridPos);
+    } else if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ControlModifier)) {
+        // Ctrl+左键切换扩展断点，不修改格子
+        toggleBreakpoint(gridPos);
     } else if (event->button() == Qt::LeftButton) {
+        // 按下到松开之间的改动是一步撤销
+        journal.beginEdit();
         setCellState(gridPos, currentState);
     }
 }
 
 void GridEditor::mouseMoveEvent(QMouseEvent *event)
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::mouseMoveEvent");
     QPoint gridPos = pixelToGrid(event->pos());
     if (!isValidGridPos(gridPos)) return;
 
     if (event->buttons() & Qt::LeftButton) {
-        // 只有在绘制障碍物时才允许拖动
-        if (currentState == Obstacle) {
+        // 只有在绘制障碍物时才允许拖动（按住 Ctrl 时是在设置断点）
+        if (currentState == Obstacle && !(event->modifiers() & Qt::ControlModifier)) {
+            journal.beginEdit();
             setCellState(gridPos, currentState);
         }
     } else if (event->buttons() & Qt::RightButton) {
         // 允许拖动右键来清除
+        journal.beginEdit();
         handleRightClick(gridPos);
     }
 }
 
+void GridEditor::mouseReleaseEvent(QMouseEvent * /* event */)
+{
+    if (journal.isRecording()) {
+        journal.endEdit();
+        emit undoStateChanged();
+    }
+}
+
 void GridEditor::handleRightClick(const QPoint& pos)
 {
     // 只有当点击的是障碍物时才清除
-    if (grid[pos.y()][pos.x()] == Obstacle) {
+    if (grid.cell(pos) == Obstacle) {
         setCellState(pos, Empty);
     }
 }
@@ -314,140 +858,32 @@ bool GridEditor::isValidGridPos(const QPoint& pos) const
 
 bool GridEditor::saveToJson(const QString& filename) const
 {
-    QJsonObject json;
-    
-    // 保存网格基本信息
-    json["rows"] = rows;
-    json["cols"] = cols;
-    
-    // 保存网格数据
-    QJsonArray gridData;
-    for (int i = 0; i < rows; ++i) {
-        QJsonArray rowData;
-        for (int j = 0; j < cols; ++j) {
-            rowData.append(static_cast<int>(grid[i][j]));
-        }
-        gridData.append(rowData);
-    }
-    json["grid"] = gridData;
-    
-    // 保存起点和终点位置
-    if (startPos != QPoint(-1, -1)) {
-        QJsonObject startPosObj;
-        startPosObj["x"] = startPos.x();
-        startPosObj["y"] = startPos.y();
-        json["startPos"] = startPosObj;
-    }
-    
-    if (endPos != QPoint(-1, -1)) {
-        QJsonObject endPosObj;
-        endPosObj["x"] = endPos.x();
-        endPosObj["y"] = endPos.y();
-        json["endPos"] = endPosObj;
-    }
+    // 按块保存，大地图不展开成逐格的数组
+    MapFile::GridData map;
+    map.grid = grid;
+    map.startPos = startPos;
+    map.endPos = endPos;
     
-    // 写入文件
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly)) {
-        return false;
-    }
-    
-    QJsonDocument doc(json);
-    file.write(doc.toJson());
-    return true;
+    return MapFile::save(filename, map);
 }
 
 bool GridEditor::loadFromJson(const QString& filename)
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+    MapFile::GridData map;
+    if (!MapFile::load(filename, &map, &lastErrorMessage)) {
+        // 设置错误信息供MainWindow显示
         return false;
     }
     
-    QByteArray data = file.readAll();
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    
-    if (doc.isNull() || parseError.error != QJsonParseError::NoError) {
-        // JSON解析失败，设置错误信息供MainWindow显示
-        lastErrorMessage = tr("无法解析JSON文件: %1").arg(parseError.errorString());
-        return false;
-    }
-    
-    QJsonObject json = doc.object();
-    
-    // 验证必要的字段是否存在
-    if (!json.contains("rows") || !json.contains("cols") || !json.contains("grid")) {
-        lastErrorMessage = tr("JSON文件缺少必要的字段（rows、cols、grid）");
-        return false;
-    }
-    
-    // 读取网格基本信息
-    int newRows = json["rows"].toInt();
-    int newCols = json["cols"].toInt();
-    
-    if (newRows <= 0 || newCols <= 0) {
-        lastErrorMessage = tr("网格尺寸无效（行数: %1, 列数: %2）").arg(newRows).arg(newCols);
-        return false;
-    }
-    
-    // 验证网格数据
-    QJsonArray gridData = json["grid"].toArray();
-    if (gridData.size() != newRows) {
-        lastErrorMessage = tr("网格数据行数与声明不符");
-        return false;
-    }
-    
-    // 创建新网格
-    createGrid(newRows, newCols);
+    // 创建新网格（同时清除撤销记录）
+    createGrid(map.grid.rows(), map.grid.cols());
     
     // 读取网格数据
-    for (int i = 0; i < rows; ++i) {
-        if (i >= gridData.size()) {
-            lastErrorMessage = tr("网格数据不完整");
-            return false;
-        }
-        
-        QJsonArray rowData = gridData[i].toArray();
-        if (rowData.size() != newCols) {
-            lastErrorMessage = tr("第%1行数据列数与声明不符").arg(i + 1);
-            return false;
-        }
-        
-        for (int j = 0; j < cols; ++j) {
-            int cellValue = rowData[j].toInt();
-            if (cellValue < 0 || cellValue > static_cast<int>(VisitedPath)) {
-                lastErrorMessage = tr("网格数据包含无效值: %1").arg(cellValue);
-                return false;
-            }
-            grid[i][j] = static_cast<CellState>(cellValue);
-        }
-    }
+    grid = map.grid;
     
     // 读取起点和终点位置
-    startPos = QPoint(-1, -1);
-    if (json.contains("startPos")) {
-        QJsonObject startPosObj = json["startPos"].toObject();
-        if (startPosObj.contains("x") && startPosObj.contains("y")) {
-            int x = startPosObj["x"].toInt();
-            int y = startPosObj["y"].toInt();
-            if (x >= 0 && x < newCols && y >= 0 && y < newRows) {
-                startPos = QPoint(x, y);
-            }
-        }
-    }
-    
-    endPos = QPoint(-1, -1);
-    if (json.contains("endPos")) {
-        QJsonObject endPosObj = json["endPos"].toObject();
-        if (endPosObj.contains("x") && endPosObj.contains("y")) {
-            int x = endPosObj["x"].toInt();
-            int y = endPosObj["y"].toInt();
-            if (x >= 0 && x < newCols && y >= 0 && y < newRows) {
-                endPos = QPoint(x, y);
-            }
-        }
-    }
+    startPos = map.startPos;
+    endPos = map.endPos;
     
     lastErrorMessage.clear(); // 清除错误信息
     update();  // 重绘界面
@@ -457,51 +893,52 @@ bool GridEditor::loadFromJson(const QString& filename)
 // 路径执行功能实现
 void GridEditor::executePathfinding(const QList<QPoint>& path)
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::executePathfinding");
     if (path.isEmpty()) {
         emit executionError(tr("路径为空！"));
         return;
     }
     
-    if (isExecuting) {
-        stopExecution();
-    }
-    
-    // 验证路径的有效性
-    for (int i = 0; i < path.size(); ++i) {
-        const QPoint& pos = path[i];
-        if (!isValidGridPos(pos)) {
-            emit executionError(tr("路径包含无效坐标: (%1, %2)").arg(pos.x()).arg(pos.y()));
-            return;
+    // 从小车走过的格子出发的路径：一般就是小车当前位置，
+    // 用户代码异步运行时小车可能又走了几步，先沿原路退回到路径起点
+    if (isCarEnRoute()) {
+        int from = -1;
+        for (int i = currentStep - 1; i >= 0; --i) {
+            if (currentPath[i] == path.first()) {
+                from = i;
+                break;
+            }
         }
-        
-        // 检查路径点是否可通行（除了起点和终点）
-        if (i > 0 && i < path.size() - 1) {
-            CellState state = grid[pos.y()][pos.x()];
-            if (state == Obstacle) {
-                emit executionError(tr("路径经过障碍物: (%1, %2)").arg(pos.x()).arg(pos.y()));
+        if (from >= 0) {
+            if (!validatePath(path)) {
                 return;
             }
-        }
-        
-        // 检查相邻步骤是否连续（只能移动到相邻格子）
-        if (i > 0) {
-            const QPoint& prevPos = path[i-1];
-            int dx = abs(pos.x() - prevPos.x());
-            int dy = abs(pos.y() - prevPos.y());
-            if (dx + dy != 1) {
-                emit executionError(tr("路径不连续: 从(%1, %2)到(%3, %4)")
-                    .arg(prevPos.x()).arg(prevPos.y()).arg(pos.x()).arg(pos.y()));
+            if (path.last() != endPos) {
+                emit executionError(tr("路径终点与地图终点不匹配！"));
                 return;
             }
+            frameStats.addReplan();
+            spliceRemainingPath(path, from);
+            return;
         }
     }
     
+    if (isExecuting) {
+        stopExecution();
+    }
+    
+    if (!validatePath(path)) {
+        return;
+    }
+    
     // 验证起点和终点
     if (startPos == QPoint(-1, -1) || endPos == QPoint(-1, -1)) {
         emit executionError(tr("请先设置起点和终点！"));
         return;
     }
     
+    frameStats.addReplan();
+    
     if (path.first() != startPos) {
         emit executionError(tr("路径起点与地图起点不匹配！"));
         return;
@@ -518,8 +955,8 @@ void GridEditor::executePathfinding(const QList<QPoint>& path)
     // 设置路径显示
     for (int i = 1; i < path.size() - 1; ++i) {
         const QPoint& pos = path[i];
-        if (grid[pos.y()][pos.x()] == Empty) {
-            grid[pos.y()][pos.x()] = Path;
+        if (grid.cell(pos) == Empty) {
+            grid.setCell(pos, Path);
         }
     }
     
@@ -533,32 +970,79 @@ void GridEditor::executePathfinding(const QList<QPoint>& path)
     executionTimer->start();
 }
 
-void GridEditor::clearPath()
+bool GridEditor::validatePath(const QList<QPoint>& path)
 {
-    bool pathWasCleared = false;
-    
-    // 清除路径显示，但保护起点和终点
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QPoint pos(j, i);
-            // 如果是起点或终点，跳过
-            if (pos == startPos || pos == endPos) {
-                continue;
+    for (int i = 0; i < path.size(); ++i) {
+        const QPoint& pos = path[i];
+        if (!isValidGridPos(pos)) {
+            emit executionError(tr("路径包含无效坐标: (%1, %2)").arg(pos.x()).arg(pos.y()));
+            return false;
+        }
+        
+        // 检查路径点是否可通行（除了起点和终点）
+        if (i > 0 && i < path.size() - 1) {
+            CellState state = static_cast<CellState>(grid.cell(pos));
+            if (state == Obstacle) {
+                emit executionError(tr("路径经过障碍物: (%1, %2)").arg(pos.x()).arg(pos.y()));
+                return false;
             }
-            
-            if (grid[i][j] == Path || grid[i][j] == Current || grid[i][j] == VisitedPath) {
-                grid[i][j] = Empty;
-                pathWasCleared = true;
+        }
+        
+        // 检查相邻步骤是否连续（只能移动到相邻格子）
+        if (i > 0) {
+            const QPoint& prevPos = path[i-1];
+            int dx = abs(pos.x() - prevPos.x());
+            int dy = abs(pos.y() - prevPos.y());
+            if (dx + dy != 1) {
+                emit executionError(tr("路径不连续: 从(%1, %2)到(%3, %4)")
+                    .arg(prevPos.x()).arg(prevPos.y()).arg(pos.x()).arg(pos.y()));
+                return false;
             }
         }
     }
+    return true;
+}
+
+void GridEditor::spliceRemainingPath(const QList<QPoint>& path, int from)
+{
+    // 只清除旧路线上还没走到的部分，走过的绿色路线保留；不扫描整张地图
+    for (int i = currentStep; i < currentPath.size(); ++i) {
+        const QPoint& pos = currentPath[i];
+        if (grid.cell(pos) == Path) {
+            grid.setCell(pos, Empty);
+        }
+    }
+    
+    // 新路线：已经走过的部分 + 退回 path 起点的部分（通常为空）+ path 的其余部分
+    QList<QPoint> route = currentPath.mid(0, currentStep);
+    for (int i = currentStep - 2; i >= from; --i) {
+        route.append(currentPath[i]);
+    }
+    route.append(path.mid(1));
+    
+    for (int i = currentStep; i < route.size() - 1; ++i) {
+        const QPoint& pos = route[i];
+        if (grid.cell(pos) == Empty || grid.cell(pos) == VisitedPath) {
+            grid.setCell(pos, Path);
+        }
+    }
+    
+    // currentStep 不变，定时器继续走下一步
+    currentPath = route;
+    update();
+}
+
+void GridEditor::clearPath()
+{
+    // 清除路径显示，起点和终点之后恢复；按块替换，整块同一个值的块不逐个格子检查
+    const bool pathWasCleared = clearPathCells();
     
     // 确保起点和终点状态正确
     if (startPos != QPoint(-1, -1)) {
-        grid[startPos.y()][startPos.x()] = Start;
+        grid.setCell(startPos, Start);
     }
     if (endPos != QPoint(-1, -1)) {
-        grid[endPos.y()][endPos.x()] = End;
+        grid.setCell(endPos, End);
     }
     
     // 如果清除了路径，发出信号
@@ -569,29 +1053,24 @@ void GridEditor::clearPath()
     update();
 }
 
+bool GridEditor::clearPathCells()
+{
+    const qint64 cleared = grid.replace(Path, Empty) + grid.replace(Current, Empty)
+                           + grid.replace(VisitedPath, Empty);
+    return cleared > 0;
+}
+
 void GridEditor::clearPathSilently()
 {
     // 清除路径显示，但保护起点和终点，不发出信号
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QPoint pos(j, i);
-            // 如果是起点或终点，跳过
-            if (pos == startPos || pos == endPos) {
-                continue;
-            }
-            
-            if (grid[i][j] == Path || grid[i][j] == Current || grid[i][j] == VisitedPath) {
-                grid[i][j] = Empty;
-            }
-        }
-    }
+    clearPathCells();
     
     // 确保起点和终点状态正确
     if (startPos != QPoint(-1, -1)) {
-        grid[startPos.y()][startPos.x()] = Start;
+        grid.setCell(startPos, Start);
     }
     if (endPos != QPoint(-1, -1)) {
-        grid[endPos.y()][endPos.x()] = End;
+        grid.setCell(endPos, End);
     }
     
     update();
@@ -626,6 +1105,7 @@ void GridEditor::stopExecutionSilently()
 
 void GridEditor::moveToNextPosition()
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::moveToNextPosition");
     if (!isExecuting || currentStep >= currentPath.size()) {
         stopExecutionSilently(); // 正常完成时静默停止
         emit executionFinished();
@@ -637,14 +1117,14 @@ void GridEditor::moveToNextPosition()
         QPoint prevPos = currentPath[currentStep - 1];
         // 只有非起点和终点的位置才标记为绿色
         if (prevPos != startPos && prevPos != endPos) {
-            grid[prevPos.y()][prevPos.x()] = VisitedPath;
+            grid.setCell(prevPos, VisitedPath);
         }
         // 确保起点和终点的grid状态正确
         if (startPos != QPoint(-1, -1)) {
-            grid[startPos.y()][startPos.x()] = Start;
+            grid.setCell(startPos, Start);
         }
         if (endPos != QPoint(-1, -1)) {
-            grid[endPos.y()][endPos.x()] = End;
+            grid.setCell(endPos, End);
         }
     }
     
@@ -669,23 +1149,6 @@ void GridEditor::moveToNextPosition()
     }
 }
 
-QVector<QVector<int>> GridEditor::getGridData() const
-{
-    QVector<QVector<int>> data(rows);
-    for (int i = 0; i < rows; ++i) {
-        data[i].resize(cols);
-        for (int j = 0; j < cols; ++j) {
-            // 转换为算法所需的格式：0-可通行，1-障碍
-            if (grid[i][j] == Obstacle) {
-                data[i][j] = 1;
-            } else {
-                data[i][j] = 0;
-            }
-        }
-    }
-    return data;
-}
-
 bool GridEditor::hasValidStartAndEnd() const
 {
     return startPos != QPoint(-1, -1) && endPos != QPoint(-1, -1);
@@ -694,6 +1157,9 @@ bool GridEditor::hasValidStartAndEnd() const
 void GridEditor::setCodeExecutionMode(bool enabled)
 {
     codeExecutionMode = enabled;
+    // 进入或退出执行模式时还没得到新路径的编辑不再计入延迟
+    frameStats.cancelEdit();
+    emit undoStateChanged();
     
     // 如果退出执行模式
     if (!enabled) {
@@ -710,25 +1176,18 @@ void GridEditor::setCodeExecutionMode(bool enabled)
 bool GridEditor::hasPath() const
 {
     // 检查网格中是否有路径相关的状态
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            CellState state = grid[i][j];
-            if (state == Path || state == Current || state == VisitedPath) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return grid.containsValue(Path) || grid.containsValue(Current) || grid.containsValue(VisitedPath);
 }
 
-void GridEditor::generateRandomObstacles(double density, int connectivityType, int pathCount, bool useSeed, int seed)
+int GridEditor::generateRandomObstacles(double density, int connectivityType, int pathCount, bool useSeed, int seed)
 {
+    GRIDMAP_TRACE_SCOPE("GridEditor::generateRandomObstacles");
     if (rows <= 0 || cols <= 0) {
-        return;
+        return 0;
     }
     
     if (startPos == QPoint(-1, -1) || endPos == QPoint(-1, -1)) {
-        return;
+        return 0;
     }
     
     // 设置随机种子
@@ -739,255 +1198,66 @@ void GridEditor::generateRandomObstacles(double density, int connectivityType, i
         generator = QRandomGenerator::global();
     }
     
-    // 清除现有障碍物（保留起点和终点）
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QPoint pos(j, i);
-            if (pos != startPos && pos != endPos) {
-                grid[i][j] = Empty;
-            }
-        }
-    }
-    
-    // 计算要生成的障碍物数量
-    int totalCells = rows * cols;
-    int availableCells = totalCells - 2; // 减去起点和终点
-    int targetObstacles = static_cast<int>(availableCells * density);
-    
-    // 根据连通性类型生成障碍物
-    switch (connectivityType) {
-        case 0: // 无可通行通路
-            generateObstaclesWithNoPath(generator, targetObstacles);
-            break;
-        case 1: // 一条可通行通路
-            generateObstaclesWithOnePath(generator, targetObstacles);
-            break;
-        case 2: // 多条可通行通路
-            generateObstaclesWithMultiplePaths(generator, targetObstacles, pathCount);
-            break;
-    }
+    // 生成逻辑与界面无关，交给ObstacleGenerator处理
+    ObstacleGenerator obstacleGenerator(rows, cols, startPos, endPos);
+    int guaranteedPaths = obstacleGenerator.generate(density, connectivityType, pathCount, generator);
     
     // 如果使用了自定义种子，需要删除生成器
     if (useSeed) {
         delete generator;
     }
     
-    emit gridChanged();
-    update();
+    applyGeneratedObstacles(obstacleGenerator);
+    return guaranteedPaths;
 }
 
-void GridEditor::generateObstaclesWithNoPath(QRandomGenerator* generator, int targetObstacles)
+bool GridEditor::generateProceduralMap(int pattern, double density, bool useSeed, int seed)
 {
-    // 生成随机障碍物，直到起点和终点不连通
-    QVector<QPoint> availablePositions;
-    
-    // 收集所有可用位置（除了起点和终点）
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QPoint pos(j, i);
-            if (pos != startPos && pos != endPos) {
-                availablePositions.append(pos);
-            }
-        }
+    GRIDMAP_TRACE_SCOPE("GridEditor::generateProceduralMap");
+    if (rows <= 0 || cols <= 0) {
+        return false;
     }
     
-    // 随机打乱位置
-    for (int i = availablePositions.size() - 1; i > 0; --i) {
-        int j = generator->bounded(i + 1);
-        availablePositions.swapItemsAt(i, j);
+    if (startPos == QPoint(-1, -1) || endPos == QPoint(-1, -1)) {
+        return false;
     }
     
-    // 逐步添加障碍物，直到达到目标数量或者起点终点不连通
-    int addedObstacles = 0;
-    for (const QPoint& pos : availablePositions) {
-        if (addedObstacles >= targetObstacles) break;
-        
-        // 临时设置障碍物
-        grid[pos.y()][pos.x()] = Obstacle;
-        
-        // 检查连通性
-        if (!isPathExists(startPos, endPos)) {
-            // 已经不连通了，目标达成
-            addedObstacles++;
-            break;
-        }
-        
-        addedObstacles++;
-    }
-}
-
-void GridEditor::generateObstaclesWithOnePath(QRandomGenerator* generator, int targetObstacles)
-{
-    // 首先使用BFS找到一条从起点到终点的路径
-    QList<QPoint> path = findPathBFS(startPos, endPos);
-    if (path.isEmpty()) {
-        return; // 如果找不到路径，直接返回
+    // 种子处理与随机障碍一致：相同种子、相同尺寸得到相同地图
+    QRandomGenerator* generator;
+    if (useSeed) {
+        generator = new QRandomGenerator(seed);
+    } else {
+        generator = QRandomGenerator::global();
     }
     
-    // 将路径上的点标记为受保护的
-    QList<QPoint> protectedCells = path;
+    ObstacleGenerator obstacleGenerator(rows, cols, startPos, endPos);
+    bool connected = obstacleGenerator.generatePattern(pattern, density, generator);
     
-    // 收集所有可用位置（除了路径上的点）
-    QVector<QPoint> availablePositions;
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QPoint pos(j, i);
-            if (!protectedCells.contains(pos)) {
-                availablePositions.append(pos);
-            }
-        }
-    }
-    
-    // 随机打乱位置
-    for (int i = availablePositions.size() - 1; i > 0; --i) {
-        int j = generator->bounded(i + 1);
-        availablePositions.swapItemsAt(i, j);
+    if (useSeed) {
+        delete generator;
     }
     
-    // 逐步添加障碍物，确保只有一条路径存在
-    int addedObstacles = 0;
-    for (const QPoint& pos : availablePositions) {
-        if (addedObstacles >= targetObstacles) break;
-        
-        // 临时设置障碍物
-        grid[pos.y()][pos.x()] = Obstacle;
-        
-        // 检查是否仍然只有一条路径
-        if (countPaths(startPos, endPos) == 1) {
-            addedObstacles++;
-        } else {
-            // 如果路径数量不是1，撤销这个障碍物
-            grid[pos.y()][pos.x()] = Empty;
-        }
-    }
+    applyGeneratedObstacles(obstacleGenerator);
+    return connected;
 }
 
-void GridEditor::generateObstaclesWithMultiplePaths(QRandomGenerator* generator, int targetObstacles, int pathCount)
+void GridEditor::applyGeneratedObstacles(const ObstacleGenerator& obstacleGenerator)
 {
-    // 收集所有可用位置（除了起点和终点）
-    QVector<QPoint> availablePositions;
+    const GridMap before = grid;
+    // 写回栅格（保留起点和终点），同时清除原有的障碍物和路径
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < cols; ++j) {
             QPoint pos(j, i);
             if (pos != startPos && pos != endPos) {
-                availablePositions.append(pos);
+                grid.setCell(j, i, obstacleGenerator.isObstacle(j, i) ? Obstacle : Empty);
             }
         }
     }
+    // 原来的障碍被清掉、或者整块都成了障碍的块只记录一个值
+    grid.compact();
+    journal.recordDiff(before, grid);
     
-    // 随机打乱位置
-    for (int i = availablePositions.size() - 1; i > 0; --i) {
-        int j = generator->bounded(i + 1);
-        availablePositions.swapItemsAt(i, j);
-    }
-    
-    // 逐步添加障碍物，确保至少有指定数量的路径
-    int addedObstacles = 0;
-    for (const QPoint& pos : availablePositions) {
-        if (addedObstacles >= targetObstacles) break;
-        
-        // 临时设置障碍物
-        grid[pos.y()][pos.x()] = Obstacle;
-        
-        // 检查路径数量
-        int currentPaths = countPaths(startPos, endPos);
-        if (currentPaths >= pathCount) {
-            addedObstacles++;
-        } else {
-            // 如果路径数量不足，撤销这个障碍物
-            grid[pos.y()][pos.x()] = Empty;
-        }
-    }
-}
-
-bool GridEditor::isPathExists(const QPoint& start, const QPoint& end)
-{
-    if (start == QPoint(-1, -1) || end == QPoint(-1, -1)) {
-        return false;
-    }
-    
-    QVector<QVector<bool>> visited(rows, QVector<bool>(cols, false));
-    QQueue<QPoint> queue;
-    
-    queue.enqueue(start);
-    visited[start.y()][start.x()] = true;
-    
-    // BFS搜索
-    while (!queue.isEmpty()) {
-        QPoint current = queue.dequeue();
-        
-        if (current == end) {
-            return true;
-        }
-        
-        // 检查四个方向
-        QList<QPoint> directions = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
-        for (const QPoint& dir : directions) {
-            QPoint next(current.x() + dir.x(), current.y() + dir.y());
-            
-            if (isValidGridPos(next) && !visited[next.y()][next.x()]) {
-                // 如果是空格子、起点或终点，就可以通过
-                CellState state = grid[next.y()][next.x()];
-                if (state == Empty || next == start || next == end) {
-                    visited[next.y()][next.x()] = true;
-                    queue.enqueue(next);
-                }
-            }
-        }
-    }
-    
-    return false;
-}
-
-QList<QPoint> GridEditor::findPathBFS(const QPoint& start, const QPoint& end)
-{
-    QList<QPoint> path;
-    if (start == QPoint(-1, -1) || end == QPoint(-1, -1)) {
-        return path;
-    }
-    
-    QVector<QVector<bool>> visited(rows, QVector<bool>(cols, false));
-    QQueue<QPoint> queue;
-    QVector<QVector<QPoint>> parent(rows, QVector<QPoint>(cols, QPoint(-1, -1))); // 用于回溯路径
-    
-    queue.enqueue(start);
-    visited[start.y()][start.x()] = true;
-    
-    while (!queue.isEmpty()) {
-        QPoint current = queue.dequeue();
-        
-        if (current == end) {
-            // 回溯构建路径
-            QPoint pathPoint = end;
-            while (pathPoint != QPoint(-1, -1)) {
-                path.prepend(pathPoint);
-                pathPoint = parent[pathPoint.y()][pathPoint.x()];
-            }
-            return path;
-        }
-        
-        // 检查四个方向
-        QList<QPoint> directions = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
-        for (const QPoint& dir : directions) {
-            QPoint next(current.x() + dir.x(), current.y() + dir.y());
-            
-            if (isValidGridPos(next) && !visited[next.y()][next.x()]) {
-                CellState state = grid[next.y()][next.x()];
-                if (state == Empty || next == start || next == end) {
-                    visited[next.y()][next.x()] = true;
-                    queue.enqueue(next);
-                    parent[next.y()][next.x()] = current;
-                }
-            }
-        }
-    }
-    
-    return path; // 返回空路径
-}
-
-int GridEditor::countPaths(const QPoint& start, const QPoint& end)
-{
-    // 简化版本：如果存在路径返回1，否则返回0
-    // 对于复杂的多路径计数，需要更复杂的算法
-    return isPathExists(start, end) ? 1 : 0;
-} 
\ No newline at end of file
+    emit gridChanged();
+    emit undoStateChanged();
+    update();
+}
\ No newline at end of file
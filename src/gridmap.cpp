@@ -0,0 +1,278 @@
+#include "../include/gridmap.h"
+#include <QAtomicInteger>
+#include <cstring>
+
+namespace {
+
+QAtomicInteger<quint64> lastVersion(0);
+
+} // namespace
+
+GridMap::GridMap()
+    : rowCount(0), colCount(0), chunkColCount(0), chunkRowCount(0), stamp(0)
+{
+}
+
+GridMap::GridMap(int rows, int cols, int value)
+    : rowCount(qMax(0, rows)), colCount(qMax(0, cols)),
+      chunkColCount((colCount + ChunkSize - 1) >> ChunkShift),
+      chunkRowCount((rowCount + ChunkSize - 1) >> ChunkShift),
+      stamp(0)
+{
+    fill(value);
+}
+
+void GridMap::fill(int value)
+{
+    // 所有块都只记录这个值，写入时才分配
+    Chunk chunk;
+    chunk.value = static_cast<quint8>(value);
+    chunks.fill(QVector<Chunk>(chunkColCount, chunk), chunkRowCount);
+    stamp = 0;
+}
+
+qint64 GridMap::replace(int from, int to)
+{
+    if (from == to) {
+        return 0;
+    }
+    qint64 replaced = 0;
+    for (int chunkY = 0; chunkY < chunkRowCount; ++chunkY) {
+        for (int chunkX = 0; chunkX < chunkColCount; ++chunkX) {
+            const Chunk& current = chunkAt(chunkX, chunkY);
+            if (current.cells.isEmpty()) {
+                if (current.value == from) {
+                    chunks[chunkY][chunkX].value = static_cast<quint8>(to);
+                    replaced += qint64(chunkWidth(chunkX)) * chunkHeight(chunkY);
+                }
+                continue;
+            }
+            // 先只读查找地图内的部分，没有 from 的块不复制（不满的块超出地图的格子不使用）
+            const int width = chunkWidth(chunkX);
+            const int height = chunkHeight(chunkY);
+            bool found = false;
+            for (int y = 0; y < height && !found; ++y) {
+                found = std::memchr(current.cells.constData() + y * ChunkSize, from, width) != nullptr;
+            }
+            if (!found) {
+                continue;
+            }
+            quint8* cells = chunks[chunkY][chunkX].cells.data();
+            for (int y = 0; y < height; ++y) {
+                quint8* line = cells + y * ChunkSize;
+                for (int x = 0; x < width; ++x) {
+                    if (line[x] == from) {
+                        line[x] = static_cast<quint8>(to);
+                        ++replaced;
+                    }
+                }
+            }
+            compactChunk(chunkX, chunkY);
+        }
+    }
+    if (replaced > 0) {
+        stamp = 0;
+    }
+    return replaced;
+}
+
+bool GridMap::containsValue(int value) const
+{
+    for (int chunkY = 0; chunkY < chunkRowCount; ++chunkY) {
+        for (int chunkX = 0; chunkX < chunkColCount; ++chunkX) {
+            const quint8* cells = chunkData(chunkX, chunkY);
+            if (!cells) {
+                if (chunkValue(chunkX, chunkY) == value) {
+                    return true;
+                }
+                continue;
+            }
+            const int width = chunkWidth(chunkX);
+            const int height = chunkHeight(chunkY);
+            for (int y = 0; y < height; ++y) {
+                if (std::memchr(cells + y * ChunkSize, value, width)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void GridMap::compact(int left, int top, int width, int height)
+{
+    const int firstX = qMax(0, left) >> ChunkShift;
+    const int firstY = qMax(0, top) >> ChunkShift;
+    const int lastX = qMin(colCount, left + width) - 1;
+    const int lastY = qMin(rowCount, top + height) - 1;
+    if (lastX < 0 || lastY < 0) {
+        return;
+    }
+    for (int chunkY = firstY; chunkY <= lastY >> ChunkShift; ++chunkY) {
+        for (int chunkX = firstX; chunkX <= lastX >> ChunkShift; ++chunkX) {
+            compactChunk(chunkX, chunkY);
+        }
+    }
+}
+
+void GridMap::setChunk(int chunkX, int chunkY, int value, const QVector<quint8>& cells)
+{
+    Chunk& chunk = chunks[chunkY][chunkX];
+    chunk.value = static_cast<quint8>(value);
+    chunk.cells = cells.size() == ChunkSize * ChunkSize ? cells : QVector<quint8>();
+    stamp = 0;
+    compactChunk(chunkX, chunkY);
+}
+
+bool GridMap::compactChunk(int chunkX, int chunkY)
+{
+    const QVector<quint8>& cells = chunkAt(chunkX, chunkY).cells;
+    if (cells.isEmpty()) {
+        return false;
+    }
+    // 只比较地图内的部分，不满的块超出地图的格子不使用
+    const quint8 value = cells.at(0);
+    const int width = chunkWidth(chunkX);
+    const int height = chunkHeight(chunkY);
+    for (int y = 0; y < height; ++y) {
+        const quint8* line = cells.constData() + y * ChunkSize;
+        for (int x = 0; x < width; ++x) {
+            if (line[x] != value) {
+                return false;
+            }
+        }
+    }
+    // 内容不变，版本号不变
+    Chunk& chunk = chunks[chunkY][chunkX];
+    chunk.cells = QVector<quint8>();
+    chunk.value = value;
+    return true;
+}
+
+int GridMap::allocatedChunks() const
+{
+    int count = 0;
+    for (const QVector<Chunk>& row : chunks) {
+        for (const Chunk& chunk : row) {
+            if (!chunk.cells.isEmpty()) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+qint64 GridMap::memoryBytes() const
+{
+    return qint64(chunkRowCount) * (sizeof(QVector<Chunk>) + qint64(chunkColCount) * sizeof(Chunk))
+         + qint64(allocatedChunks()) * ChunkSize * ChunkSize;
+}
+
+quint64 GridMap::version() const
+{
+    if (stamp == 0) {
+        stamp = lastVersion.fetchAndAddRelaxed(1) + 1;
+    }
+    return stamp;
+}
+
+GridSnapshot GridMap::snapshot() const
+{
+    // 先确定版本号，快照中的副本不会再修改 stamp，可以在其他线程中读取
+    version();
+    return GridSnapshot(*this);
+}
+
+QVector<quint8> GridSnapshot::rowMajor() const
+{
+    if (!rowMajorCache) {
+        return grid.toRowMajor();
+    }
+    QMutexLocker locker(&rowMajorCache->mutex);
+    if (!rowMajorCache->ready) {
+        rowMajorCache->cells = grid.toRowMajor();
+        rowMajorCache->ready = true;
+    }
+    return rowMajorCache->cells;
+}
+
+bool GridMap::sharesChunk(const GridMap& other, int chunkX, int chunkY) const
+{
+    if (rowCount != other.rowCount || colCount != other.colCount) {
+        return false;
+    }
+    const quint8* cells = chunkData(chunkX, chunkY);
+    if (!cells) {
+        return other.isUniformChunk(chunkX, chunkY) && chunkValue(chunkX, chunkY) == other.chunkValue(chunkX, chunkY);
+    }
+    return cells == other.chunkData(chunkX, chunkY);
+}
+
+void GridMap::readRow(int y, quint8* target) const
+{
+    const int chunkY = y >> ChunkShift;
+    const int rowOffset = (y & (ChunkSize - 1)) << ChunkShift;
+    for (int chunkX = 0; chunkX < chunkColCount; ++chunkX) {
+        const int x = chunkX << ChunkShift;
+        const quint8* cells = chunkData(chunkX, chunkY);
+        if (cells) {
+            std::memcpy(target + x, cells + rowOffset, chunkWidth(chunkX));
+        } else {
+            std::memset(target + x, chunkValue(chunkX, chunkY), chunkWidth(chunkX));
+        }
+    }
+}
+
+QVector<quint8> GridMap::toRowMajor() const
+{
+    QVector<quint8> result(rowCount * colCount);
+    for (int y = 0; y < rowCount; ++y) {
+        readRow(y, result.data() + y * colCount);
+    }
+    return result;
+}
+
+QVector<QVector<int>> GridMap::toSearchGrid() const
+{
+    QVector<QVector<int>> grid(rowCount);
+    QVector<quint8> row(colCount);
+    for (int y = 0; y < rowCount; ++y) {
+        grid[y].resize(colCount);
+        readRow(y, row.data());
+        int* target = grid[y].data();
+        for (int x = 0; x < colCount; ++x) {
+            target[x] = row[x] == Obstacle ? 1 : 0;
+        }
+    }
+    return grid;
+}
+
+QVector<QVector<int>> GridMap::toCells() const
+{
+    QVector<QVector<int>> result(rowCount);
+    QVector<quint8> row(colCount);
+    for (int y = 0; y < rowCount; ++y) {
+        result[y].resize(colCount);
+        readRow(y, row.data());
+        int* target = result[y].data();
+        for (int x = 0; x < colCount; ++x) {
+            target[x] = row[x];
+        }
+    }
+    return result;
+}
+
+GridMap GridMap::fromCells(const QVector<QVector<int>>& cells)
+{
+    const int rows = cells.size();
+    const int cols = rows > 0 ? cells[0].size() : 0;
+    GridMap map(rows, cols);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols && x < cells[y].size(); ++x) {
+            map.setCell(x, y, cells[y][x]);
+        }
+    }
+    // 全是障碍的块也只记录一个值
+    map.compact();
+    return map;
+}
@@ -0,0 +1,220 @@
+#include "../include/gridmapcore_c.h"
+#include "../include/gridmap.h"
+#include "../include/mapfile.h"
+#include "../include/pathsearch.h"
+#include <QString>
+
+struct gmc_grid {
+    GridMap map;
+    QPoint startPos = QPoint(-1, -1);
+    QPoint endPos = QPoint(-1, -1);
+};
+
+namespace {
+
+int setPoint(gmc_grid* grid, int x, int y, QPoint* target)
+{
+    if (!grid || !grid->map.contains(x, y)) {
+        return GMC_INVALID_ARGUMENT;
+    }
+    *target = QPoint(x, y);
+    return GMC_OK;
+}
+
+int getPoint(const gmc_grid* grid, const QPoint& point, int* x, int* y)
+{
+    if (!grid || !x || !y) {
+        return GMC_INVALID_ARGUMENT;
+    }
+    *x = point.x();
+    *y = point.y();
+    return GMC_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+gmc_grid* gmc_grid_create(int rows, int cols)
+{
+    if (rows <= 0 || cols <= 0) {
+        return nullptr;
+    }
+    try {
+        gmc_grid* grid = new gmc_grid;
+        grid->map = GridMap(rows, cols);
+        return grid;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+gmc_grid* gmc_grid_load(const char* path)
+{
+    if (!path) {
+        return nullptr;
+    }
+    gmc_grid* grid = nullptr;
+    try {
+        MapFile::GridData data;
+        if (!MapFile::load(QString::fromUtf8(path), &data)) {
+            return nullptr;
+        }
+        grid = new gmc_grid;
+        grid->map = data.grid;
+        grid->startPos = data.startPos;
+        grid->endPos = data.endPos;
+        return grid;
+    } catch (...) {
+        delete grid;
+        return nullptr;
+    }
+}
+
+int gmc_grid_save(const gmc_grid* grid, const char* path)
+{
+    if (!grid || !path) {
+        return GMC_INVALID_ARGUMENT;
+    }
+    try {
+        MapFile::GridData data;
+        data.grid = grid->map;
+        data.startPos = grid->startPos;
+        data.endPos = grid->endPos;
+        return MapFile::save(QString::fromUtf8(path), data) ? GMC_OK : GMC_IO_ERROR;
+    } catch (...) {
+        return GMC_INTERNAL_ERROR;
+    }
+}
+
+void gmc_grid_destroy(gmc_grid* grid)
+{
+    delete grid;
+}
+
+int gmc_grid_rows(const gmc_grid* grid)
+{
+    return grid ? grid->map.rows() : 0;
+}
+
+int gmc_grid_cols(const gmc_grid* grid)
+{
+    return grid ? grid->map.cols() : 0;
+}
+
+int gmc_grid_get_cell(const gmc_grid* grid, int x, int y)
+{
+    if (!grid || !grid->map.contains(x, y)) {
+        return -1;
+    }
+    return grid->map.cell(x, y);
+}
+
+int gmc_grid_set_cell(gmc_grid* grid, int x, int y, int value)
+{
+    if (!grid || !grid->map.contains(x, y) || value < 0 || value > MapFile::MaxCellValue) {
+        return GMC_INVALID_ARGUMENT;
+    }
+    try {
+        // 整块同一个值的块第一次写入不同的值时分配格子
+        grid->map.setCell(x, y, value);
+        return GMC_OK;
+    } catch (...) {
+        return GMC_INTERNAL_ERROR;
+    }
+}
+
+int gmc_grid_set_start(gmc_grid* grid, int x, int y)
+{
+    return setPoint(grid, x, y, grid ? &grid->startPos : nullptr);
+}
+
+int gmc_grid_set_end(gmc_grid* grid, int x, int y)
+{
+    return setPoint(grid, x, y, grid ? &grid->endPos : nullptr);
+}
+
+int gmc_grid_get_start(const gmc_grid* grid, int* x, int* y)
+{
+    return getPoint(grid, grid ? grid->startPos : QPoint(), x, y);
+}
+
+int gmc_grid_get_end(const gmc_grid* grid, int* x, int* y)
+{
+    return getPoint(grid, grid ? grid->endPos : QPoint(), x, y);
+}
+
+int gmc_find_path(const gmc_grid* grid,
+                  int algorithm,
+                  int* out_xy,
+                  int capacity,
+                  int* out_length,
+                  gmc_search_stats* stats)
+{
+    if (out_length) {
+        *out_length = 0;
+    }
+    if (stats) {
+        *stats = gmc_search_stats();
+    }
+    if (!grid || algorithm < GMC_ASTAR || algorithm > GMC_DSTAR || capacity < 0
+        || (capacity > 0 && !out_xy)) {
+        return GMC_INVALID_ARGUMENT;
+    }
+    if (!grid->map.contains(grid->startPos) || !grid->map.contains(grid->endPos)) {
+        return GMC_INVALID_ARGUMENT;
+    }
+
+    // 搜索用的栅格和路径都要分配内存，分配失败时不能把异常抛给 C 调用方
+    try {
+        if (grid->map.isBlocked(grid->startPos.x(), grid->startPos.y())
+            || grid->map.isBlocked(grid->endPos.x(), grid->endPos.y())) {
+            return GMC_NO_PATH;
+        }
+
+        // 直接在格子块上搜索，大地图按块搜索（PathSearch::needsChunkedSearch）
+        PathSearch::SearchStats searchStats;
+        const QList<QPoint> path = PathSearch::runAlgorithm(static_cast<PathSearch::AlgorithmType>(algorithm),
+                                                            grid->map, grid->startPos, grid->endPos,
+                                                            &searchStats);
+        if (stats) {
+            stats->nodes_expanded = searchStats.nodesExpanded;
+            stats->nodes_generated = searchStats.nodesGenerated;
+            stats->peak_open_size = searchStats.peakOpenSize;
+            stats->workspace_bytes = searchStats.workspaceBytes;
+            stats->setup_time_ns = searchStats.setupTimeNs;
+            stats->search_time_ns = searchStats.searchTimeNs;
+            stats->reconstruction_time_ns = searchStats.reconstructionTimeNs;
+        }
+        if (path.isEmpty()) {
+            return GMC_NO_PATH;
+        }
+
+        const int length = static_cast<int>(path.size());
+        if (out_length) {
+            *out_length = length;
+        }
+        if (length > capacity) {
+            return GMC_BUFFER_TOO_SMALL;
+        }
+        for (int i = 0; i < length; ++i) {
+            out_xy[2 * i] = path[i].x();
+            out_xy[2 * i + 1] = path[i].y();
+        }
+        return GMC_OK;
+    } catch (...) {
+        return GMC_INTERNAL_ERROR;
+    }
+}
+
+const char* gmc_algorithm_name(int algorithm)
+{
+    // 与 PathSearch::algorithmName 一致
+    static const char* const names[] = { "A*", "Dijkstra", "BFS", "DFS", "D*" };
+    if (algorithm < GMC_ASTAR || algorithm > GMC_DSTAR) {
+        return nullptr;
+    }
+    return names[algorithm];
+}
+
+} // extern "C"
@@ -0,0 +1,355 @@
+#include "../include/incrementalplanner.h"
+#include "../include/gridmap.h"
+#include "../include/traceprofiler.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <limits>
+
+static const int kInfinity = std::numeric_limits<int>::max() / 4;
+static const qint64 kNoKey = -1;
+static const int kOffsetCount = 4;
+// 变化的格子超过地图的 1/8 时重新搜索比逐个修复更快
+static const int kRebuildFraction = 8;
+
+IncrementalPlanner::IncrementalPlanner()
+    : rowCount(0), colCount(0), stride(0), goalIndex(-1), startIndex(-1), lastStartIndex(-1),
+      keyModifier(0), openCount(0), expanded(0), generated(0), peakOpen(0)
+{
+}
+
+void IncrementalPlanner::reset()
+{
+    rowCount = 0;
+    colCount = 0;
+    stride = 0;
+    goalIndex = -1;
+    startIndex = -1;
+    lastStartIndex = -1;
+    keyModifier = 0;
+    synced = GridMap();
+    blocked.clear();
+    g.clear();
+    rhs.clear();
+    openKey.clear();
+    heap.clear();
+    openCount = 0;
+}
+
+QList<QPoint> IncrementalPlanner::plan(const GridMap& grid,
+                                       const QPoint& start,
+                                       const QPoint& goal,
+                                       PathSearch::SearchStats* stats)
+{
+    GRIDMAP_TRACE_SCOPE("IncrementalPlanner::plan");
+    QList<QPoint> path;
+    if (!grid.contains(start) || !grid.contains(goal) || PathSearch::needsChunkedSearch(grid)) {
+        return path;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    expanded = 0;
+    generated = 0;
+    peakOpen = 0;
+
+    if (!isInitialized() || grid.rows() != rowCount || grid.cols() != colCount
+        || index(goal) != goalIndex) {
+        initialize(grid, start, goal);
+    } else {
+        // 起点移动后已有的键都偏小 h(上次起点, 起点)，累加到 km 上，不用重排开放列表
+        startIndex = index(start);
+        keyModifier += heuristic(lastStartIndex, startIndex);
+        lastStartIndex = startIndex;
+        if (syncCells(grid) * kRebuildFraction > rowCount * colCount) {
+            initialize(grid, start, goal);
+        }
+    }
+    peakOpen = openCount;
+    const qint64 setupTime = timer.nsecsElapsed();
+
+    computeShortestPath();
+    const qint64 searchTime = timer.nsecsElapsed() - setupTime;
+
+    // 沿 g 值下降的方向走到终点
+    if (!blocked[startIndex] && qMin(g[startIndex], rhs[startIndex]) < kInfinity) {
+        const int offsets[kOffsetCount] = { -1, 1, -stride, stride };
+        int current = startIndex;
+        path.append(start);
+        while (current != goalIndex && path.size() <= rowCount * colCount) {
+            int next = -1;
+            int bestCost = kInfinity;
+            for (int i = 0; i < kOffsetCount; ++i) {
+                const int neighbour = current + offsets[i];
+                if (!blocked[neighbour] && g[neighbour] < bestCost) {
+                    bestCost = g[neighbour];
+                    next = neighbour;
+                }
+            }
+            if (next < 0) {
+                path.clear();
+                break;
+            }
+            current = next;
+            path.append(point(current));
+        }
+        if (current != goalIndex) {
+            path.clear();
+        }
+    }
+
+    if (stats) {
+        stats->nodesExpanded = expanded;
+        stats->nodesGenerated = generated;
+        stats->peakOpenSize = peakOpen;
+        stats->workspaceBytes = qint64(blocked.size()) * (sizeof(quint8) + sizeof(int) * 2 + sizeof(qint64))
+                                + qint64(heap.capacity()) * sizeof(Entry);
+        stats->setupTimeNs = setupTime;
+        stats->searchTimeNs = searchTime;
+        stats->reconstructionTimeNs = timer.nsecsElapsed() - setupTime - searchTime;
+    }
+    return path;
+}
+
+void IncrementalPlanner::initialize(const GridMap& grid, const QPoint& start, const QPoint& goal)
+{
+    GRIDMAP_TRACE_SCOPE("IncrementalPlanner::initialize");
+    rowCount = grid.rows();
+    colCount = grid.cols();
+    stride = colCount + 2;
+    const int size = (rowCount + 2) * stride;
+
+    blocked.fill(1, size);
+    for (int y = 0; y < rowCount; ++y) {
+        quint8* line = blocked.data() + (y + 1) * stride + 1;
+        grid.readRow(y, line);
+        for (int x = 0; x < colCount; ++x) {
+            line[x] = line[x] == GridMap::Obstacle ? 1 : 0;
+        }
+    }
+    synced = grid.snapshot().map();
+    g.fill(kInfinity, size);
+    rhs.fill(kInfinity, size);
+    openKey.fill(kNoKey, size);
+    heap.clear();
+    openCount = 0;
+
+    goalIndex = index(goal);
+    startIndex = index(start);
+    lastStartIndex = startIndex;
+    keyModifier = 0;
+
+    // 第一次规划用反向广度优先算出所有格子到终点的距离，之后所有格子都满足 g == rhs，开放列表为空
+    // 比从空状态开始的 D* Lite 少维护一个堆，之后每次重新规划都只修复变化的部分
+    const int offsets[kOffsetCount] = { -1, 1, -stride, stride };
+    QVector<int> queue;
+    queue.reserve(rowCount * colCount);
+    g[goalIndex] = 0;
+    rhs[goalIndex] = 0;
+    queue.append(goalIndex);
+    for (int head = 0; head < queue.size(); ++head) {
+        const int current = queue[head];
+        ++expanded;
+        if (blocked[current]) {
+            continue;  // 终点本身是障碍时只有终点有距离
+        }
+        for (int offset : offsets) {
+            const int neighbour = current + offset;
+            if (!blocked[neighbour] && g[neighbour] == kInfinity) {
+                g[neighbour] = g[current] + 1;
+                rhs[neighbour] = g[neighbour];
+                queue.append(neighbour);
+                ++generated;
+            }
+        }
+    }
+}
+
+int IncrementalPlanner::syncCells(const GridMap& grid)
+{
+    GRIDMAP_TRACE_SCOPE("IncrementalPlanner::syncCells");
+    changedCells.clear();
+    if (grid.version() == synced.version()) {
+        return 0;
+    }
+    // 与上次同步的版本共享存储的块没有变化，只比较被写过的块
+    for (int chunkY = 0; chunkY < grid.chunkRows(); ++chunkY) {
+        for (int chunkX = 0; chunkX < grid.chunkCols(); ++chunkX) {
+            if (grid.sharesChunk(synced, chunkX, chunkY)) {
+                continue;
+            }
+            const quint8* chunk = grid.chunkData(chunkX, chunkY);  // 整块同一个值时为空
+            const quint8 uniform = grid.chunkValue(chunkX, chunkY) == GridMap::Obstacle ? 1 : 0;
+            const int left = chunkX * GridMap::ChunkSize;
+            const int top = chunkY * GridMap::ChunkSize;
+            const int width = qMin(GridMap::ChunkSize, colCount - left);
+            const int height = qMin(GridMap::ChunkSize, rowCount - top);
+            for (int y = 0; y < height; ++y) {
+                const quint8* source = chunk ? chunk + y * GridMap::ChunkSize : nullptr;
+                const int base = (top + y + 1) * stride + left + 1;
+                for (int x = 0; x < width; ++x) {
+                    const quint8 isBlocked = source ? (source[x] == GridMap::Obstacle ? 1 : 0) : uniform;
+                    if (blocked[base + x] != isBlocked) {
+                        blocked[base + x] = isBlocked;
+                        changedCells.append(base + x);
+                    }
+                }
+            }
+        }
+    }
+    synced = grid.snapshot().map();
+    if (changedCells.size() * kRebuildFraction > rowCount * colCount) {
+        return changedCells.size();
+    }
+
+    // 格子本身和四个邻居的 rhs 依赖于变化的边
+    const int offsets[kOffsetCount + 1] = { 0, -1, 1, -stride, stride };
+    for (int cell : changedCells) {
+        for (int offset : offsets) {
+            const int target = cell + offset;
+            if (target != goalIndex) {
+                rhs[target] = bestNeighbourCost(target);
+            }
+            updateCell(target);
+        }
+    }
+    return changedCells.size();
+}
+
+int IncrementalPlanner::heuristic(int from, int to) const
+{
+    return qAbs(from % stride - to % stride) + qAbs(from / stride - to / stride);
+}
+
+qint64 IncrementalPlanner::keyOf(int index) const
+{
+    const int cost = qMin(g[index], rhs[index]);
+    if (cost >= kInfinity) {
+        return std::numeric_limits<qint64>::max();
+    }
+    // 按 (k1, k2) 的字典序比较，两部分都小于 2^31
+    const qint64 primary = qint64(cost) + heuristic(startIndex, index) + keyModifier;
+    return (primary << 32) | cost;
+}
+
+int IncrementalPlanner::bestNeighbourCost(int index) const
+{
+    if (blocked[index]) {
+        return kInfinity;
+    }
+    const int offsets[kOffsetCount] = { -1, 1, -stride, stride };
+    int best = kInfinity;
+    for (int offset : offsets) {
+        const int neighbour = index + offset;
+        if (!blocked[neighbour] && g[neighbour] < kInfinity) {
+            best = qMin(best, g[neighbour] + 1);
+        }
+    }
+    return best;
+}
+
+void IncrementalPlanner::updateCell(int index)
+{
+    if (g[index] != rhs[index]) {
+        const qint64 key = keyOf(index);
+        if (openKey[index] != key) {
+            push(index, key);
+        }
+    } else if (openKey[index] != kNoKey) {
+        openKey[index] = kNoKey;
+        --openCount;
+    }
+}
+
+void IncrementalPlanner::push(int index, qint64 key)
+{
+    if (openKey[index] == kNoKey) {
+        ++openCount;
+        ++generated;
+        peakOpen = qMax(peakOpen, openCount);
+    }
+    openKey[index] = key;
+    heap.append(Entry{ key, index });
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+void IncrementalPlanner::compactHeap()
+{
+    // 多次规划后堆中大部分是过期条目时重建
+    if (heap.size() <= openCount * 2 + 4096) {
+        return;
+    }
+    QVector<Entry> live;
+    live.reserve(openCount);
+    for (const Entry& entry : heap) {
+        if (openKey[entry.index] == entry.key) {
+            live.append(entry);
+            // 同一个键的重复条目只保留一个
+            openKey[entry.index] = ~entry.key;
+        }
+    }
+    for (Entry& entry : live) {
+        openKey[entry.index] = entry.key;
+    }
+    std::make_heap(live.begin(), live.end(), later);
+    heap.swap(live);
+}
+
+void IncrementalPlanner::computeShortestPath()
+{
+    GRIDMAP_TRACE_SCOPE("IncrementalPlanner::computeShortestPath");
+    compactHeap();
+    const int offsets[kOffsetCount] = { -1, 1, -stride, stride };
+    for (;;) {
+        while (!heap.isEmpty() && openKey[heap.first().index] != heap.first().key) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            heap.removeLast();
+        }
+        if (heap.isEmpty()) {
+            break;
+        }
+        const Entry top = heap.first();
+        if (top.key >= keyOf(startIndex) && rhs[startIndex] <= g[startIndex]) {
+            break;
+        }
+
+        const int current = top.index;
+        const qint64 key = keyOf(current);
+        if (top.key < key) {
+            // 键因起点移动而过期：按新键放回
+            push(current, key);
+            continue;
+        }
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.removeLast();
+        openKey[current] = kNoKey;
+        --openCount;
+        ++expanded;
+
+        if (g[current] > rhs[current]) {
+            // 距离变短：确定下来并传给邻居
+            g[current] = rhs[current];
+            for (int offset : offsets) {
+                const int neighbour = current + offset;
+                if (neighbour != goalIndex && !blocked[neighbour] && g[current] + 1 < rhs[neighbour]) {
+                    rhs[neighbour] = g[current] + 1;
+                    updateCell(neighbour);
+                }
+            }
+        } else {
+            // 距离变长：作废，依赖它的邻居重新选择
+            const int oldCost = g[current];
+            g[current] = kInfinity;
+            if (current != goalIndex) {
+                rhs[current] = bestNeighbourCost(current);
+            }
+            updateCell(current);
+            for (int offset : offsets) {
+                const int neighbour = current + offset;
+                if (neighbour != goalIndex && !blocked[neighbour] && rhs[neighbour] == oldCost + 1) {
+                    rhs[neighbour] = bestNeighbourCost(neighbour);
+                    updateCell(neighbour);
+                }
+            }
+        }
+    }
+}
@@ -2,6 +2,8 @@
 #include "../include/codehighlighter.h"
 #include "../include/gridcreatedialog.h"
 #include "../include/examplecodedialog.h"
+#include "../include/algorithmplugins.h"
+#include "../include/traceprofiler.h"
 #include <QApplication>
 #include <QVBoxLayout>
 #include <QFileDialog>
@@ -13,6 +15,7 @@
 #include <QToolBar>
 #include <QButtonGroup>
 #include <QToolButton>
+#include <QStatusBar>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), currentAlgorithmName("自定义算法"), hasValidPathBeforeChange(false)
@@ -47,8 +50,16 @@ MainWindow::MainWindow(QWidget *parent)
     // 创建栅格编辑器
     gridEditor = new GridEditor(this);
     
-    // 创建代码执行器
+    // 创建代码执行器（同时加载原生插件算法）
     executor = new PathfindingExecutor(this);
+    
+    // 搜索统计面板（停靠在底部，可从“视图”菜单显示或隐藏）
+    statsDock = new SearchStatsDock(this);
+    addDockWidget(Qt::BottomDockWidgetArea, statsDock);
+    
+    // 算法竞速（结果窗口在首次竞速时创建）
+    race = new PathfindingRace(this);
+    raceDialog = nullptr;
 
     // 添加到分割器
     splitter->addWidget(leftPanel);
@@ -68,6 +79,24 @@ MainWindow::MainWindow(QWidget *parent)
     
     // 连接信号和槽
     connect(executor, &PathfindingExecutor::pathFound, gridEditor, &GridEditor::executePathfinding);
+    connect(executor, &PathfindingExecutor::pathFound, this,
+            [this](const QList<QPoint>& path, const PathSearch::SearchStats& stats) {
+        statsDock->addRun(stats, path.size() - 1);
+        if (executor->isExpansionTracing()) {
+            gridEditor->setExpansionHeatmap(executor->lastExpansionTrace());
+        }
+    });
+    connect(executor, &PathfindingExecutor::noPathFound, this,
+            [this](const QString&, const PathSearch::SearchStats& stats) {
+        // 参数校验失败时没有运行任何算法，不记录
+        if (stats.algorithm != PathSearch::Unknown) {
+            statsDock->addRun(stats, -1);
+            // 搜索失败时热力图显示算法搜索过的全部区域
+            if (executor->isExpansionTracing()) {
+                gridEditor->setExpansionHeatmap(executor->lastExpansionTrace());
+            }
+        }
+    });
     connect(executor, &PathfindingExecutor::executionError, this, [this](const QString& message) {
         QMessageBox::critical(this, tr("执行错误"), message);
         // 执行出错时退出代码执行模式
@@ -102,10 +131,40 @@ MainWindow::MainWindow(QWidget *parent)
         }
     });
     
+    connect(race, &PathfindingRace::engineFinished, this, &MainWindow::onRaceEngineFinished);
+    connect(race, &PathfindingRace::raceFinished, this, [this]() {
+        if (raceDialog) {
+            raceDialog->setRaceFinished();
+        }
+    });
+    
+    connect(gridEditor, &GridEditor::undoStateChanged, this, [this]() {
+        undoAction->setEnabled(gridEditor->canUndo());
+        redoAction->setEnabled(gridEditor->canRedo());
+    });
+    
     // 连接栅格变化信号，用于实时路径更新
     connect(gridEditor, &GridEditor::gridChanged, this, [this]() {
+        GRIDMAP_TRACE_SCOPE("MainWindow::onGridChanged");
+        // 竞速结果、热力图和调试会话对应旧地图，栅格变化后不再叠加显示
+        gridEditor->clearOverlayPaths();
+        gridEditor->clearExpansionHeatmap();
+        if (debugger.isActive()) {
+            stopDebugging();
+            statusBar()->showMessage(tr("地图已修改，单步调试结束"), 5000);
+        }
+        
         // 只有在代码执行模式下才进行实时更新
-        if (gridEditor->isInExecutionMode() && !codeEditor->toPlainText().trimmed().isEmpty()) {
+        const QString code = codeEditor->toPlainText().trimmed();
+        if (gridEditor->isInExecutionMode() && !code.isEmpty()) {
+            // 最短路径算法下编辑没有挡住剩余路线、也不可能让它变短时，路线不变，不用重新搜索
+            if (gridEditor->lastEditKeepsShortestPath()
+                && executor->shortestPathAlgorithm(code) != PathSearch::Unknown) {
+                gridEditor->keepCurrentPath();
+                return;
+            }
+            // 只有真正重新规划的编辑才开始计算编辑到新路径的延迟
+            gridEditor->markReplanRequested();
             updatePathInRealTime();
         }
     });
@@ -170,6 +229,17 @@ void MainWindow::createActions()
     clearGridAction = new QAction(tr("清空栅格地图"), this);
     connect(clearGridAction, &QAction::triggered, this, &MainWindow::clearCurrentGrid);
 
+    // 撤销和重做栅格编辑；代码编辑器有焦点时快捷键仍由代码编辑器处理
+    undoAction = new QAction(tr("撤销编辑"), this);
+    undoAction->setShortcuts(QKeySequence::Undo);
+    undoAction->setEnabled(false);
+    connect(undoAction, &QAction::triggered, gridEditor, &GridEditor::undo);
+
+    redoAction = new QAction(tr("重做编辑"), this);
+    redoAction->setShortcuts(QKeySequence::Redo);
+    redoAction->setEnabled(false);
+    connect(redoAction, &QAction::triggered, gridEditor, &GridEditor::redo);
+
     // 新增：保存和读取地图动作
     saveGridAction = new QAction(tr("保存地图"), this);
     connect(saveGridAction, &QAction::triggered, this, &MainWindow::saveGridMap);
@@ -194,6 +264,77 @@ void MainWindow::createActions()
     stopExecutionAction = new QAction(tr("停止执行"), this);
     stopExecutionAction->setEnabled(false);
     connect(stopExecutionAction, &QAction::triggered, this, &MainWindow::stopExecution);
+    
+    // 算法竞速动作
+    raceAction = new QAction(tr("算法竞速"), this);
+    raceAction->setShortcut(QKeySequence("F6"));
+    connect(raceAction, &QAction::triggered, this, &MainWindow::startRace);
+    
+    // 扩展热力图动作：关闭时算法不做任何记录
+    heatmapAction = new QAction(tr("显示扩展热力图"), this);
+    heatmapAction->setCheckable(true);
+    connect(heatmapAction, &QAction::toggled, this, [this](bool checked) {
+        executor->setExpansionTracing(checked);
+        if (!checked) {
+            gridEditor->clearExpansionHeatmap();
+        }
+    });
+    
+    heatmapModeGroup = new QActionGroup(this);
+    heatmapOrderAction = new QAction(tr("按扩展顺序着色"), this);
+    heatmapOrderAction->setCheckable(true);
+    heatmapOrderAction->setChecked(true);
+    heatmapModeGroup->addAction(heatmapOrderAction);
+    heatmapCountAction = new QAction(tr("按扩展次数着色"), this);
+    heatmapCountAction->setCheckable(true);
+    heatmapModeGroup->addAction(heatmapCountAction);
+    connect(heatmapModeGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+        gridEditor->setHeatmapMode(action == heatmapCountAction ? GridEditor::ExpansionCount
+                                                                : GridEditor::ExpansionOrder);
+    });
+    
+    // 性能信息浮层动作
+    hudAction = new QAction(tr("性能信息"), this);
+    hudAction->setCheckable(true);
+    hudAction->setShortcut(QKeySequence("F12"));
+    connect(hudAction, &QAction::toggled, gridEditor, &GridEditor::setPerformanceHudVisible);
+    
+    // 性能跟踪动作：编译时关闭跟踪点（GRIDMAP_ENABLE_TRACE）后不可用
+    traceRecordAction = new QAction(tr("记录性能跟踪"), this);
+    traceRecordAction->setCheckable(true);
+    traceRecordAction->setEnabled(TraceProfiler::isCompiledIn());
+    connect(traceRecordAction, &QAction::toggled, this, [](bool checked) {
+        TraceProfiler::instance().setEnabled(checked);
+    });
+    
+    traceExportAction = new QAction(tr("导出性能跟踪..."), this);
+    traceExportAction->setEnabled(TraceProfiler::isCompiledIn());
+    connect(traceExportAction, &QAction::triggered, this, &MainWindow::exportTrace);
+    
+    // 单步调试动作：会话开始前只有“开始调试”可用
+    debugStartAction = new QAction(tr("开始调试"), this);
+    debugStartAction->setShortcut(QKeySequence("F9"));
+    connect(debugStartAction, &QAction::triggered, this, &MainWindow::startDebugging);
+    
+    debugStepAction = new QAction(tr("单步"), this);
+    debugStepAction->setShortcut(QKeySequence("F10"));
+    debugStepAction->setEnabled(false);
+    connect(debugStepAction, &QAction::triggered, this, &MainWindow::debugStep);
+    
+    debugContinueAction = new QAction(tr("运行到断点"), this);
+    debugContinueAction->setShortcut(QKeySequence("F8"));
+    debugContinueAction->setToolTip(tr("Ctrl+左键点击格子设置或取消断点"));
+    debugContinueAction->setEnabled(false);
+    connect(debugContinueAction, &QAction::triggered, this, &MainWindow::debugContinue);
+    
+    debugFinishAction = new QAction(tr("运行到结束"), this);
+    debugFinishAction->setEnabled(false);
+    connect(debugFinishAction, &QAction::triggered, this, &MainWindow::debugRunToEnd);
+    
+    debugStopAction = new QAction(tr("结束调试"), this);
+    debugStopAction->setShortcut(QKeySequence("Shift+F9"));
+    debugStopAction->setEnabled(false);
+    connect(debugStopAction, &QAction::triggered, this, &MainWindow::stopDebugging);
 }
 
 void MainWindow::createMenus()
@@ -207,11 +348,21 @@ void MainWindow::createMenus()
 
     viewMenu = menuBar()->addMenu(tr("视图"));
     themeMenu = viewMenu->addMenu(tr("主题"));
+    viewMenu->addAction(statsDock->toggleViewAction());
+    viewMenu->addAction(hudAction);
+    QMenu *heatmapMenu = viewMenu->addMenu(tr("扩展热力图"));
+    heatmapMenu->addAction(heatmapAction);
+    heatmapMenu->addSeparator();
+    heatmapMenu->addAction(heatmapOrderAction);
+    heatmapMenu->addAction(heatmapCountAction);
 
     gridMenu = menuBar()->addMenu(tr("栅格地图"));
     gridMenu->addAction(newGridAction);
     gridMenu->addAction(clearGridAction);
     gridMenu->addSeparator();
+    gridMenu->addAction(undoAction);
+    gridMenu->addAction(redoAction);
+    gridMenu->addSeparator();
     gridMenu->addAction(saveGridAction);    // 新增：保存地图菜单项
     gridMenu->addAction(loadGridAction);    // 新增：读取地图菜单项
     gridMenu->addSeparator();
@@ -220,9 +371,37 @@ void MainWindow::createMenus()
     exampleMenu = menuBar()->addMenu(tr("示例代码"));
     exampleMenu->addAction(exampleCodeAction);
     
+    // 插件算法：启动时从 plugins 目录加载的原生算法
+    QMenu *pluginMenu = exampleMenu->addMenu(tr("插件算法"));
+    const QList<PathSearch::AlgorithmType> plugins = AlgorithmPlugins::instance().algorithms();
+    for (PathSearch::AlgorithmType algorithm : plugins) {
+        QAction *action = pluginMenu->addAction(PathSearch::algorithmName(algorithm));
+        action->setToolTip(QDir::toNativeSeparators(AlgorithmPlugins::instance().fileName(algorithm)));
+        connect(action, &QAction::triggered, this, [this, algorithm]() { selectPluginAlgorithm(algorithm); });
+    }
+    if (plugins.isEmpty()) {
+        pluginMenu->addAction(tr("未找到插件"))->setEnabled(false);
+    }
+    
     QMenu *runMenu = menuBar()->addMenu(tr("运行"));
     runMenu->addAction(runCodeAction);
     runMenu->addAction(stopExecutionAction);
+    runMenu->addSeparator();
+    runMenu->addAction(raceAction);
+    runMenu->addSeparator();
+    QMenu *debugMenu = runMenu->addMenu(tr("单步调试"));
+    debugMenu->setToolTipsVisible(true);
+    debugMenu->addAction(debugStartAction);
+    debugMenu->addAction(debugStepAction);
+    debugMenu->addAction(debugContinueAction);
+    debugMenu->addAction(debugFinishAction);
+    debugMenu->addAction(debugStopAction);
+    debugMenu->addSeparator();
+    QAction *clearBreakpointsAction = debugMenu->addAction(tr("清除全部断点"));
+    connect(clearBreakpointsAction, &QAction::triggered, gridEditor, &GridEditor::clearBreakpoints);
+    runMenu->addSeparator();
+    runMenu->addAction(traceRecordAction);
+    runMenu->addAction(traceExportAction);
 }
 
 void MainWindow::createThemeMenu()
@@ -309,6 +488,8 @@ void MainWindow::openFile()
             QTextStream in(&file);
             codeEditor->setPlainText(in.readAll());
             file.close();
+            // 提前编译或加载，第一次运行时不用等待
+            executor->prepareCode(codeEditor->toPlainText().trimmed());
             
             // 设置为自定义算法
             currentAlgorithmName = "自定义算法";
@@ -337,12 +518,14 @@ void MainWindow::createNewGrid()
 {
     GridCreateDialog dialog(this);
     if (dialog.exec() == QDialog::Accepted) {
+        stopDebugging();
         gridEditor->createGrid(dialog.getRows(), dialog.getCols());
     }
 }
 
 void MainWindow::clearCurrentGrid()
 {
+    stopDebugging();
     gridEditor->clearGrid();
 }
 
@@ -410,11 +593,13 @@ void MainWindow::saveGridMap()
 
 void MainWindow::loadGridMap()
 {
+    GRIDMAP_TRACE_SCOPE("MainWindow::loadGridMap");
     QString fileName = QFileDialog::getOpenFileName(this,
         tr("读取地图"), "",
         tr("JSON文件 (*.json);;所有文件 (*)"));
 
     if (!fileName.isEmpty()) {
+        stopDebugging();
         if (!gridEditor->loadFromJson(fileName)) {
             QString errorMsg = gridEditor->getLastErrorMessage();
             if (errorMsg.isEmpty()) {
@@ -432,6 +617,7 @@ void MainWindow::showExampleCode()
         QString code = dialog.getSelectedCode();
         if (!code.isEmpty()) {
             codeEditor->setPlainText(code);
+            executor->prepareCode(code.trimmed());
             
             // 根据选择的算法设置标题
             QString algorithm = dialog.getSelectedAlgorithm();
@@ -443,8 +629,18 @@ void MainWindow::showExampleCode()
     }
 }
 
+void MainWindow::selectPluginAlgorithm(PathSearch::AlgorithmType algorithm)
+{
+    codeEditor->setPlainText(PathfindingExecutor::pluginCode(algorithm));
+    
+    QString title = QString("%1 (%2)").arg(PathSearch::algorithmName(algorithm)).arg(tr("插件"));
+    currentAlgorithmName = title;
+    algorithmTitle->setText(title);
+}
+
 void MainWindow::runCode()
 {
+    GRIDMAP_TRACE_SCOPE("MainWindow::runCode");
     // 检查是否有代码
     QString code = codeEditor->toPlainText().trimmed();
     if (code.isEmpty()) {
@@ -458,14 +654,19 @@ void MainWindow::runCode()
         return;
     }
     
-    // 停止之前的执行
+    // 停止之前的执行和调试
     gridEditor->stopExecution();
+    stopDebugging();
+    
+    // 单算法运行时不再叠加竞速结果
+    gridEditor->clearOverlayPaths();
+    gridEditor->clearExpansionHeatmap();
     
     // 进入代码执行模式
     gridEditor->setCodeExecutionMode(true);
     
-    // 获取栅格数据
-    QVector<QVector<int>> gridData = gridEditor->getGridData();
+    // 获取栅格快照
+    const GridSnapshot gridData = gridEditor->snapshot();
     QPoint start = gridEditor->getStartPos();
     QPoint end = gridEditor->getEndPos();
     
@@ -475,6 +676,7 @@ void MainWindow::runCode()
     
     // 执行代码
     executor->executeCode(code, gridData, start, end);
+    executor->prepareReplanning(code, gridData, start, end);
 }
 
 void MainWindow::stopExecution()
@@ -496,6 +698,7 @@ void MainWindow::onAlgorithmTitleChanged()
 
 void MainWindow::updatePathInRealTime()
 {
+    GRIDMAP_TRACE_SCOPE("MainWindow::updatePathInRealTime");
     // 检查是否有有效的起点和终点
     if (!gridEditor->hasValidStartAndEnd()) {
         return;
@@ -510,8 +713,14 @@ void MainWindow::updatePathInRealTime()
     // 记录修改前是否有路径（通过检查当前是否有路径显示）
     hasValidPathBeforeChange = gridEditor->hasPath();
     
-    // 获取最新的栅格数据
-    QVector<QVector<int>> gridData = gridEditor->getGridData();
+    // 小车已经出发：从它当前的位置重新规划，新路线接在走过的路线后面
+    if (gridEditor->isCarEnRoute()) {
+        executor->replanFrom(code, gridEditor->snapshot(), gridEditor->getCarPos(), gridEditor->getEndPos());
+        return;
+    }
+    
+    // 获取最新的栅格快照
+    const GridSnapshot gridData = gridEditor->snapshot();
     QPoint start = gridEditor->getStartPos();
     QPoint end = gridEditor->getEndPos();
     
@@ -540,6 +749,7 @@ void MainWindow::toggleCodeEditor()
 
 void MainWindow::generateRandomObstacles()
 {
+    GRIDMAP_TRACE_SCOPE("MainWindow::generateRandomObstacles");
     // 检查是否有栅格地图
     if (!gridEditor->hasValidStartAndEnd()) {
         QMessageBox::warning(this, tr("生成失败"), 
@@ -550,26 +760,60 @@ void MainWindow::generateRandomObstacles()
     // 显示随机障碍生成对话框
     RandomObstacleDialog dialog(this);
     if (dialog.exec() == QDialog::Accepted) {
+        RandomObstacleDialog::GenerationPattern pattern = dialog.getPattern();
         double density = dialog.getObstacleDensity();
         RandomObstacleDialog::ConnectivityType connectivityType = dialog.getConnectivityType();
         int pathCount = dialog.getPathCount();
         bool useSeed = dialog.isUseSeed();
         int seed = dialog.getSeed();
         
-        // 调用GridEditor的随机生成方法
-        gridEditor->generateRandomObstacles(density, static_cast<int>(connectivityType), pathCount, useSeed, seed);
+        // 迷宫、洞穴、房间走廊由程序化生成器处理，总是保证起点和终点连通
+        if (pattern != RandomObstacleDialog::UniformNoise) {
+            bool connected = gridEditor->generateProceduralMap(static_cast<int>(pattern), density, useSeed, seed);
+            
+            QString message;
+            switch (pattern) {
+                case RandomObstacleDialog::Maze:
+                    message = tr("已生成迷宫");
+                    break;
+                case RandomObstacleDialog::Cave:
+                    message = tr("已生成洞穴地图");
+                    break;
+                default:
+                    message = tr("已生成房间与走廊地图");
+                    break;
+            }
+            if (!connected) {
+                message += tr("\n起点与终点未能连通");
+            }
+            if (useSeed) {
+                message += tr("，使用种子：%1").arg(seed);
+            }
+            
+            QMessageBox::information(this, tr("生成完成"), message);
+            return;
+        }
+        
+        // 调用GridEditor的随机生成方法，返回实际保证的通路数量
+        int guaranteedPaths = gridEditor->generateRandomObstacles(density, static_cast<int>(connectivityType), pathCount, useSeed, seed);
         
         // 提示生成完成
         QString message;
         switch (connectivityType) {
             case RandomObstacleDialog::NoPath:
                 message = tr("已生成随机障碍物（无可通行通路）");
+                if (guaranteedPaths > 0) {
+                    message = tr("已生成随机障碍物\n起点与终点相邻，无法完全阻断通路");
+                }
                 break;
             case RandomObstacleDialog::OnePath:
                 message = tr("已生成随机障碍物（一条可通行通路）");
                 break;
             case RandomObstacleDialog::MultiplePaths:
-                message = tr("已生成随机障碍物（%1条可通行通路）").arg(pathCount);
+                message = tr("已生成随机障碍物（%1条不相交的可通行通路）").arg(guaranteedPaths);
+                if (guaranteedPaths < pathCount) {
+                    message += tr("\n起点或终点位于边界，最多只能保证%1条通路").arg(guaranteedPaths);
+                }
                 break;
         }
         
@@ -579,4 +823,189 @@ void MainWindow::generateRandomObstacles()
         
         QMessageBox::information(this, tr("生成完成"), message);
     }
-} 
\ No newline at end of file
+}
+
+void MainWindow::startRace()
+{
+    GRIDMAP_TRACE_SCOPE("MainWindow::startRace");
+    if (!gridEditor->hasValidStartAndEnd()) {
+        QMessageBox::warning(this, tr("运行错误"), tr("请先创建栅格地图并设置起点和终点！"));
+        return;
+    }
+    
+    // 竞速与小车动画、单步调试互斥：先停止当前执行并清除单条路径的显示
+    stopExecution();
+    stopDebugging();
+    gridEditor->clearPathSilently();
+    gridEditor->clearOverlayPaths();
+    
+    if (!raceDialog) {
+        raceDialog = new RaceResultDialog(this);
+        connect(raceDialog, &RaceResultDialog::overlayCleared, gridEditor, &GridEditor::clearOverlayPaths);
+    }
+    raceDialog->resetRace();
+    raceDialog->show();
+    raceDialog->raise();
+    
+    // 所有算法共用同一份栅格快照
+    race->start(gridEditor->snapshot(), gridEditor->getStartPos(), gridEditor->getEndPos());
+}
+
+void MainWindow::onRaceEngineFinished(const PathfindingRace::EngineResult& result)
+{
+    GRIDMAP_TRACE_SCOPE("MainWindow::onRaceEngineFinished");
+    int slot = PathfindingRace::engines().indexOf(result.algorithm);
+    if (raceDialog) {
+        raceDialog->setEngineResult(slot, result);
+    }
+    
+    // 按参赛顺序重建叠加路径，颜色与结果表一致
+    QList<QList<QPoint>> paths;
+    QList<QColor> colors;
+    const QVector<PathfindingRace::EngineResult>& results = race->results();
+    for (int i = 0; i < results.size(); ++i) {
+        if (!results[i].path.isEmpty()) {
+            paths.append(results[i].path);
+            colors.append(RaceResultDialog::engineColor(i));
+        }
+    }
+    gridEditor->setOverlayPaths(paths, colors);
+}
+
+void MainWindow::exportTrace()
+{
+    // 关闭记录后已有的记录仍然保留，只要缓冲区中有记录就可以导出
+    if (!TraceProfiler::instance().hasRecords()) {
+        QMessageBox::information(this, tr("导出性能跟踪"), tr("还没有性能跟踪记录。请先在“运行”菜单中开启“记录性能跟踪”，操作一段时间后再导出。"));
+        return;
+    }
+    
+    bool ok = false;
+    int seconds = QInputDialog::getInt(this, tr("导出性能跟踪"), tr("导出最近多少秒的记录:"), 10, 1, 3600, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    QString fileName = QFileDialog::getSaveFileName(this, tr("导出性能跟踪"), "trace.json",
+                                                    tr("Chrome Trace 文件 (*.json)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    // 生成的文件可以在 chrome://tracing 或 ui.perfetto.dev 中打开
+    if (!TraceProfiler::instance().save(fileName, qint64(seconds) * 1000000000LL)) {
+        QMessageBox::warning(this, tr("导出失败"), tr("无法写入文件: %1").arg(fileName));
+    }
+}
+
+void MainWindow::startDebugging()
+{
+    GRIDMAP_TRACE_SCOPE("MainWindow::startDebugging");
+    QString code = codeEditor->toPlainText().trimmed();
+    if (code.isEmpty()) {
+        QMessageBox::warning(this, tr("调试错误"), tr("代码编辑器为空！请输入或选择示例代码。"));
+        return;
+    }
+    if (!gridEditor->hasValidStartAndEnd()) {
+        QMessageBox::warning(this, tr("调试错误"), tr("请先创建栅格地图并设置起点和终点！"));
+        return;
+    }
+    
+    // 单步运行的是代码对应的内置算法；插件、寻路规则和用户代码不能在中途暂停
+    // 会交给编译器或解释器运行的代码实际运行的是用户自己的实现，按关键字单步内置算法会调试错误的东西
+    if (executor->runsInSubprocess(code)) {
+        QMessageBox::warning(this, tr("调试错误"),
+            tr("这段代码会被编译或解释运行，实际执行的是代码本身而不是内置算法，不能单步调试。"));
+        return;
+    }
+    PathSearch::AlgorithmType algorithm = PathfindingExecutor::detectAlgorithm(code);
+    if (!SearchDebugger::supports(algorithm)) {
+        QMessageBox::warning(this, tr("调试错误"),
+            tr("单步调试只支持内置算法（A*、Dijkstra、BFS、DFS、D*）。\n"
+               "请确保代码是这些算法之一，插件算法和寻路规则请直接运行。"));
+        return;
+    }
+    
+    // 调试与小车动画、竞速叠加和热力图互斥；先结束上一次调试，开始失败时不会留下可用的单步按钮
+    stopDebugging();
+    stopExecution();
+    gridEditor->clearPathSilently();
+    gridEditor->clearOverlayPaths();
+    gridEditor->clearExpansionHeatmap();
+    gridEditor->clearSearchDebug();
+    
+    if (!debugger.start(algorithm, gridEditor->gridMap(), gridEditor->getStartPos(), gridEditor->getEndPos())) {
+        QMessageBox::warning(this, tr("调试错误"), tr("无法在当前地图上开始单步调试（地图太大或为空）。"));
+        return;
+    }
+    debugStopAction->setEnabled(true);
+    updateDebugView();
+}
+
+void MainWindow::debugStep()
+{
+    debugger.step();
+    updateDebugView();
+}
+
+void MainWindow::debugContinue()
+{
+    debugger.runToBreakpoint(gridEditor->breakpoints());
+    updateDebugView();
+}
+
+void MainWindow::debugRunToEnd()
+{
+    debugger.runToEnd();
+    updateDebugView();
+}
+
+void MainWindow::stopDebugging()
+{
+    if (!debugger.isActive()) {
+        return;
+    }
+    debugger.stop();
+    gridEditor->clearSearchDebug();
+    gridEditor->clearOverlayPaths();
+    debugStepAction->setEnabled(false);
+    debugContinueAction->setEnabled(false);
+    debugFinishAction->setEnabled(false);
+    debugStopAction->setEnabled(false);
+    statusBar()->clearMessage();
+}
+
+void MainWindow::updateDebugView()
+{
+    // 每次暂停只把状态变化的格子交给编辑器重绘
+    gridEditor->updateSearchDebug(debugger, debugger.takeChangedCells());
+    
+    const bool finished = debugger.isFinished();
+    debugStepAction->setEnabled(!finished);
+    debugContinueAction->setEnabled(!finished);
+    debugFinishAction->setEnabled(!finished);
+    
+    const PathSearch::SearchStats& stats = debugger.stats();
+    QString message = tr("单步调试 %1：已扩展 %2 个格子，开放列表 %3 个")
+        .arg(PathSearch::algorithmName(debugger.algorithm()))
+        .arg(stats.nodesExpanded)
+        .arg(debugger.openSize());
+    const QPoint current = debugger.lastExpanded();
+    if (current.x() >= 0) {
+        message += tr("，当前格子 (%1, %2)").arg(current.x()).arg(current.y());
+        if (gridEditor->breakpoints().contains(current)) {
+            message += tr("（断点）");
+        }
+    }
+    
+    if (finished) {
+        const QList<QPoint> path = debugger.path();
+        if (path.isEmpty()) {
+            message += tr("。搜索结束，未找到路径");
+        } else {
+            message += tr("。搜索结束，路径长度 %1").arg(path.size() - 1);
+            gridEditor->setOverlayPaths({ path }, { QColor(0, 0, 255) });
+        }
+    }
+    statusBar()->showMessage(message);
+}
@@ -0,0 +1,149 @@
+#include "../include/mapdatasetgenerator.h"
+#include "../include/obstaclegenerator.h"
+#include <QRandomGenerator>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+MapDatasetGenerator::MapDatasetGenerator(const Options& options)
+    : options(options)
+{
+}
+
+quint64 MapDatasetGenerator::mapSeed(quint64 baseSeed, int index)
+{
+    // splitmix64：相邻的下标也会得到相互独立的种子
+    quint64 z = baseSeed + 0x9E3779B97F4A7C15ULL * (static_cast<quint64>(index) + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+MapFile::MapData MapDatasetGenerator::generateMap(int index, MapRecord* record) const
+{
+    quint64 seed = mapSeed(options.baseSeed, index);
+    const quint32 seedWords[2] = {static_cast<quint32>(seed), static_cast<quint32>(seed >> 32)};
+    QRandomGenerator generator(seedWords, 2);
+
+    // 起点和终点
+    QPoint start(0, 0);
+    QPoint end(options.cols - 1, options.rows - 1);
+    if (options.randomEndpoints && options.rows * options.cols >= 2) {
+        start = QPoint(generator.bounded(options.cols), generator.bounded(options.rows));
+        do {
+            end = QPoint(generator.bounded(options.cols), generator.bounded(options.rows));
+        } while (end == start);
+    }
+
+    ObstacleGenerator obstacleGenerator(options.rows, options.cols, start, end);
+    int guaranteedPaths = 0;
+    if (options.pattern == ObstacleGenerator::UniformNoise) {
+        guaranteedPaths = obstacleGenerator.generate(options.density, options.connectivityType,
+                                                     options.pathCount, &generator);
+    } else {
+        guaranteedPaths = obstacleGenerator.generatePattern(options.pattern, options.density, &generator) ? 1 : 0;
+    }
+
+    MapFile::MapData map;
+    map.rows = options.rows;
+    map.cols = options.cols;
+    map.cells = obstacleGenerator.toCellStates();
+    map.startPos = start;
+    map.endPos = end;
+
+    if (record) {
+        record->index = index;
+        record->seed = seed;
+        record->fileName = QFileInfo(filePathFor(index)).fileName();
+        record->startPos = start;
+        record->endPos = end;
+        record->guaranteedPaths = guaranteedPaths;
+    }
+    return map;
+}
+
+int MapDatasetGenerator::run(const std::function<void(int finished, int total)>& progress)
+{
+    errorMessage.clear();
+
+    if (options.rows <= 0 || options.cols <= 0 || options.count <= 0) {
+        errorMessage = tr("地图尺寸或数量无效");
+        return 0;
+    }
+
+    if (!QDir().mkpath(options.outputDir)) {
+        errorMessage = tr("无法创建输出目录: %1").arg(options.outputDir);
+        return 0;
+    }
+
+    mapRecords = QVector<MapRecord>(options.count);
+
+    QThreadPool pool;
+    if (options.threads > 0) {
+        pool.setMaxThreadCount(options.threads);
+    }
+
+    QAtomicInt finished(0);
+    QAtomicInt written(0);
+
+    // 每个任务只写入自己下标对应的记录，不需要加锁（提前取出数据指针，避免在工作线程中触发分离）
+    MapRecord* records = mapRecords.data();
+    for (int index = 0; index < options.count; ++index) {
+        pool.start([this, index, records, &finished, &written, &progress]() {
+            MapRecord& record = records[index];
+            MapFile::MapData map = generateMap(index, &record);
+
+            // 生成后立即写盘，内存中不保留地图
+            record.written = MapFile::save(filePathFor(index), map);
+            if (record.written) {
+                written.fetchAndAddRelaxed(1);
+            }
+
+            int done = finished.fetchAndAddRelaxed(1) + 1;
+            if (progress) {
+                progress(done, options.count);
+            }
+        });
+    }
+    pool.waitForDone();
+
+    if (!writeManifest()) {
+        errorMessage = tr("无法写入清单文件");
+    } else if (written.loadRelaxed() != options.count) {
+        errorMessage = tr("%1 张地图写入失败").arg(options.count - written.loadRelaxed());
+    }
+    return written.loadRelaxed();
+}
+
+QString MapDatasetGenerator::filePathFor(int index) const
+{
+    return QDir(options.outputDir).filePath(
+        QStringLiteral("%1%2.json").arg(options.filePrefix).arg(index, 6, 10, QLatin1Char('0')));
+}
+
+bool MapDatasetGenerator::writeManifest() const
+{
+    // 清单按下标顺序写出（JSON Lines），记录每张地图的种子与起终点，便于复现
+    QFile file(QDir(options.outputDir).filePath(options.filePrefix + QStringLiteral("manifest.jsonl")));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    for (const MapRecord& record : mapRecords) {
+        QJsonObject line;
+        line["index"] = record.index;
+        line["seed"] = QString::number(record.seed);
+        line["file"] = record.fileName;
+        line["start"] = QJsonObject{{"x", record.startPos.x()}, {"y", record.startPos.y()}};
+        line["end"] = QJsonObject{{"x", record.endPos.x()}, {"y", record.endPos.y()}};
+        line["guaranteedPaths"] = record.guaranteedPaths;
+        line["written"] = record.written;
+        file.write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+        file.write("\n");
+    }
+    return true;
+}
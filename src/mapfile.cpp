@@ -0,0 +1,295 @@
+#include "../include/mapfile.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QFile>
+#include <cstring>
+
+static const int kChunkCells = GridMap::ChunkSize * GridMap::ChunkSize;
+
+static bool fail(QString* errorMessage, const QString& message)
+{
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+    return false;
+}
+
+// 保存起点和终点位置
+static void writePositions(QJsonObject* json, const QPoint& startPos, const QPoint& endPos)
+{
+    if (startPos != QPoint(-1, -1)) {
+        QJsonObject startPosObj;
+        startPosObj["x"] = startPos.x();
+        startPosObj["y"] = startPos.y();
+        (*json)["startPos"] = startPosObj;
+    }
+
+    if (endPos != QPoint(-1, -1)) {
+        QJsonObject endPosObj;
+        endPosObj["x"] = endPos.x();
+        endPosObj["y"] = endPos.y();
+        (*json)["endPos"] = endPosObj;
+    }
+}
+
+// 逐格保存的 "grid"：rows 行，每行 cols 个格子
+static bool readGrid(const QJsonArray& gridData, GridMap* grid, QString* errorMessage)
+{
+    if (gridData.size() != grid->rows()) {
+        return fail(errorMessage, MapFile::tr("网格数据行数与声明不符"));
+    }
+    for (int i = 0; i < grid->rows(); ++i) {
+        QJsonArray rowData = gridData[i].toArray();
+        if (rowData.size() != grid->cols()) {
+            return fail(errorMessage, MapFile::tr("第%1行数据列数与声明不符").arg(i + 1));
+        }
+
+        for (int j = 0; j < grid->cols(); ++j) {
+            int cellValue = rowData[j].toInt();
+            if (cellValue < 0 || cellValue > MapFile::MaxCellValue) {
+                return fail(errorMessage, MapFile::tr("网格数据包含无效值: %1").arg(cellValue));
+            }
+            grid->setCell(j, i, cellValue);
+        }
+    }
+    // 全是障碍的块也只记录一个值
+    grid->compact();
+    return true;
+}
+
+// 按块保存的 "chunks"：整块同一个值的块不展开，有不同取值的块直接作为这一块的存储
+static bool readChunks(const QJsonObject& json, GridMap* grid, QString* errorMessage)
+{
+    const int chunkSize = json["chunkSize"].toInt();
+    if (chunkSize != GridMap::ChunkSize) {
+        return fail(errorMessage, MapFile::tr("不支持的块大小: %1").arg(chunkSize));
+    }
+    const QJsonArray chunks = json["chunks"].toArray();
+    for (const QJsonValue& value : chunks) {
+        const QJsonObject chunk = value.toObject();
+        const int chunkX = chunk["x"].toInt(-1);
+        const int chunkY = chunk["y"].toInt(-1);
+        if (chunkX < 0 || chunkX >= grid->chunkCols() || chunkY < 0 || chunkY >= grid->chunkRows()) {
+            return fail(errorMessage, MapFile::tr("块坐标无效（%1, %2）").arg(chunkX).arg(chunkY));
+        }
+        if (!chunk.contains("cells")) {
+            const int cellValue = chunk["value"].toInt(-1);
+            if (cellValue < 0 || cellValue > MapFile::MaxCellValue) {
+                return fail(errorMessage, MapFile::tr("网格数据包含无效值: %1").arg(cellValue));
+            }
+            grid->setChunk(chunkX, chunkY, cellValue);
+            continue;
+        }
+
+        const QByteArray bytes = qUncompress(QByteArray::fromBase64(chunk["cells"].toString().toLatin1()));
+        if (bytes.size() != kChunkCells) {
+            return fail(errorMessage, MapFile::tr("块（%1, %2）的格子数据无效").arg(chunkX).arg(chunkY));
+        }
+        // 右边和下边的块超出地图的部分不使用，只检查地图内的格子
+        const int width = qMin(GridMap::ChunkSize, grid->cols() - chunkX * GridMap::ChunkSize);
+        const int height = qMin(GridMap::ChunkSize, grid->rows() - chunkY * GridMap::ChunkSize);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const int cellValue = quint8(bytes.at(y * GridMap::ChunkSize + x));
+                if (cellValue > MapFile::MaxCellValue) {
+                    return fail(errorMessage, MapFile::tr("网格数据包含无效值: %1").arg(cellValue));
+                }
+            }
+        }
+        QVector<quint8> cells(kChunkCells);
+        std::memcpy(cells.data(), bytes.constData(), kChunkCells);
+        grid->setChunk(chunkX, chunkY, GridMap::Empty, cells);
+    }
+    return true;
+}
+
+QByteArray MapFile::toJson(const MapData& map)
+{
+    if (qint64(map.rows) * map.cols > MaxDenseCells) {
+        GridData data;
+        data.grid = GridMap::fromCells(map.cells);
+        data.startPos = map.startPos;
+        data.endPos = map.endPos;
+        return toJson(data);
+    }
+
+    QJsonObject json;
+
+    // 保存网格基本信息
+    json["rows"] = map.rows;
+    json["cols"] = map.cols;
+
+    // 保存网格数据
+    QJsonArray gridData;
+    for (int i = 0; i < map.rows; ++i) {
+        QJsonArray rowData;
+        for (int j = 0; j < map.cols; ++j) {
+            rowData.append(map.cells[i][j]);
+        }
+        gridData.append(rowData);
+    }
+    json["grid"] = gridData;
+    writePositions(&json, map.startPos, map.endPos);
+
+    return QJsonDocument(json).toJson();
+}
+
+QByteArray MapFile::toJson(const GridData& map)
+{
+    const GridMap& grid = map.grid;
+    if (qint64(grid.rows()) * grid.cols() <= MaxDenseCells) {
+        MapData data;
+        data.rows = grid.rows();
+        data.cols = grid.cols();
+        data.cells = grid.toCells();
+        data.startPos = map.startPos;
+        data.endPos = map.endPos;
+        return toJson(data);
+    }
+
+    QJsonObject json;
+    json["rows"] = grid.rows();
+    json["cols"] = grid.cols();
+    json["chunkSize"] = GridMap::ChunkSize;
+
+    // 逐块保存，不展开整张地图；空白的块不写
+    QJsonArray chunks;
+    for (int chunkY = 0; chunkY < grid.chunkRows(); ++chunkY) {
+        for (int chunkX = 0; chunkX < grid.chunkCols(); ++chunkX) {
+            QJsonObject chunk;
+            const quint8* cells = grid.chunkData(chunkX, chunkY);
+            if (cells) {
+                const QByteArray bytes(reinterpret_cast<const char*>(cells), kChunkCells);
+                chunk["cells"] = QString::fromLatin1(qCompress(bytes).toBase64());
+            } else if (grid.chunkValue(chunkX, chunkY) != GridMap::Empty) {
+                chunk["value"] = grid.chunkValue(chunkX, chunkY);
+            } else {
+                continue;
+            }
+            chunk["x"] = chunkX;
+            chunk["y"] = chunkY;
+            chunks.append(chunk);
+        }
+    }
+    json["chunks"] = chunks;
+    writePositions(&json, map.startPos, map.endPos);
+
+    return QJsonDocument(json).toJson();
+}
+
+bool MapFile::fromJson(const QByteArray& data, MapData* map, QString* errorMessage)
+{
+    GridData grid;
+    if (!fromJson(data, &grid, errorMessage)) {
+        return false;
+    }
+
+    MapData result;
+    result.rows = grid.grid.rows();
+    result.cols = grid.grid.cols();
+    result.cells = grid.grid.toCells();
+    result.startPos = grid.startPos;
+    result.endPos = grid.endPos;
+    *map = result;
+    return true;
+}
+
+bool MapFile::fromJson(const QByteArray& data, GridData* map, QString* errorMessage)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+
+    if (doc.isNull() || parseError.error != QJsonParseError::NoError) {
+        return fail(errorMessage, tr("无法解析JSON文件: %1").arg(parseError.errorString()));
+    }
+
+    QJsonObject json = doc.object();
+
+    // 验证必要的字段是否存在
+    if (!json.contains("rows") || !json.contains("cols") || !(json.contains("grid") || json.contains("chunks"))) {
+        return fail(errorMessage, tr("JSON文件缺少必要的字段（rows、cols、grid）"));
+    }
+
+    // 读取网格基本信息
+    int newRows = json["rows"].toInt();
+    int newCols = json["cols"].toInt();
+
+    if (newRows <= 0 || newCols <= 0 || newRows > MaxSide || newCols > MaxSide) {
+        return fail(errorMessage, tr("网格尺寸无效（行数: %1, 列数: %2）").arg(newRows).arg(newCols));
+    }
+
+    // 读取网格数据
+    GridData result;
+    result.grid = GridMap(newRows, newCols);
+    const bool ok = json.contains("chunks")
+        ? readChunks(json, &result.grid, errorMessage)
+        : readGrid(json["grid"].toArray(), &result.grid, errorMessage);
+    if (!ok) {
+        return false;
+    }
+
+    // 读取起点和终点位置
+    auto readPos = [&](const char* key) {
+        QJsonObject posObj = json[key].toObject();
+        if (posObj.contains("x") && posObj.contains("y")) {
+            int x = posObj["x"].toInt();
+            int y = posObj["y"].toInt();
+            if (x >= 0 && x < newCols && y >= 0 && y < newRows) {
+                return QPoint(x, y);
+            }
+        }
+        return QPoint(-1, -1);
+    };
+    result.startPos = readPos("startPos");
+    result.endPos = readPos("endPos");
+
+    *map = result;
+    return true;
+}
+
+bool MapFile::save(const QString& filename, const MapData& map)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    return file.write(toJson(map)) >= 0;
+}
+
+bool MapFile::load(const QString& filename, MapData* map, QString* errorMessage)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            errorMessage->clear();
+        }
+        return false;
+    }
+
+    return fromJson(file.readAll(), map, errorMessage);
+}
+
+bool MapFile::save(const QString& filename, const GridData& map)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    return file.write(toJson(map)) >= 0;
+}
+
+bool MapFile::load(const QString& filename, GridData* map, QString* errorMessage)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            errorMessage->clear();
+        }
+        return false;
+    }
+
+    return fromJson(file.readAll(), map, errorMessage);
+}
@@ -0,0 +1,400 @@
+#include "../include/nativecoderunner.h"
+#include "../include/solverworker.h"
+#include "../include/gridmap.h"
+#include "../include/traceprofiler.h"
+#include <QProcess>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+
+// 修改下面的外壳代码时递增版本号，旧的编译缓存随之失效
+static const char kHarnessVersion[] = "gridmap-native-2";
+
+// 追加在用户代码之后编译：映射共享栅格，循环读取请求、调用 findPath，按 SolverWorker 的协议写回结果
+// 用户代码写到标准输出的内容会被重定向到标准错误，不会混进结果通道
+static const char kHarnessSource[] = R"(
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace gridmap_harness {
+struct Request { int32_t magic, command, rows, cols, startX, startY, endX, endY, sequence, payloadBytes; };
+struct ResponseHeader { int32_t magic, sequence, status, length; int64_t setupNs, searchNs; };
+const int32_t kRequestMagic = 0x51524D47;
+const int32_t kResponseMagic = 0x53524D47;
+const int32_t kSolve = 1;
+const int32_t kPathFound = 0, kNoPath = 1, kUserError = 2;
+
+int64_t elapsedNs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+void reply(FILE* channel, ResponseHeader header, const void* payload, size_t bytes)
+{
+    std::fflush(stdout);
+    std::fwrite(&header, sizeof(header), 1, channel);
+    if (bytes > 0) {
+        std::fwrite(payload, 1, bytes, channel);
+    }
+    std::fflush(channel);
+}
+}
+
+int main(int argc, char** argv)
+{
+    using namespace gridmap_harness;
+    if (argc < 3) {
+        return 2;
+    }
+    const size_t capacity = std::strtoull(argv[2], nullptr, 10);
+#ifdef _WIN32
+    HANDLE file = CreateFileA(argv[1], GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, 0, nullptr);
+    HANDLE mapping = file == INVALID_HANDLE_VALUE ? nullptr
+                                                  : CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const unsigned char* cells = mapping ? static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, capacity))
+                                         : nullptr;
+    _setmode(_fileno(stdin), _O_BINARY);
+    const int channelFd = _dup(_fileno(stdout));
+    _setmode(channelFd, _O_BINARY);
+    _dup2(_fileno(stderr), _fileno(stdout));
+    FILE* channel = _fdopen(channelFd, "wb");
+#else
+    const int fd = open(argv[1], O_RDONLY);
+    void* mapped = fd < 0 ? MAP_FAILED : mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+    const unsigned char* cells = mapped == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(mapped);
+    const int channelFd = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    FILE* channel = fdopen(channelFd, "wb");
+#endif
+    if (!cells || !channel) {
+        return 3;
+    }
+
+    Request request;
+    std::vector<std::vector<int>> grid;
+    std::vector<int32_t> points;
+    std::string message;
+    while (std::fread(&request, sizeof(request), 1, stdin) == 1 && request.magic == kRequestMagic) {
+        ResponseHeader header = {kResponseMagic, request.sequence, kNoPath, 0, 0, 0};
+        // 编译后的程序不需要附加数据（加载代码只对解释器有意义）
+        for (int32_t i = 0; i < request.payloadBytes; ++i) {
+            std::fgetc(stdin);
+        }
+        if (request.command != kSolve) {
+            message = "unsupported command";
+            header.status = kUserError;
+            header.length = static_cast<int32_t>(message.size());
+            reply(channel, header, message.data(), message.size());
+            continue;
+        }
+        if (size_t(request.rows) * size_t(request.cols) > capacity) {
+            return 4;
+        }
+
+        auto setupStart = std::chrono::steady_clock::now();
+        grid.assign(request.rows, std::vector<int>(request.cols));
+        for (int row = 0; row < request.rows; ++row) {
+            const unsigned char* line = cells + size_t(row) * request.cols;
+            for (int col = 0; col < request.cols; ++col) {
+                grid[row][col] = line[col];
+            }
+        }
+        header.setupNs = elapsedNs(setupStart);
+
+        points.clear();
+        message.clear();
+        auto searchStart = std::chrono::steady_clock::now();
+        try {
+            GRIDMAP_SOLVER solver(grid);
+            const auto path = solver.findPath(request.startY, request.startX, request.endY, request.endX);
+            for (const auto& point : path) {
+                points.push_back(static_cast<int32_t>(std::get<1>(point)));
+                points.push_back(static_cast<int32_t>(std::get<0>(point)));
+            }
+            header.status = points.empty() ? kNoPath : kPathFound;
+        } catch (const std::exception& e) {
+            message = e.what();
+            header.status = kUserError;
+        } catch (...) {
+            header.status = kUserError;
+        }
+        header.searchNs = elapsedNs(searchStart);
+
+        if (header.status == kUserError) {
+            header.length = static_cast<int32_t>(message.size());
+            reply(channel, header, message.data(), message.size());
+        } else {
+            header.length = static_cast<int32_t>(points.size() / 2);
+            reply(channel, header, points.data(), points.size() * sizeof(int32_t));
+        }
+    }
+    return 0;
+}
+)";
+
+namespace {
+
+// 找出含 findPath 定义的最内层 class / struct，作为求解类
+QString findSolverClass(const QString& code)
+{
+    static const QRegularExpression findPathPattern(QStringLiteral("\\bfindPath\\s*\\(\\s*(const\\s+)?int\\b"));
+    static const QRegularExpression classPattern(QStringLiteral("\\b(?:class|struct)\\s+([A-Za-z_]\\w*)[^;{]*\\{"));
+
+    const QRegularExpressionMatch findPathMatch = findPathPattern.match(code);
+    if (!findPathMatch.hasMatch()) {
+        return QString();
+    }
+    const int target = findPathMatch.capturedStart();
+
+    QString solverClass;
+    int solverSpan = -1;
+    QRegularExpressionMatchIterator it = classPattern.globalMatch(code);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        const int open = match.capturedEnd() - 1;
+        if (open > target) {
+            break;
+        }
+        // 按括号配对找到类体结束位置（不处理注释和字符串中的括号）
+        int depth = 0;
+        int close = -1;
+        for (int i = open; i < code.size(); ++i) {
+            if (code[i] == QLatin1Char('{')) {
+                ++depth;
+            } else if (code[i] == QLatin1Char('}') && --depth == 0) {
+                close = i;
+                break;
+            }
+        }
+        if (close > target && (solverSpan < 0 || close - open < solverSpan)) {
+            solverClass = match.captured(1);
+            solverSpan = close - open;
+        }
+    }
+    return solverClass;
+}
+
+QStringList compilerArguments()
+{
+    QStringList arguments = {QStringLiteral("-std=c++17"), QStringLiteral("-O2")};
+#ifdef Q_OS_WIN
+    // 静态链接运行库，工作进程不依赖 PATH 中的 MinGW 动态库
+    arguments << QStringLiteral("-static");
+#endif
+    return arguments;
+}
+
+} // namespace
+
+NativeCodeRunner::NativeCodeRunner(QObject *parent)
+    : QObject(parent),
+      compiler(findCompiler()),
+      compileProcess(nullptr),
+      worker(new SolverWorker(this))
+{
+    cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty()) {
+        cacheDir = QDir::tempPath() + QStringLiteral("/GridMapEditor");
+    }
+    cacheDir += QStringLiteral("/native");
+    connect(worker, &SolverWorker::finished, this, &NativeCodeRunner::runFinished);
+}
+
+NativeCodeRunner::~NativeCodeRunner()
+{
+    if (compileProcess) {
+        compileProcess->disconnect(this);
+        compileProcess->kill();
+        compileProcess->waitForFinished(1000);
+    }
+}
+
+QString NativeCodeRunner::findCompiler()
+{
+    const QString fromEnvironment = qEnvironmentVariable("CXX");
+    if (!fromEnvironment.isEmpty()) {
+        const QString path = QStandardPaths::findExecutable(fromEnvironment);
+        return path.isEmpty() && QFileInfo(fromEnvironment).isExecutable() ? fromEnvironment : path;
+    }
+    for (const QString& name : {QStringLiteral("c++"), QStringLiteral("g++"), QStringLiteral("clang++")}) {
+        const QString path = QStandardPaths::findExecutable(name);
+        if (!path.isEmpty()) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+bool NativeCodeRunner::hasEntryPoint(const QString& code)
+{
+    return !findSolverClass(code).isEmpty();
+}
+
+QString NativeCodeRunner::sourceHash(const QString& code, QString* solverClass) const
+{
+    *solverClass = findSolverClass(code);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray(kHarnessVersion));
+    hash.addData(compiler.toUtf8());
+    hash.addData(compilerArguments().join(QLatin1Char(' ')).toUtf8());
+    hash.addData(solverClass->toUtf8());
+    hash.addData(code.toUtf8());
+    return QString::fromLatin1(hash.result().toHex().left(32));
+}
+
+QString NativeCodeRunner::binaryPath(const QString& hash) const
+{
+#ifdef Q_OS_WIN
+    return cacheDir + QLatin1Char('/') + hash + QStringLiteral(".exe");
+#else
+    return cacheDir + QLatin1Char('/') + hash;
+#endif
+}
+
+bool NativeCodeRunner::prepare(const QString& code)
+{
+    GRIDMAP_TRACE_SCOPE("NativeCodeRunner::prepare");
+    QString solverClass;
+    const QString hash = sourceHash(code, &solverClass);
+    if (hash == readyHash) {
+        return true;
+    }
+    if (QFileInfo::exists(binaryPath(hash))) {
+        readyHash = hash;
+        return true;
+    }
+    if (compileProcess && compilingHash == hash) {
+        return false;
+    }
+
+    // 代码在编译期间又变了：放弃旧的编译
+    if (compileProcess) {
+        compileProcess->disconnect(this);
+        compileProcess->kill();
+        compileProcess->waitForFinished(1000);
+        compileProcess->deleteLater();
+        compileProcess = nullptr;
+    }
+
+    QDir().mkpath(cacheDir);
+    const QString sourcePath = cacheDir + QLatin1Char('/') + hash + QStringLiteral(".cpp");
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        emit compileFinished(false, tr("无法写入编译缓存目录：%1").arg(cacheDir));
+        return false;
+    }
+    // #line 让编译错误的行号与编辑器中的行号一致；用户自己的 main 改名，避免与外壳冲突
+    source.write("#define main gridmap_user_main\n#line 1 \"code.cpp\"\n");
+    source.write(code.toUtf8());
+    source.write("\n#undef main\n#line 1 \"gridmap_harness.cpp\"\n#define GRIDMAP_SOLVER ");
+    source.write(solverClass.toUtf8());
+    source.write("\n");
+    source.write(kHarnessSource);
+    source.close();
+
+    compilingHash = hash;
+    compileProcess = new QProcess(this);
+    compileProcess->setProcessChannelMode(QProcess::MergedChannels);
+    compileProcess->setWorkingDirectory(cacheDir);
+    connect(compileProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &NativeCodeRunner::onCompileFinished);
+    connect(compileProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            onCompileFinished();
+        }
+    });
+    // 先输出到临时文件，编译成功后再改名，中断的编译不会留下半个可执行文件
+    compileProcess->start(compiler, compilerArguments()
+                                    << QStringLiteral("-o") << binaryPath(hash + QStringLiteral(".part"))
+                                    << sourcePath);
+    return false;
+}
+
+void NativeCodeRunner::onCompileFinished()
+{
+    GRIDMAP_TRACE_SCOPE("NativeCodeRunner::onCompileFinished");
+    QProcess* process = compileProcess;
+    compileProcess = nullptr;
+    if (!process) {
+        return;
+    }
+    process->disconnect(this);
+    process->deleteLater();
+
+    const QString hash = compilingHash;
+    compilingHash.clear();
+    const QString binary = binaryPath(hash);
+    const QString partial = binaryPath(hash + QStringLiteral(".part"));
+    const bool compiled = process->error() != QProcess::FailedToStart
+                          && process->exitStatus() == QProcess::NormalExit
+                          && process->exitCode() == 0;
+    if (compiled) {
+        QFile::remove(binary);
+        if (QFile::rename(partial, binary)) {
+            readyHash = hash;
+            emit compileFinished(true, QString());
+            return;
+        }
+    }
+    QFile::remove(partial);
+
+    if (process->error() == QProcess::FailedToStart) {
+        emit compileFinished(false, tr("无法启动编译器：%1").arg(compiler));
+        return;
+    }
+    // 只保留前面的诊断信息，第一个错误通常最有用
+    QStringList lines = QString::fromLocal8Bit(process->readAll()).split(QLatin1Char('\n'));
+    if (lines.size() > 30) {
+        lines = lines.mid(0, 30);
+        lines << QStringLiteral("...");
+    }
+    emit compileFinished(false, tr("编译失败：\n%1").arg(lines.join(QLatin1Char('\n')).trimmed()));
+}
+
+bool NativeCodeRunner::run(const GridMap& grid,
+                           const QPoint& start,
+                           const QPoint& end,
+                           QString* error)
+{
+    GRIDMAP_TRACE_SCOPE("NativeCodeRunner::run");
+    if (readyHash.isEmpty()) {
+        *error = tr("代码尚未编译！");
+        return false;
+    }
+
+    const qint64 cellCount = qint64(grid.rows()) * grid.cols();
+    if (workerHash != readyHash || worker->needsRestart(cellCount)) {
+        workerHash.clear();
+        if (!worker->start(binaryPath(readyHash), QStringList(), cacheDir + QStringLiteral("/sandbox"),
+                           cellCount, error)) {
+            return false;
+        }
+        workerHash = readyHash;
+    }
+    return worker->solve(grid, start, end, error);
+}
+
+bool NativeCodeRunner::isRunning() const
+{
+    return worker->isBusy();
+}
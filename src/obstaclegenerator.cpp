@@ -0,0 +1,703 @@
+#include "../include/obstaclegenerator.h"
+#include "../include/gridconnectivity.h"
+#include <QRandomGenerator>
+#include <QQueue>
+
+ObstacleGenerator::ObstacleGenerator(int rows, int cols, const QPoint& start, const QPoint& end)
+    : rows(rows), cols(cols), startPos(start), endPos(end),
+      blocked(rows, QVector<bool>(cols, false))
+{
+}
+
+int ObstacleGenerator::generate(double density, int connectivityType, int pathCount, QRandomGenerator* generator)
+{
+    if (rows <= 0 || cols <= 0 || !isInside(startPos) || !isInside(endPos)) {
+        return 0;
+    }
+    
+    // 清除现有障碍物
+    for (int i = 0; i < rows; ++i) {
+        blocked[i].fill(false);
+    }
+    
+    // 计算要生成的障碍物数量
+    int totalCells = rows * cols;
+    int availableCells = totalCells - 2; // 减去起点和终点
+    int targetObstacles = static_cast<int>(availableCells * density);
+    
+    // 根据连通性类型生成障碍物
+    int guaranteedPaths = 0;
+    switch (connectivityType) {
+        case NoPath: // 无可通行通路（起点与终点相邻时无法阻断，仍有一条通路）
+            guaranteedPaths = generateObstaclesWithNoPath(generator, targetObstacles) ? 0 : 1;
+            break;
+        case OnePath: // 一条可通行通路
+            generateObstaclesWithOnePath(generator, targetObstacles);
+            guaranteedPaths = 1;
+            break;
+        case MultiplePaths: // 多条可通行通路
+            guaranteedPaths = generateObstaclesWithMultiplePaths(generator, targetObstacles, pathCount);
+            break;
+    }
+    
+    return guaranteedPaths;
+}
+
+bool ObstacleGenerator::generatePattern(int pattern, double density, QRandomGenerator* generator)
+{
+    if (rows <= 0 || cols <= 0 || !isInside(startPos) || !isInside(endPos)) {
+        return false;
+    }
+    
+    switch (pattern) {
+        case Maze:
+            generateMaze(generator);
+            break;
+        case Cave:
+            generateCave(density, generator);
+            break;
+        case Rooms:
+            generateRooms(density, generator);
+            break;
+        default:
+            return generate(density, OnePath, 1, generator) > 0;
+    }
+    
+    return connectEndpoints();
+}
+
+QVector<QVector<int>> ObstacleGenerator::toCellStates() const
+{
+    QVector<QVector<int>> cells(rows, QVector<int>(cols, 0));
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            cells[i][j] = blocked[i][j] ? 1 : 0;
+        }
+    }
+    if (isInside(startPos)) {
+        cells[startPos.y()][startPos.x()] = 2;
+    }
+    if (isInside(endPos)) {
+        cells[endPos.y()][endPos.x()] = 3;
+    }
+    return cells;
+}
+
+bool ObstacleGenerator::isInside(const QPoint& pos) const
+{
+    return pos.x() >= 0 && pos.x() < cols && pos.y() >= 0 && pos.y() < rows;
+}
+
+bool ObstacleGenerator::generateObstaclesWithNoPath(QRandomGenerator* generator, int targetObstacles)
+{
+    // 第一步：构造一道把起点和终点隔开的障碍墙
+    // 优先使用随机生长区域的边界（形状自然），超出障碍物预算时退回到最小顶点割
+    QVector<QPoint> barrier = randomSeparatingBarrier(generator, targetObstacles);
+    if (barrier.isEmpty()) {
+        GridConnectivity connectivity(blocked, startPos, endPos, 4);
+        if (connectivity.flow() > 0) {
+            const QList<QPoint> cut = connectivity.minimumCut();
+            if (cut.isEmpty()) {
+                // 起点与终点相邻，无法阻断；仍按密度生成障碍物
+                barrier.clear();
+            } else {
+                barrier = QVector<QPoint>(cut.begin(), cut.end());
+            }
+        }
+    }
+    
+    for (const QPoint& pos : barrier) {
+        blocked[pos.y()][pos.x()] = true;
+    }
+    
+    // 第二步：起点和终点已经不连通，再增加障碍物不会重新连通，
+    // 因此剩余障碍物直接从打乱后的位置中取出即可，无需逐个检查连通性
+    QVector<QPoint> availablePositions;
+    availablePositions.reserve(rows * cols);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            QPoint pos(j, i);
+            if (pos != startPos && pos != endPos && !blocked[i][j]) {
+                availablePositions.append(pos);
+            }
+        }
+    }
+    
+    int remaining = qMin(targetObstacles - int(barrier.size()), int(availablePositions.size()));
+    
+    // 只需要打乱前remaining个位置（部分Fisher-Yates）
+    for (int i = 0; i < remaining; ++i) {
+        int j = i + generator->bounded(availablePositions.size() - i);
+        availablePositions.swapItemsAt(i, j);
+        const QPoint& pos = availablePositions[i];
+        blocked[pos.y()][pos.x()] = true;
+    }
+    
+    return !isPathExists(startPos, endPos);
+}
+
+QVector<QPoint> ObstacleGenerator::randomSeparatingBarrier(QRandomGenerator* generator, int budget)
+{
+    // 从起点随机生长一个区域，区域外侧一圈格子（边界）就是一条随机的分隔曲线：
+    // 任何离开区域的四连通路径都必须经过边界格子。
+    // 终点及其相邻格子不允许并入区域，从而保证终点本身不会落在边界上。
+    QVector<QPoint> barrier;
+    if (budget <= 0) {
+        return barrier;
+    }
+    
+    enum Mark : quint8 { Outside = 0, Region = 1, Boundary = 2 };
+    QVector<QVector<quint8>> mark(rows, QVector<quint8>(cols, Outside));
+    QVector<QPoint> frontier;      // 可以并入区域的边界格子
+    int boundaryCount = 0;
+    
+    auto forbidden = [this](const QPoint& pos) {
+        return qAbs(pos.x() - endPos.x()) + qAbs(pos.y() - endPos.y()) <= 1;
+    };
+    
+    const QPoint directions[4] = {QPoint(0, -1), QPoint(1, 0), QPoint(0, 1), QPoint(-1, 0)};
+    
+    // 把一个格子并入区域需要的新增边界数量
+    auto boundaryDelta = [&](const QPoint& pos) {
+        int delta = (mark[pos.y()][pos.x()] == Boundary) ? -1 : 0;
+        for (const QPoint& dir : directions) {
+            QPoint next = pos + dir;
+            if (isInside(next) && mark[next.y()][next.x()] == Outside) {
+                ++delta;
+            }
+        }
+        return delta;
+    };
+    
+    auto addToRegion = [&](const QPoint& pos) {
+        if (mark[pos.y()][pos.x()] == Boundary) {
+            --boundaryCount;
+        }
+        mark[pos.y()][pos.x()] = Region;
+        for (const QPoint& dir : directions) {
+            QPoint next = pos + dir;
+            if (isInside(next) && mark[next.y()][next.x()] == Outside) {
+                mark[next.y()][next.x()] = Boundary;
+                ++boundaryCount;
+                if (!forbidden(next)) {
+                    frontier.append(next);
+                }
+            }
+        }
+    };
+    
+    if (forbidden(startPos) || boundaryDelta(startPos) > budget) {
+        return barrier;
+    }
+    addToRegion(startPos);
+    
+    // 区域的目标大小在可用格子的10%~60%之间随机选取
+    int cellCount = rows * cols;
+    int regionTarget = qMax(1, cellCount / 10 + generator->bounded(qMax(1, cellCount / 2)));
+    int regionSize = 1;
+    
+    while (!frontier.isEmpty() && regionSize < regionTarget) {
+        int index = generator->bounded(frontier.size());
+        QPoint pos = frontier[index];
+        frontier[index] = frontier.last();
+        frontier.removeLast();
+        
+        // 超出预算的格子保留在边界上，不再并入区域
+        if (boundaryCount + boundaryDelta(pos) > budget) {
+            continue;
+        }
+        addToRegion(pos);
+        ++regionSize;
+    }
+    
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            if (mark[i][j] == Boundary) {
+                barrier.append(QPoint(j, i));
+            }
+        }
+    }
+    
+    // 区域与终点之间至少隔着一圈边界格子，因此起点和终点必定被隔开
+    return barrier;
+}
+
+void ObstacleGenerator::generateObstaclesWithOnePath(QRandomGenerator* generator, int targetObstacles)
+{
+    // 首先使用BFS找到一条从起点到终点的路径
+    QList<QPoint> path = findPathBFS(startPos, endPos);
+    if (path.isEmpty()) {
+        return; // 如果找不到路径，直接返回
+    }
+    
+    // 将路径上的点标记为受保护的
+    QVector<QVector<bool>> protectedCells(rows, QVector<bool>(cols, false));
+    for (const QPoint& pos : path) {
+        protectedCells[pos.y()][pos.x()] = true;
+    }
+    
+    // 收集所有可用位置（除了路径上的点）
+    QVector<QPoint> availablePositions;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            QPoint pos(j, i);
+            if (!protectedCells[i][j]) {
+                availablePositions.append(pos);
+            }
+        }
+    }
+    
+    // 随机打乱位置
+    for (int i = availablePositions.size() - 1; i > 0; --i) {
+        int j = generator->bounded(i + 1);
+        availablePositions.swapItemsAt(i, j);
+    }
+    
+    // 逐步添加障碍物，确保起点和终点保持连通
+    GridConnectivity connectivity(blocked, startPos, endPos, 1);
+    int addedObstacles = 0;
+    for (const QPoint& pos : availablePositions) {
+        if (addedObstacles >= targetObstacles) break;
+        
+        // 只有落在当前流路径上的格子才需要修复一次增广路
+        if (connectivity.block(pos) == 1) {
+            blocked[pos.y()][pos.x()] = true;
+            addedObstacles++;
+        } else {
+            // 如果不再连通，撤销这个障碍物
+            connectivity.unblock(pos);
+        }
+    }
+}
+
+int ObstacleGenerator::generateObstaclesWithMultiplePaths(QRandomGenerator* generator, int targetObstacles, int pathCount)
+{
+    // 收集所有可用位置（除了起点和终点）
+    QVector<QPoint> availablePositions;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            QPoint pos(j, i);
+            if (pos != startPos && pos != endPos) {
+                availablePositions.append(pos);
+            }
+        }
+    }
+    
+    // 随机打乱位置
+    for (int i = availablePositions.size() - 1; i > 0; --i) {
+        int j = generator->bounded(i + 1);
+        availablePositions.swapItemsAt(i, j);
+    }
+    
+    // 多维护一条通路，用于判断最终是否多出了通路
+    GridConnectivity connectivity(blocked, startPos, endPos, pathCount + 1);
+    
+    // 起点或终点靠边时，四连通栅格能提供的不相交通路有限
+    pathCount = qMin(pathCount, connectivity.flow());
+    
+    // 逐步添加障碍物，确保至少有指定数量的不相交通路
+    int addedObstacles = 0;
+    for (const QPoint& pos : availablePositions) {
+        if (addedObstacles >= targetObstacles) break;
+        
+        if (connectivity.block(pos) >= pathCount) {
+            blocked[pos.y()][pos.x()] = true;
+            addedObstacles++;
+        } else {
+            // 如果路径数量不足，撤销这个障碍物
+            connectivity.unblock(pos);
+        }
+    }
+    
+    // 通路仍然多于要求时，阻断多余流路径上的格子，直到恰好剩下pathCount条
+    // 删除一个格子最多减少一条通路，因此不会低于pathCount
+    while (connectivity.flow() > pathCount) {
+        QList<QPoint> cells = connectivity.flowCells();
+        if (cells.isEmpty()) {
+            break; // 起点与终点直接相邻，剩余通路无法再被阻断
+        }
+        const QPoint& pos = cells[generator->bounded(cells.size())];
+        connectivity.block(pos);
+        blocked[pos.y()][pos.x()] = true;
+    }
+    
+    return connectivity.flow();
+}
+
+bool ObstacleGenerator::isPathExists(const QPoint& start, const QPoint& end) const
+{
+    if (start == QPoint(-1, -1) || end == QPoint(-1, -1)) {
+        return false;
+    }
+    
+    QVector<QVector<bool>> visited(rows, QVector<bool>(cols, false));
+    QQueue<QPoint> queue;
+    
+    queue.enqueue(start);
+    visited[start.y()][start.x()] = true;
+    
+    // BFS搜索
+    while (!queue.isEmpty()) {
+        QPoint current = queue.dequeue();
+        
+        if (current == end) {
+            return true;
+        }
+        
+        // 检查四个方向
+        QList<QPoint> directions = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+        for (const QPoint& dir : directions) {
+            QPoint next(current.x() + dir.x(), current.y() + dir.y());
+            
+            if (isInside(next) && !visited[next.y()][next.x()]) {
+                // 如果是空格子、起点或终点，就可以通过
+                if (!blocked[next.y()][next.x()] || next == start || next == end) {
+                    visited[next.y()][next.x()] = true;
+                    queue.enqueue(next);
+                }
+            }
+        }
+    }
+    
+    return false;
+}
+
+QList<QPoint> ObstacleGenerator::findPathBFS(const QPoint& start, const QPoint& end) const
+{
+    QList<QPoint> path;
+    if (start == QPoint(-1, -1) || end == QPoint(-1, -1)) {
+        return path;
+    }
+    
+    QVector<QVector<bool>> visited(rows, QVector<bool>(cols, false));
+    QQueue<QPoint> queue;
+    QVector<QVector<QPoint>> parent(rows, QVector<QPoint>(cols, QPoint(-1, -1))); // 用于回溯路径
+    
+    queue.enqueue(start);
+    visited[start.y()][start.x()] = true;
+    
+    while (!queue.isEmpty()) {
+        QPoint current = queue.dequeue();
+        
+        if (current == end) {
+            // 回溯构建路径
+            QPoint pathPoint = end;
+            while (pathPoint != QPoint(-1, -1)) {
+                path.prepend(pathPoint);
+                pathPoint = parent[pathPoint.y()][pathPoint.x()];
+            }
+            return path;
+        }
+        
+        // 检查四个方向
+        QList<QPoint> directions = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+        for (const QPoint& dir : directions) {
+            QPoint next(current.x() + dir.x(), current.y() + dir.y());
+            
+            if (isInside(next) && !visited[next.y()][next.x()]) {
+                if (!blocked[next.y()][next.x()] || next == start || next == end) {
+                    visited[next.y()][next.x()] = true;
+                    queue.enqueue(next);
+                    parent[next.y()][next.x()] = current;
+                }
+            }
+        }
+    }
+    
+    return path; // 返回空路径
+}
+
+QVector<QPair<int, int>> ObstacleGenerator::randomSpanningTree(int width, int height, QRandomGenerator* generator) const
+{
+    QVector<QPair<int, int>> edges;
+    if (width <= 0 || height <= 0) {
+        return edges;
+    }
+    edges.reserve(width * height - 1);
+    
+    QVector<quint8> visited(width * height, 0);
+    QVector<int> stack;
+    int first = generator->bounded(width * height);
+    visited[first] = 1;
+    stack.append(first);
+    
+    while (!stack.isEmpty()) {
+        int current = stack.last();
+        int x = current % width;
+        int y = current / width;
+        
+        // 收集未访问的相邻格子
+        int candidates[4];
+        int candidateCount = 0;
+        if (y > 0 && !visited[current - width]) candidates[candidateCount++] = current - width;
+        if (x + 1 < width && !visited[current + 1]) candidates[candidateCount++] = current + 1;
+        if (y + 1 < height && !visited[current + width]) candidates[candidateCount++] = current + width;
+        if (x > 0 && !visited[current - 1]) candidates[candidateCount++] = current - 1;
+        
+        if (candidateCount == 0) {
+            stack.removeLast(); // 回溯
+            continue;
+        }
+        
+        int next = candidates[generator->bounded(candidateCount)];
+        visited[next] = 1;
+        edges.append(qMakePair(current, next));
+        stack.append(next);
+    }
+    return edges;
+}
+
+void ObstacleGenerator::generateMaze(QRandomGenerator* generator)
+{
+    // 迷宫单元位于奇数坐标 (2i+1, 2j+1)，单元之间的格子为墙
+    int mazeWidth = (cols - 1) / 2;
+    int mazeHeight = (rows - 1) / 2;
+    bool wall = mazeWidth > 0 && mazeHeight > 0;
+    for (int i = 0; i < rows; ++i) {
+        blocked[i].fill(wall);
+    }
+    if (!wall) {
+        return; // 栅格太小，无法容纳迷宫
+    }
+    
+    auto cellPos = [mazeWidth](int cell) {
+        return QPoint(2 * (cell % mazeWidth) + 1, 2 * (cell / mazeWidth) + 1);
+    };
+    
+    for (int cell = 0; cell < mazeWidth * mazeHeight; ++cell) {
+        QPoint pos = cellPos(cell);
+        blocked[pos.y()][pos.x()] = false;
+    }
+    
+    // 生成树的每条边打通两个单元之间的墙
+    const QVector<QPair<int, int>> edges = randomSpanningTree(mazeWidth, mazeHeight, generator);
+    for (const QPair<int, int>& edge : edges) {
+        QPoint a = cellPos(edge.first);
+        QPoint b = cellPos(edge.second);
+        blocked[(a.y() + b.y()) / 2][(a.x() + b.x()) / 2] = false;
+    }
+}
+
+void ObstacleGenerator::generateCave(double density, QRandomGenerator* generator)
+{
+    // 每行按64位字存储，邻居计数用位切片加法器一次处理64个格子
+    const int words = (cols + 63) / 64;
+    const quint64 allWalls = ~0ULL;
+    // 最后一个字中超出列数的位视为墙（与越界格子一致）
+    const quint64 padding = (cols % 64) ? (allWalls << (cols % 64)) : 0ULL;
+    
+    QVector<quint64> current(rows * words, 0);
+    QVector<quint64> next(rows * words, 0);
+    
+    // 初始随机填充：以 density 的概率放置墙
+    const quint64 threshold = static_cast<quint64>(qBound(0.0, density, 1.0) * 4294967296.0);
+    for (int y = 0; y < rows; ++y) {
+        quint64* row = current.data() + y * words;
+        for (int x = 0; x < cols; ++x) {
+            if (generator->generate() < threshold) {
+                row[x >> 6] |= 1ULL << (x & 63);
+            }
+        }
+        row[words - 1] |= padding;
+    }
+    
+    // 取某一行第w个字（行越界时整行视为墙）
+    auto wordAt = [&](const QVector<quint64>& board, int y, int w) -> quint64 {
+        if (y < 0 || y >= rows || w < 0 || w >= words) {
+            return allWalls;
+        }
+        return board[y * words + w];
+    };
+    
+    // 全加器：把一位输入累加到位切片计数器 (s0, s1, s2, s3)
+    auto accumulate = [](quint64 bit, quint64& s0, quint64& s1, quint64& s2, quint64& s3) {
+        quint64 carry0 = s0 & bit;
+        s0 ^= bit;
+        quint64 carry1 = s1 & carry0;
+        s1 ^= carry0;
+        quint64 carry2 = s2 & carry1;
+        s2 ^= carry1;
+        s3 |= carry2;
+    };
+    
+    // 4-5规则：墙的邻居中至少4个是墙则保持，空地的邻居中至少5个是墙则变墙
+    const int iterations = 4;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (int y = 0; y < rows; ++y) {
+            for (int w = 0; w < words; ++w) {
+                quint64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    quint64 middle = wordAt(current, y + dy, w);
+                    quint64 left = (middle << 1) | (wordAt(current, y + dy, w - 1) >> 63);
+                    quint64 right = (middle >> 1) | (wordAt(current, y + dy, w + 1) << 63);
+                    accumulate(left, s0, s1, s2, s3);
+                    accumulate(right, s0, s1, s2, s3);
+                    if (dy != 0) {
+                        accumulate(middle, s0, s1, s2, s3);
+                    }
+                }
+                quint64 atLeast4 = s2 | s3;
+                quint64 atLeast5 = s3 | (s2 & (s1 | s0));
+                quint64 self = current[y * words + w];
+                next[y * words + w] = atLeast5 | (self & atLeast4);
+            }
+            next[y * words + words - 1] |= padding;
+        }
+        current.swap(next);
+    }
+    
+    for (int y = 0; y < rows; ++y) {
+        const quint64* row = current.constData() + y * words;
+        for (int x = 0; x < cols; ++x) {
+            blocked[y][x] = (row[x >> 6] >> (x & 63)) & 1ULL;
+        }
+    }
+}
+
+void ObstacleGenerator::generateRooms(double density, QRandomGenerator* generator)
+{
+    // 把栅格划分成若干区块，每个区块放一个房间；区块之间的随机生成树决定走廊，
+    // 因此所有房间连通，且总工作量与格子数量成正比
+    const int blockSize = 12;
+    int blocksX = qMax(1, cols / blockSize);
+    int blocksY = qMax(1, rows / blockSize);
+    
+    for (int i = 0; i < rows; ++i) {
+        blocked[i].fill(true);
+    }
+    
+    QVector<QPoint> centers(blocksX * blocksY);
+    for (int by = 0; by < blocksY; ++by) {
+        int y0 = by * rows / blocksY;
+        int y1 = (by + 1) * rows / blocksY;
+        for (int bx = 0; bx < blocksX; ++bx) {
+            int x0 = bx * cols / blocksX;
+            int x1 = (bx + 1) * cols / blocksX;
+            
+            // 房间四周至少留出一格墙
+            int availableWidth = qMax(1, x1 - x0 - 2);
+            int availableHeight = qMax(1, y1 - y0 - 2);
+            int roomWidth = qMin(availableWidth, 2 + generator->bounded(qMax(1, availableWidth - 1)));
+            int roomHeight = qMin(availableHeight, 2 + generator->bounded(qMax(1, availableHeight - 1)));
+            int roomX = qMin(cols - 1, x0 + 1 + generator->bounded(availableWidth - roomWidth + 1));
+            int roomY = qMin(rows - 1, y0 + 1 + generator->bounded(availableHeight - roomHeight + 1));
+            
+            for (int y = roomY; y < qMin(rows, roomY + roomHeight); ++y) {
+                for (int x = roomX; x < qMin(cols, roomX + roomWidth); ++x) {
+                    blocked[y][x] = false;
+                }
+            }
+            centers[by * blocksX + bx] = QPoint(qMin(cols - 1, roomX + roomWidth / 2),
+                                                qMin(rows - 1, roomY + roomHeight / 2));
+        }
+    }
+    
+    // 生成树上的走廊保证连通
+    QVector<QVector<bool>> linked(blocksX * blocksY, QVector<bool>(2, false)); // [区块][0-右侧 1-下方]
+    const QVector<QPair<int, int>> edges = randomSpanningTree(blocksX, blocksY, generator);
+    for (const QPair<int, int>& edge : edges) {
+        int a = qMin(edge.first, edge.second);
+        int b = qMax(edge.first, edge.second);
+        linked[a][b == a + 1 ? 0 : 1] = true;
+        carveCorridor(centers[a], centers[b], generator->bounded(2) == 0);
+    }
+    
+    // 密度越低，额外的环路走廊越多
+    const quint32 loopThreshold = static_cast<quint32>((1.0 - qBound(0.0, density, 1.0)) * 0.3 * 4294967295.0);
+    for (int block = 0; block < blocksX * blocksY; ++block) {
+        int bx = block % blocksX;
+        int by = block / blocksX;
+        if (bx + 1 < blocksX && !linked[block][0] && generator->generate() < loopThreshold) {
+            carveCorridor(centers[block], centers[block + 1], generator->bounded(2) == 0);
+        }
+        if (by + 1 < blocksY && !linked[block][1] && generator->generate() < loopThreshold) {
+            carveCorridor(centers[block], centers[block + blocksX], generator->bounded(2) == 0);
+        }
+    }
+}
+
+void ObstacleGenerator::carveCorridor(const QPoint& from, const QPoint& to, bool horizontalFirst)
+{
+    // L形走廊：先水平后竖直，或者反过来
+    QPoint corner = horizontalFirst ? QPoint(to.x(), from.y()) : QPoint(from.x(), to.y());
+    auto carveLine = [this](const QPoint& a, const QPoint& b) {
+        int stepX = (b.x() > a.x()) - (b.x() < a.x());
+        int stepY = (b.y() > a.y()) - (b.y() < a.y());
+        QPoint pos = a;
+        blocked[pos.y()][pos.x()] = false;
+        while (pos != b) {
+            pos += QPoint(stepX, stepY);
+            blocked[pos.y()][pos.x()] = false;
+        }
+    };
+    carveLine(from, corner);
+    carveLine(corner, to);
+}
+
+bool ObstacleGenerator::connectEndpoints()
+{
+    blocked[startPos.y()][startPos.x()] = false;
+    blocked[endPos.y()][endPos.x()] = false;
+    
+    const int cellCount = rows * cols;
+    const int startCell = startPos.y() * cols + startPos.x();
+    const int endCell = endPos.y() * cols + endPos.x();
+    
+    // 拍平成一维数组，大地图上的两遍BFS只做下标运算
+    QVector<quint8> open(cellCount);
+    for (int y = 0; y < rows; ++y) {
+        const QVector<bool>& row = blocked[y];
+        for (int x = 0; x < cols; ++x) {
+            open[y * cols + x] = !row[x];
+        }
+    }
+    
+    // 第一遍：标记起点所在的连通区域
+    QVector<quint8> reached(cellCount, 0);
+    QVector<int> queue;
+    queue.reserve(cellCount);
+    queue.append(startCell);
+    reached[startCell] = 1;
+    for (int head = 0; head < queue.size(); ++head) {
+        int cell = queue[head];
+        int x = cell % cols;
+        int y = cell / cols;
+        const int neighbors[4] = {y > 0 ? cell - cols : -1, x + 1 < cols ? cell + 1 : -1,
+                                  y + 1 < rows ? cell + cols : -1, x > 0 ? cell - 1 : -1};
+        for (int next : neighbors) {
+            if (next >= 0 && !reached[next] && open[next]) {
+                reached[next] = 1;
+                queue.append(next);
+            }
+        }
+    }
+    if (reached[endCell]) {
+        return true;
+    }
+    
+    // 第二遍：从终点出发无视障碍做BFS，找到最近的可达格子后打通沿途的障碍
+    QVector<int> parent(cellCount, -1);
+    queue.clear();
+    queue.append(endCell);
+    parent[endCell] = endCell;
+    for (int head = 0; head < queue.size(); ++head) {
+        int cell = queue[head];
+        if (reached[cell]) {
+            for (int c = cell; c != endCell; c = parent[c]) {
+                blocked[c / cols][c % cols] = false;
+            }
+            return true;
+        }
+        int x = cell % cols;
+        int y = cell / cols;
+        const int neighbors[4] = {y > 0 ? cell - cols : -1, x + 1 < cols ? cell + 1 : -1,
+                                  y + 1 < rows ? cell + cols : -1, x > 0 ? cell - 1 : -1};
+        for (int next : neighbors) {
+            if (next >= 0 && parent[next] < 0) {
+                parent[next] = cell;
+                queue.append(next);
+            }
+        }
+    }
+    return false;
+}
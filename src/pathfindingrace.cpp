@@ -0,0 +1,73 @@
+#include "../include/pathfindingrace.h"
+#include "../include/algorithmplugins.h"
+#include <QElapsedTimer>
+#include <QMetaObject>
+
+PathfindingRace::PathfindingRace(QObject *parent)
+    : QObject(parent), currentRaceId(0), pendingEngines(0)
+{
+    pool.setMaxThreadCount(qMax(pool.maxThreadCount(), static_cast<int>(engines().size())));
+}
+
+PathfindingRace::~PathfindingRace()
+{
+    // 先等待所有任务结束，避免工作线程向正在析构的对象投递结果
+    pool.waitForDone();
+}
+
+QList<PathSearch::AlgorithmType> PathfindingRace::engines()
+{
+    // 内置算法之后是启动时加载的插件算法
+    return QList<PathSearch::AlgorithmType>{PathSearch::AStar, PathSearch::Dijkstra, PathSearch::BFS,
+                                            PathSearch::DFS, PathSearch::DStar}
+           + AlgorithmPlugins::instance().algorithms();
+}
+
+void PathfindingRace::start(const GridSnapshot& grid, const QPoint& start, const QPoint& end)
+{
+    const QList<PathSearch::AlgorithmType> algorithms = engines();
+    
+    ++currentRaceId;
+    pendingEngines = algorithms.size();
+    engineResults = QVector<EngineResult>(algorithms.size());
+    
+    for (int slot = 0; slot < algorithms.size(); ++slot) {
+        engineResults[slot].algorithm = algorithms[slot];
+        
+        // 快照按值捕获：与编辑器共享格子块，各线程只读，编辑器之后写入也不影响正在运行的算法
+        int raceId = currentRaceId;
+        PathSearch::AlgorithmType algorithm = algorithms[slot];
+        pool.start([this, raceId, slot, algorithm, grid, start, end]() {
+            EngineResult result;
+            result.algorithm = algorithm;
+            
+            QElapsedTimer timer;
+            timer.start();
+            try {
+                result.path = PathSearch::runAlgorithm(algorithm, grid, start, end, &result.stats);
+            } catch (...) {
+                result.path.clear();
+            }
+            result.wallTimeNs = timer.nsecsElapsed();
+            
+            QMetaObject::invokeMethod(this, [this, raceId, slot, result]() {
+                deliverResult(raceId, slot, result);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void PathfindingRace::deliverResult(int raceId, int slot, const EngineResult& result)
+{
+    // 已被新一轮竞速取代的结果直接丢弃
+    if (raceId != currentRaceId) {
+        return;
+    }
+    
+    engineResults[slot] = result;
+    emit engineFinished(result);
+    
+    if (--pendingEngines == 0) {
+        emit raceFinished();
+    }
+}
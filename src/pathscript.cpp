@@ -0,0 +1,789 @@
+#include "../include/pathscript.h"
+#include "../include/gridmap.h"
+#include "../include/traceprofiler.h"
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const char* const kVariableNames[PathScript::VariableCount] = {
+    "g", "h", "x", "y", "px", "py", "sx", "sy", "ex", "ey",
+    "dx", "dy", "depth", "turn", "walls", "rows", "cols"
+};
+
+const char* const kRuleNames[] = { "heuristic", "cost", "priority", "tie" };
+const char* const kRuleDefaults[] = { "0", "1", "g + h", "0" };
+
+const char* const kOpNames[] = {
+    "add", "sub", "mul", "div", "neg", "abs", "min", "max", "sqrt",
+    "lt", "le", "gt", "ge", "eq", "ne", "select"
+};
+
+// 一条指令的运算，虚拟机和常量折叠共用
+inline double applyOp(quint8 op, double a, double b, double c)
+{
+    switch (op) {
+        case PathScript::OpAdd: return a + b;
+        case PathScript::OpSub: return a - b;
+        case PathScript::OpMul: return a * b;
+        case PathScript::OpDiv: return a / b;
+        case PathScript::OpNeg: return -a;
+        case PathScript::OpAbs: return std::fabs(a);
+        case PathScript::OpMin: return a < b ? a : b;
+        case PathScript::OpMax: return a > b ? a : b;
+        case PathScript::OpSqrt: return std::sqrt(a);
+        case PathScript::OpLess: return a < b ? 1.0 : 0.0;
+        case PathScript::OpLessEqual: return a <= b ? 1.0 : 0.0;
+        case PathScript::OpGreater: return a > b ? 1.0 : 0.0;
+        case PathScript::OpGreaterEqual: return a >= b ? 1.0 : 0.0;
+        case PathScript::OpEqual: return a == b ? 1.0 : 0.0;
+        case PathScript::OpNotEqual: return a != b ? 1.0 : 0.0;
+        case PathScript::OpSelect: return a != 0.0 ? b : c;
+        default: return 0.0;
+    }
+}
+
+// 去掉 # 或 // 开始的注释
+QString stripComment(const QString& line)
+{
+    int end = line.indexOf(QLatin1Char('#'));
+    const int slashes = line.indexOf(QStringLiteral("//"));
+    if (slashes >= 0 && (end < 0 || slashes < end)) {
+        end = slashes;
+    }
+    return end < 0 ? line : line.left(end);
+}
+
+const QRegularExpression& statementPattern()
+{
+    static const QRegularExpression pattern(QStringLiteral("^\\s*([A-Za-z_]\\w*)\\s*=(?!=)(.*)$"));
+    return pattern;
+}
+
+int ruleIndex(const QString& name)
+{
+    for (int i = 0; i < int(sizeof(kRuleNames) / sizeof(kRuleNames[0])); ++i) {
+        if (name == QLatin1String(kRuleNames[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+struct OpenEntry {
+    double priority;
+    double tie;
+    qint64 sequence;      // 后进先出时取负数，比较方式不变
+    double g;
+    int node;
+};
+
+// 堆顶是 priority、tie、sequence 依次最小的条目
+struct OpenEntryAfter {
+    bool operator()(const OpenEntry& a, const OpenEntry& b) const
+    {
+        if (a.priority != b.priority) {
+            return a.priority > b.priority;
+        }
+        if (a.tie != b.tie) {
+            return a.tie > b.tie;
+        }
+        return a.sequence > b.sequence;
+    }
+};
+
+} // namespace
+
+// 递归下降解析，表达式先建成语法树（折叠常量），全部规则解析完后再分配寄存器生成字节码
+class PathScriptCompiler
+{
+    Q_DECLARE_TR_FUNCTIONS(PathScript)
+
+public:
+    explicit PathScriptCompiler(PathScript& script) : script(script) {}
+
+    bool compile(const QString& source, QString* error);
+
+private:
+    struct Node {
+        enum Kind { Number, Variable, Operation } kind = Number;
+        quint8 op = 0;
+        double value = 0;
+        int variable = 0;
+        int operands[3] = { -1, -1, -1 };
+        int operandCount = 0;
+    };
+
+    PathScript& script;
+    QVector<Node> nodes;
+    int roots[PathScript::RuleCount];
+
+    // 当前解析的表达式
+    QString text;
+    int pos = 0;
+    int rule = 0;
+    QString message;
+
+    int number(double value);
+    int operation(quint8 op, int a, int b = -1, int c = -1);
+    bool fail(const QString& error);
+
+    void skipSpaces();
+    bool accept(const char* token);
+    int parseExpression();
+    int parseComparison();
+    int parseAdditive();
+    int parseTerm();
+    int parseUnary();
+    int parsePrimary();
+    bool parseRule(int ruleIndex, const QString& expression);
+
+    int constantIndex(double value) const;
+    int generate(int node, int* nextTemp);
+};
+
+int PathScriptCompiler::constantIndex(double value) const
+{
+    // NaN 不等于自身（例如折叠后的 0 / 0），按位比较
+    for (int i = 0; i < script.constants.size(); ++i) {
+        if (std::memcmp(&script.constants[i], &value, sizeof(double)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool PathScriptCompiler::fail(const QString& error)
+{
+    if (message.isEmpty()) {
+        message = error;
+    }
+    return false;
+}
+
+int PathScriptCompiler::number(double value)
+{
+    Node node;
+    node.kind = Node::Number;
+    node.value = value;
+    nodes.append(node);
+    return nodes.size() - 1;
+}
+
+int PathScriptCompiler::operation(quint8 op, int a, int b, int c)
+{
+    const int operandCount = op == PathScript::OpSelect ? 3
+                           : (op == PathScript::OpNeg || op == PathScript::OpAbs || op == PathScript::OpSqrt) ? 1 : 2;
+    const int operands[3] = { a, b, c };
+    Node node;
+    node.kind = Node::Operation;
+    node.op = op;
+    node.operandCount = operandCount;
+    bool constant = true;
+    for (int i = 0; i < operandCount; ++i) {
+        // 操作数解析失败时错误已经记录
+        if (operands[i] < 0) {
+            return -1;
+        }
+        node.operands[i] = operands[i];
+        constant = constant && nodes[operands[i]].kind == Node::Number;
+    }
+    if (constant) {
+        // 常量折叠
+        auto value = [this, &node](int i) { return i < node.operandCount ? nodes[node.operands[i]].value : 0.0; };
+        return number(applyOp(op, value(0), value(1), value(2)));
+    }
+    nodes.append(node);
+    return nodes.size() - 1;
+}
+
+void PathScriptCompiler::skipSpaces()
+{
+    while (pos < text.size() && text[pos].isSpace()) {
+        ++pos;
+    }
+}
+
+bool PathScriptCompiler::accept(const char* token)
+{
+    skipSpaces();
+    const QLatin1String expected(token);
+    if (QStringView(text).mid(pos).startsWith(expected)) {
+        pos += expected.size();
+        return true;
+    }
+    return false;
+}
+
+int PathScriptCompiler::parseExpression()
+{
+    const int condition = parseComparison();
+    if (condition < 0 || !accept("?")) {
+        return condition;
+    }
+    const int whenTrue = parseExpression();
+    if (whenTrue < 0) {
+        return -1;
+    }
+    if (!accept(":")) {
+        fail(tr("条件表达式缺少 :"));
+        return -1;
+    }
+    const int whenFalse = parseExpression();
+    return whenFalse < 0 ? -1 : operation(PathScript::OpSelect, condition, whenTrue, whenFalse);
+}
+
+int PathScriptCompiler::parseComparison()
+{
+    const int left = parseAdditive();
+    if (left < 0) {
+        return -1;
+    }
+    // 两个字符的运算符先匹配
+    static const struct { const char* token; quint8 op; } comparisons[] = {
+        { "<=", PathScript::OpLessEqual }, { ">=", PathScript::OpGreaterEqual },
+        { "==", PathScript::OpEqual }, { "!=", PathScript::OpNotEqual },
+        { "<", PathScript::OpLess }, { ">", PathScript::OpGreater }
+    };
+    for (const auto& comparison : comparisons) {
+        if (accept(comparison.token)) {
+            const int right = parseAdditive();
+            return right < 0 ? -1 : operation(comparison.op, left, right);
+        }
+    }
+    return left;
+}
+
+int PathScriptCompiler::parseAdditive()
+{
+    int left = parseTerm();
+    while (left >= 0) {
+        if (accept("+")) {
+            left = operation(PathScript::OpAdd, left, parseTerm());
+        } else if (accept("-")) {
+            left = operation(PathScript::OpSub, left, parseTerm());
+        } else {
+            break;
+        }
+    }
+    return left;
+}
+
+int PathScriptCompiler::parseTerm()
+{
+    int left = parseUnary();
+    while (left >= 0) {
+        if (accept("*")) {
+            left = operation(PathScript::OpMul, left, parseUnary());
+        } else if (accept("/")) {
+            left = operation(PathScript::OpDiv, left, parseUnary());
+        } else {
+            break;
+        }
+    }
+    return left;
+}
+
+int PathScriptCompiler::parseUnary()
+{
+    if (accept("-")) {
+        return operation(PathScript::OpNeg, parseUnary());
+    }
+    if (accept("+")) {
+        return parseUnary();
+    }
+    return parsePrimary();
+}
+
+int PathScriptCompiler::parsePrimary()
+{
+    skipSpaces();
+    if (pos >= text.size()) {
+        fail(tr("表达式不完整"));
+        return -1;
+    }
+
+    if (accept("(")) {
+        const int inner = parseExpression();
+        if (inner >= 0 && !accept(")")) {
+            fail(tr("缺少 )"));
+            return -1;
+        }
+        return inner;
+    }
+
+    const QChar first = text[pos];
+    if (first.isDigit() || first == QLatin1Char('.')) {
+        int end = pos;
+        while (end < text.size() && (text[end].isDigit() || text[end] == QLatin1Char('.'))) {
+            ++end;
+        }
+        bool ok = false;
+        const double value = text.mid(pos, end - pos).toDouble(&ok);
+        if (!ok) {
+            fail(tr("无效的数字 %1").arg(text.mid(pos, end - pos)));
+            return -1;
+        }
+        pos = end;
+        return number(value);
+    }
+
+    if (!first.isLetter() && first != QLatin1Char('_')) {
+        fail(tr("无法识别的符号 %1").arg(first));
+        return -1;
+    }
+    int end = pos;
+    while (end < text.size() && (text[end].isLetterOrNumber() || text[end] == QLatin1Char('_'))) {
+        ++end;
+    }
+    const QString name = text.mid(pos, end - pos);
+    pos = end;
+
+    // 函数调用
+    static const struct { const char* name; quint8 op; int arguments; } functions[] = {
+        { "abs", PathScript::OpAbs, 1 }, { "sqrt", PathScript::OpSqrt, 1 },
+        { "min", PathScript::OpMin, 2 }, { "max", PathScript::OpMax, 2 }
+    };
+    for (const auto& function : functions) {
+        if (name != QLatin1String(function.name)) {
+            continue;
+        }
+        if (!accept("(")) {
+            fail(tr("%1 后缺少 (").arg(name));
+            return -1;
+        }
+        int arguments[2] = { -1, -1 };
+        for (int i = 0; i < function.arguments; ++i) {
+            if (i > 0 && !accept(",")) {
+                fail(tr("%1 需要 %2 个参数").arg(name).arg(function.arguments));
+                return -1;
+            }
+            arguments[i] = parseExpression();
+            if (arguments[i] < 0) {
+                return -1;
+            }
+        }
+        if (!accept(")")) {
+            fail(tr("%1 需要 %2 个参数").arg(name).arg(function.arguments));
+            return -1;
+        }
+        return operation(function.op, arguments[0], arguments[1]);
+    }
+
+    for (int variable = 0; variable < PathScript::VariableCount; ++variable) {
+        if (name != QLatin1String(kVariableNames[variable])) {
+            continue;
+        }
+        // h 是 heuristic 的结果，只有之后计算的规则能使用
+        if (variable == PathScript::VarH && rule != PathScript::RulePriority && rule != PathScript::RuleTie) {
+            fail(tr("%1 中不能使用 h").arg(QLatin1String(kRuleNames[rule])));
+            return -1;
+        }
+        script.usedVariables |= 1u << variable;
+        Node node;
+        node.kind = Node::Variable;
+        node.variable = variable;
+        nodes.append(node);
+        return nodes.size() - 1;
+    }
+
+    fail(tr("未知的变量 %1").arg(name));
+    return -1;
+}
+
+bool PathScriptCompiler::parseRule(int ruleIndex, const QString& expression)
+{
+    text = expression;
+    pos = 0;
+    rule = ruleIndex;
+    roots[ruleIndex] = parseExpression();
+    if (roots[ruleIndex] < 0) {
+        return false;
+    }
+    skipSpaces();
+    if (pos < text.size()) {
+        return fail(tr("多余的内容 %1").arg(text.mid(pos).trimmed()));
+    }
+    return true;
+}
+
+int PathScriptCompiler::generate(int index, int* nextTemp)
+{
+    const Node& node = nodes[index];
+    if (node.kind == Node::Variable) {
+        return node.variable;
+    }
+    if (node.kind == Node::Number) {
+        return PathScript::VariableCount + constantIndex(node.value);
+    }
+
+    // 子表达式的临时寄存器在本条指令之后就不再需要，结果可以复用第一个临时寄存器
+    const int base = *nextTemp;
+    int operands[3] = { 0, 0, 0 };
+    for (int i = 0; i < node.operandCount; ++i) {
+        operands[i] = generate(node.operands[i], nextTemp);
+        if (operands[i] < 0) {
+            return -1;
+        }
+    }
+    *nextTemp = base;
+    if (base >= PathScript::kRegisterCount) {
+        fail(tr("表达式过于复杂"));
+        return -1;
+    }
+    ++*nextTemp;
+
+    PathScript::Instruction instruction;
+    instruction.op = node.op;
+    instruction.dst = quint8(base);
+    instruction.a = quint8(operands[0]);
+    instruction.b = quint8(operands[1]);
+    instruction.c = quint8(operands[2]);
+    script.instructions.append(instruction);
+    return base;
+}
+
+bool PathScriptCompiler::compile(const QString& source, QString* error)
+{
+    for (int i = 0; i < PathScript::RuleCount; ++i) {
+        roots[i] = -1;
+        script.rules[i] = PathScript::Expression();
+    }
+
+    const QStringList lines = source.split(QLatin1Char('\n'));
+    for (int lineNumber = 1; lineNumber <= lines.size(); ++lineNumber) {
+        const QString line = stripComment(lines[lineNumber - 1]);
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+        auto lineError = [&](const QString& text) {
+            *error = tr("第 %1 行：%2").arg(lineNumber).arg(text);
+            return false;
+        };
+
+        const QRegularExpressionMatch match = statementPattern().match(line);
+        if (!match.hasMatch()) {
+            return lineError(tr("应为 名称 = 表达式"));
+        }
+        const QString name = match.captured(1);
+        const QString value = match.captured(2).trimmed();
+        if (name == QLatin1String("order")) {
+            if (value != QLatin1String("fifo") && value != QLatin1String("lifo")) {
+                return lineError(tr("order 只能是 fifo 或 lifo"));
+            }
+            script.lifo = value == QLatin1String("lifo");
+            continue;
+        }
+
+        const int index = ruleIndex(name);
+        if (index < 0) {
+            return lineError(tr("未知的规则 %1（可用 heuristic、cost、priority、tie、order）").arg(name));
+        }
+        if (roots[index] >= 0) {
+            return lineError(tr("%1 重复定义").arg(name));
+        }
+        script.rules[index].line = lineNumber;
+        if (!parseRule(index, value)) {
+            return lineError(message);
+        }
+    }
+
+    for (int i = 0; i < PathScript::RuleCount; ++i) {
+        if (roots[i] < 0 && !parseRule(i, QLatin1String(kRuleDefaults[i]))) {
+            *error = message;
+            return false;
+        }
+    }
+
+    // 常量寄存器紧跟变量寄存器，临时寄存器在常量之后
+    for (const Node& node : nodes) {
+        if (node.kind == Node::Number && constantIndex(node.value) < 0) {
+            script.constants.append(node.value);
+        }
+    }
+    const int firstTemp = PathScript::VariableCount + script.constants.size();
+    if (firstTemp >= PathScript::kRegisterCount) {
+        *error = tr("常量过多");
+        return false;
+    }
+    for (int i = 0; i < PathScript::RuleCount; ++i) {
+        int nextTemp = firstTemp;
+        script.rules[i].begin = script.instructions.size();
+        script.rules[i].result = generate(roots[i], &nextTemp);
+        script.rules[i].end = script.instructions.size();
+        if (script.rules[i].result < 0) {
+            *error = script.rules[i].line > 0 ? tr("第 %1 行：%2").arg(script.rules[i].line).arg(message) : message;
+            return false;
+        }
+    }
+    return true;
+}
+
+PathScript::PathScript()
+    : lifo(false), usedVariables(0), valid(false)
+{
+}
+
+bool PathScript::looksLikeScript(const QString& code)
+{
+    bool hasRule = false;
+    for (const QString& rawLine : code.split(QLatin1Char('\n'))) {
+        const QString line = stripComment(rawLine);
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+        const QRegularExpressionMatch match = statementPattern().match(line);
+        if (!match.hasMatch()) {
+            return false;
+        }
+        hasRule = hasRule || ruleIndex(match.captured(1)) >= 0 || match.captured(1) == QLatin1String("order");
+    }
+    return hasRule;
+}
+
+bool PathScript::compile(const QString& source, QString* error)
+{
+    GRIDMAP_TRACE_SCOPE("PathScript::compile");
+    instructions.clear();
+    constants.clear();
+    lifo = false;
+    usedVariables = 0;
+    PathScriptCompiler compiler(*this);
+    valid = compiler.compile(source, error);
+    if (!valid) {
+        instructions.clear();
+        constants.clear();
+    }
+    return valid;
+}
+
+QString PathScript::disassemble() const
+{
+    QString text;
+    auto registerName = [this](int index) {
+        if (index < VariableCount) {
+            return QString::fromLatin1(kVariableNames[index]);
+        }
+        if (index < VariableCount + constants.size()) {
+            return QString::number(constants[index - VariableCount]);
+        }
+        return QStringLiteral("r%1").arg(index);
+    };
+    for (int i = 0; i < RuleCount; ++i) {
+        text += QStringLiteral("%1:\n").arg(QLatin1String(kRuleNames[i]));
+        for (int pc = rules[i].begin; pc < rules[i].end; ++pc) {
+            const Instruction& instruction = instructions[pc];
+            const int operandCount = instruction.op == OpSelect ? 3
+                                   : (instruction.op == OpNeg || instruction.op == OpAbs || instruction.op == OpSqrt) ? 1 : 2;
+            QStringList operands;
+            const int sources[3] = { instruction.a, instruction.b, instruction.c };
+            for (int k = 0; k < operandCount; ++k) {
+                operands << registerName(sources[k]);
+            }
+            text += QStringLiteral("    %1 = %2 %3\n")
+                        .arg(registerName(instruction.dst), QLatin1String(kOpNames[instruction.op]),
+                             operands.join(QStringLiteral(", ")));
+        }
+        text += QStringLiteral("    -> %1\n").arg(registerName(rules[i].result));
+    }
+    text += QStringLiteral("order: %1\n").arg(lifo ? QStringLiteral("lifo") : QStringLiteral("fifo"));
+    return text;
+}
+
+bool PathScript::run(const GridSnapshot& grid,
+                     const QPoint& start,
+                     const QPoint& end,
+                     QList<QPoint>* path,
+                     PathSearch::SearchStats* stats,
+                     PathSearch::ExpansionTrace* trace,
+                     QString* error) const
+{
+    GRIDMAP_TRACE_SCOPE("PathScript::run");
+    QElapsedTimer clock;
+    clock.start();
+
+    path->clear();
+    PathSearch::SearchStats localStats;
+    PathSearch::SearchStats& searchStats = stats ? *stats : localStats;
+    searchStats = PathSearch::SearchStats();
+    searchStats.algorithm = PathSearch::Script;
+
+    const int rows = grid.map().rows();
+    const int cols = grid.map().cols();
+    if (trace) {
+        trace->reset(rows, cols);
+    }
+    if (!valid) {
+        *error = tr("寻路规则没有编译成功！");
+        return false;
+    }
+    if (rows == 0 || cols == 0) {
+        return true;
+    }
+
+    const QVector<quint8> rowMajor = grid.rowMajor();
+    const quint8* cells = rowMajor.constData();
+    const int cellCount = rows * cols;
+    const bool needDepth = usedVariables & (1u << VarDepth);
+    const bool needTurn = usedVariables & (1u << VarTurn);
+    const bool needWalls = usedVariables & (1u << VarWalls);
+    QVector<double> bestG(cellCount, std::numeric_limits<double>::infinity());
+    QVector<int> parent(cellCount, -1);
+    QVector<int> depth(needDepth ? cellCount : 0);
+    QVector<quint8> heading(needTurn ? cellCount : 0);   // 进入格子时的移动方向，起点为 4
+    std::vector<OpenEntry> open;
+    const qint64 fixedBytes = qint64(cellCount) * (sizeof(double) + sizeof(int))
+                            + qint64(depth.size()) * sizeof(int) + heading.size();
+
+    // 寄存器：变量、常量、临时值
+    double r[kRegisterCount];
+    std::fill(r, r + kRegisterCount, 0.0);
+    std::copy(constants.constBegin(), constants.constEnd(), r + VariableCount);
+    r[VarSx] = start.x();
+    r[VarSy] = start.y();
+    r[VarEx] = end.x();
+    r[VarEy] = end.y();
+    r[VarRows] = rows;
+    r[VarCols] = cols;
+
+    const Instruction* code = instructions.constData();
+    auto evaluate = [code, &r](const Expression& expression) {
+        for (const Instruction* ip = code + expression.begin, *last = code + expression.end; ip != last; ++ip) {
+            r[ip->dst] = applyOp(ip->op, r[ip->a], r[ip->b], r[ip->c]);
+        }
+        return r[expression.result];
+    };
+    auto invalidValue = [this, error](int rule, double value, int x, int y) {
+        const QString where = rules[rule].line > 0 ? tr("第 %1 行").arg(rules[rule].line) : tr("默认规则");
+        *error = tr("%1：%2 在 (%3, %4) 处的值 %5 无效%6")
+                     .arg(where, QLatin1String(kRuleNames[rule]))
+                     .arg(x).arg(y).arg(value)
+                     .arg(rule == RuleCost ? tr("，代价必须是正数") : QString());
+        return false;
+    };
+
+    static const int dx[] = { -1, 1, 0, 0 };
+    static const int dy[] = { 0, 0, -1, 1 };
+    const int startIndex = start.y() * cols + start.x();
+    const int endIndex = end.y() * cols + end.x();
+    qint64 sequence = 0;
+    bestG[startIndex] = 0;
+    if (needTurn) {
+        heading[startIndex] = 4;
+    }
+    open.push_back({ 0.0, 0.0, 0, 0.0, startIndex });
+    searchStats.nodesGenerated = 1;
+    searchStats.peakOpenSize = 1;
+    searchStats.workspaceBytes = fixedBytes + qint64(sizeof(OpenEntry));
+    qint64 lap = clock.nsecsElapsed();
+    searchStats.setupTimeNs = lap;
+
+    bool found = false;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), OpenEntryAfter());
+        const OpenEntry current = open.back();
+        open.pop_back();
+        if (current.g > bestG[current.node]) {
+            continue;   // 之后找到了更小的 g，这是过期的条目
+        }
+
+        const int cx = current.node % cols;
+        const int cy = current.node / cols;
+        ++searchStats.nodesExpanded;
+        if (trace) {
+            trace->record(QPoint(cx, cy));
+        }
+        if (current.node == endIndex) {
+            found = true;
+            break;
+        }
+
+        r[VarPx] = cx;
+        r[VarPy] = cy;
+        for (int dir = 0; dir < 4; ++dir) {
+            const int x = cx + dx[dir];
+            const int y = cy + dy[dir];
+            if (x < 0 || x >= cols || y < 0 || y >= rows || cells[y * cols + x] == GridMap::Obstacle) {
+                continue;
+            }
+            const int next = y * cols + x;
+
+            r[VarG] = current.g;
+            r[VarX] = x;
+            r[VarY] = y;
+            r[VarDx] = std::abs(x - end.x());
+            r[VarDy] = std::abs(y - end.y());
+            if (needDepth) {
+                r[VarDepth] = depth[current.node] + 1;
+            }
+            if (needTurn) {
+                r[VarTurn] = heading[current.node] != 4 && heading[current.node] != dir ? 1.0 : 0.0;
+            }
+            if (needWalls) {
+                int walls = 0;
+                for (int k = 0; k < 4; ++k) {
+                    const int wx = x + dx[k];
+                    const int wy = y + dy[k];
+                    walls += (wx < 0 || wx >= cols || wy < 0 || wy >= rows || cells[wy * cols + wx] == GridMap::Obstacle) ? 1 : 0;
+                }
+                r[VarWalls] = walls;
+            }
+
+            const double cost = evaluate(rules[RuleCost]);
+            if (!(cost > 0) || !std::isfinite(cost)) {
+                return invalidValue(RuleCost, cost, x, y);
+            }
+            const double g = current.g + cost;
+            if (g >= bestG[next]) {
+                continue;
+            }
+
+            r[VarG] = g;
+            r[VarH] = evaluate(rules[RuleHeuristic]);
+            const double priority = evaluate(rules[RulePriority]);
+            if (!std::isfinite(priority)) {
+                return invalidValue(RulePriority, priority, x, y);
+            }
+            const double tie = evaluate(rules[RuleTie]);
+            if (!std::isfinite(tie)) {
+                return invalidValue(RuleTie, tie, x, y);
+            }
+
+            bestG[next] = g;
+            parent[next] = current.node;
+            if (needDepth) {
+                depth[next] = depth[current.node] + 1;
+            }
+            if (needTurn) {
+                heading[next] = quint8(dir);
+            }
+            ++sequence;
+            open.push_back({ priority, tie, lifo ? -sequence : sequence, g, next });
+            std::push_heap(open.begin(), open.end(), OpenEntryAfter());
+            ++searchStats.nodesGenerated;
+            if (int(open.size()) > searchStats.peakOpenSize) {
+                searchStats.peakOpenSize = int(open.size());
+                searchStats.workspaceBytes = fixedBytes + qint64(open.size()) * qint64(sizeof(OpenEntry));
+            }
+        }
+    }
+    searchStats.searchTimeNs = clock.nsecsElapsed() - lap;
+    lap = clock.nsecsElapsed();
+
+    if (found) {
+        // g 沿父指针严格递减（代价为正），不会成环
+        for (int node = endIndex; node != startIndex; node = parent[node]) {
+            path->append(QPoint(node % cols, node / cols));
+        }
+        path->append(start);
+        std::reverse(path->begin(), path->end());
+    }
+    searchStats.reconstructionTimeNs = clock.nsecsElapsed() - lap;
+    return true;
+}
@@ -0,0 +1,327 @@
+#include "../include/pathsearch.h"
+#include "../include/searchkernel.h"
+#include "../include/chunkedsearch.h"
+#include "../include/algorithmplugins.h"
+#include "../include/traceprofiler.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+using namespace SearchKernel;
+
+// 分阶段计时：每次 lap() 返回距上一次的纳秒数
+class PhaseClock
+{
+public:
+    PhaseClock() : last(0) { timer.start(); }
+    qint64 lap()
+    {
+        qint64 now = timer.nsecsElapsed();
+        qint64 elapsed = now - last;
+        last = now;
+        return elapsed;
+    }
+
+private:
+    QElapsedTimer timer;
+    qint64 last;
+};
+
+// 内置算法的公共流程：构造搜索实例（准备，加上调用方构造带边框栅格的时间）、运行到结束（搜索）、回溯路径
+template <typename Kernel, typename Grid>
+QList<QPoint> runKernel(const Grid& padded,
+                        const QPoint& start,
+                        const QPoint& goal,
+                        PathSearch::SearchStats* stats,
+                        PathSearch::ExpansionTrace* trace,
+                        qint64 gridSetupNs)
+{
+    PathSearch::SearchStats localStats;
+    PathSearch::SearchStats& searchStats = stats ? *stats : localStats;
+    PhaseClock clock;
+    Kernel search(padded, start, goal, &searchStats, trace);
+    searchStats.setupTimeNs = gridSetupNs + clock.lap();
+    search.run();
+    searchStats.searchTimeNs = clock.lap();
+    QList<QPoint> path = search.path();
+    searchStats.reconstructionTimeNs = clock.lap();
+    return path;
+}
+
+} // namespace
+
+QList<QPoint> PathSearch::runAlgorithm(AlgorithmType algorithm,
+                                       const QVector<QVector<int>>& grid,
+                                       const QPoint& start,
+                                       const QPoint& end,
+                                       SearchStats* stats,
+                                       ExpansionTrace* trace,
+                                       CellLayout layout)
+{
+    const int rows = grid.size();
+    const int cols = grid.isEmpty() ? 0 : grid[0].size();
+    if (layout == ChunkedLayout && algorithm < Unknown) {
+        GridMap map(rows, cols);
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < cols; ++x) {
+                if (grid[y][x] != 0) {
+                    map.setCell(x, y, GridMap::Obstacle);
+                }
+            }
+        }
+        map.compact();
+        return runAlgorithm(algorithm, map, start, end, stats, trace, layout);
+    }
+    beginRun(algorithm, rows, cols, stats, trace);
+    if (algorithm >= Unknown) {
+        // 插件按字节读取栅格，0 可通行，1 不可通行
+        QVector<quint8> cells(rows * cols);
+        for (int y = 0; y < rows; ++y) {
+            const int* line = grid[y].constData();
+            quint8* target = cells.data() + y * cols;
+            for (int x = 0; x < cols; ++x) {
+                target[x] = line[x] == 0 ? 0 : 1;
+            }
+        }
+        return executePlugin(algorithm, cells.constData(), rows, cols, start, end, stats);
+    }
+
+    return runBuiltIn(algorithm, grid, start, end, stats, trace, layout);
+}
+
+QList<QPoint> PathSearch::runAlgorithm(AlgorithmType algorithm,
+                                       const GridMap& grid,
+                                       const QPoint& start,
+                                       const QPoint& end,
+                                       SearchStats* stats,
+                                       ExpansionTrace* trace,
+                                       CellLayout layout)
+{
+    if (algorithm >= Unknown) {
+        if (!grid.fitsContiguous()) {
+            // 展开后超出一块连续内存能容纳的格子数
+            beginRun(algorithm, 0, 0, stats, trace);
+            return QList<QPoint>();
+        }
+        beginRun(algorithm, grid.rows(), grid.cols(), stats, trace);
+        // 插件直接读取格子取值（只有 1 不可通行）
+        const QVector<quint8> cells = grid.toRowMajor();
+        return executePlugin(algorithm, cells.constData(), grid.rows(), grid.cols(), start, end, stats);
+    }
+    if (needsChunkedSearch(grid)) {
+        // 扩展记录按整张地图分配，大地图上不记录
+        beginRun(algorithm, 0, 0, stats, trace);
+        return ChunkedSearch::run(algorithm, grid, start, end, stats, nullptr);
+    }
+    beginRun(algorithm, grid.rows(), grid.cols(), stats, trace);
+    if (layout == ChunkedLayout) {
+        return ChunkedSearch::run(algorithm, grid, start, end, stats, trace);
+    }
+
+    return runBuiltIn(algorithm, grid, start, end, stats, trace, layout);
+}
+
+QList<QPoint> PathSearch::runAlgorithm(AlgorithmType algorithm,
+                                       const GridSnapshot& grid,
+                                       const QPoint& start,
+                                       const QPoint& end,
+                                       SearchStats* stats,
+                                       ExpansionTrace* trace,
+                                       CellLayout layout)
+{
+    if (algorithm < Unknown || !grid.map().fitsContiguous()) {
+        return runAlgorithm(algorithm, grid.map(), start, end, stats, trace, layout);
+    }
+    beginRun(algorithm, grid.map().rows(), grid.map().cols(), stats, trace);
+    const QVector<quint8> cells = grid.rowMajor();
+    return executePlugin(algorithm, cells.constData(), grid.map().rows(), grid.map().cols(), start, end, stats);
+}
+
+bool PathSearch::needsChunkedSearch(const GridMap& grid)
+{
+    return !grid.fitsContiguous() || qint64(grid.rows()) * grid.cols() > MaxDenseSearchCells;
+}
+
+void PathSearch::beginRun(AlgorithmType algorithm, int rows, int cols,
+                          SearchStats* stats, ExpansionTrace* trace)
+{
+    if (stats) {
+        *stats = SearchStats();
+        stats->algorithm = algorithm;
+    }
+    if (trace) {
+        trace->reset(rows, cols);
+    }
+}
+
+template <typename Source>
+QList<QPoint> PathSearch::runBuiltIn(AlgorithmType algorithm,
+                                     const Source& source,
+                                     const QPoint& start,
+                                     const QPoint& end,
+                                     SearchStats* stats,
+                                     ExpansionTrace* trace,
+                                     CellLayout layout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (layout == TiledLayout) {
+        const TiledGrid grid(source);
+        return runOnGrid(algorithm, grid, start, end, stats, trace, timer.nsecsElapsed());
+    }
+    const PaddedGrid grid(source);
+    return runOnGrid(algorithm, grid, start, end, stats, trace, timer.nsecsElapsed());
+}
+
+template <typename Grid>
+QList<QPoint> PathSearch::runOnGrid(AlgorithmType algorithm,
+                                    const Grid& grid,
+                                    const QPoint& start,
+                                    const QPoint& end,
+                                    SearchStats* stats,
+                                    ExpansionTrace* trace,
+                                    qint64 gridSetupNs)
+{
+    switch (algorithm) {
+        case AStar:
+            return executeAStar(grid, start, end, stats, trace, gridSetupNs);
+        case Dijkstra:
+            return executeDijkstra(grid, start, end, stats, trace, gridSetupNs);
+        case BFS:
+            return executeBFS(grid, start, end, stats, trace, gridSetupNs);
+        case DFS:
+            return executeDFS(grid, start, end, stats, trace, gridSetupNs);
+        case DStar:
+            return executeDStar(grid, start, end, stats, trace, gridSetupNs);
+        default:
+            return QList<QPoint>();
+    }
+}
+
+QList<QPoint> PathSearch::executePlugin(AlgorithmType algorithm,
+                                        const quint8* cells,
+                                        int rows,
+                                        int cols,
+                                        const QPoint& start,
+                                        const QPoint& end,
+                                        SearchStats* stats)
+{
+    const AlgorithmPlugins& plugins = AlgorithmPlugins::instance();
+    if (!plugins.contains(algorithm) || rows <= 0 || cols <= 0) {
+        return QList<QPoint>();
+    }
+
+    QList<QPoint> path;
+    SearchStats pluginStats;
+    QString error;
+    if (!plugins.search(algorithm, cells, rows, cols, cols, start, end, &path, &pluginStats, &error)) {
+        qWarning().noquote() << error;
+    }
+    if (stats) {
+        *stats = pluginStats;
+    }
+    return path;
+}
+
+QString PathSearch::algorithmName(AlgorithmType algorithm)
+{
+    switch (algorithm) {
+        case AStar:
+            return QStringLiteral("A*");
+        case Dijkstra:
+            return QStringLiteral("Dijkstra");
+        case BFS:
+            return QStringLiteral("BFS");
+        case DFS:
+            return QStringLiteral("DFS");
+        case DStar:
+            return QStringLiteral("D*");
+        case Script:
+            return tr("寻路规则");
+        default:
+            break;
+    }
+    const QString pluginName = AlgorithmPlugins::instance().name(algorithm);
+    return pluginName.isEmpty() ? tr("未知算法") : pluginName;
+}
+
+template <typename Grid>
+QList<QPoint> PathSearch::executeAStar(const Grid& grid,
+                                       const QPoint& start,
+                                       const QPoint& end,
+                                       SearchStats* stats,
+                                       ExpansionTrace* trace,
+                                       qint64 gridSetupNs)
+{
+    GRIDMAP_TRACE_SCOPE("PathSearch::executeAStar");
+    return runKernel<AStarKernel<Grid>>(grid, start, end, stats, trace, gridSetupNs);
+}
+
+template <typename Grid>
+QList<QPoint> PathSearch::executeDijkstra(const Grid& grid,
+                                          const QPoint& start,
+                                          const QPoint& end,
+                                          SearchStats* stats,
+                                          ExpansionTrace* trace,
+                                          qint64 gridSetupNs)
+{
+    GRIDMAP_TRACE_SCOPE("PathSearch::executeDijkstra");
+    return runKernel<DijkstraKernel<Grid>>(grid, start, end, stats, trace, gridSetupNs);
+}
+
+template <typename Grid>
+QList<QPoint> PathSearch::executeBFS(const Grid& grid,
+                                     const QPoint& start,
+                                     const QPoint& end,
+                                     SearchStats* stats,
+                                     ExpansionTrace* trace,
+                                     qint64 gridSetupNs)
+{
+    GRIDMAP_TRACE_SCOPE("PathSearch::executeBFS");
+    return runKernel<BreadthFirstKernel<Grid>>(grid, start, end, stats, trace, gridSetupNs);
+}
+
+template <typename Grid>
+QList<QPoint> PathSearch::executeDFS(const Grid& grid,
+                                     const QPoint& start,
+                                     const QPoint& end,
+                                     SearchStats* stats,
+                                     ExpansionTrace* trace,
+                                     qint64 gridSetupNs)
+{
+    GRIDMAP_TRACE_SCOPE("PathSearch::executeDFS");
+    // 显式栈代替递归，大地图上不会栈溢出；扩展顺序和递归实现相同
+    return runKernel<DepthFirstKernel<Grid>>(grid, start, end, stats, trace, gridSetupNs);
+}
+
+template <typename Grid>
+QList<QPoint> PathSearch::executeDStar(const Grid& grid,
+                                       const QPoint& start,
+                                       const QPoint& end,
+                                       SearchStats* stats,
+                                       ExpansionTrace* trace,
+                                       qint64 gridSetupNs)
+{
+    GRIDMAP_TRACE_SCOPE("PathSearch::executeDStar");
+    // D*算法的简化实现：在静态环境中退化为从终点向起点的A*，路径沿父节点从起点走回终点
+    QList<QPoint> path = runKernel<AStarKernel<Grid>>(grid, end, start, stats, trace, gridSetupNs);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void PathSearch::ExpansionTrace::reset(int rowCount, int colCount)
+{
+    rows = rowCount;
+    cols = colCount;
+    expansions = 0;
+    maxCount = 0;
+    counts.fill(0, rows * cols);
+    order.fill(0, rows * cols);
+}
+
+bool PathSearch::isValid(int x, int y, const QVector<QVector<int>>& grid)
+{
+    return x >= 0 && x < grid[0].size() && y >= 0 && y < grid.size() && grid[y][x] == 0;
+}
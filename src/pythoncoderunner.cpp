@@ -0,0 +1,271 @@
+#include "../include/pythoncoderunner.h"
+#include "../include/solverworker.h"
+#include "../include/traceprofiler.h"
+#include <QProcessEnvironment>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+
+// 工作进程脚本：映射共享栅格，加载代码后循环读取请求、调用 find_path，按 SolverWorker 的协议写回结果
+// 用户代码 print 的内容被重定向到标准错误，不会混进结果通道
+static const char kWorkerScript[] = R"(import linecache, mmap, os, struct, sys, time, traceback
+
+REQUEST = struct.Struct('=10i')
+RESPONSE = struct.Struct('=4i2q')
+REQUEST_MAGIC, RESPONSE_MAGIC = 0x51524D47, 0x53524D47
+SOLVE, LOAD_CODE = 1, 2
+PATH_FOUND, NO_PATH, USER_ERROR = 0, 1, 2
+
+
+def read_exactly(stream, size):
+    data = b''
+    while len(data) < size:
+        chunk = stream.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def load(source):
+    # 出错时回溯信息中显示编辑器中的代码行
+    linecache.cache['code.py'] = (len(source), None, source.splitlines(True), 'code.py')
+    namespace = {'__name__': 'gridmap_user', '__builtins__': __builtins__}
+    exec(compile(source, 'code.py', 'exec'), namespace)
+    for value in list(namespace.values()):
+        if isinstance(value, type) and value.__module__ == 'gridmap_user':
+            for name in ('find_path', 'findPath'):
+                if callable(getattr(value, name, None)):
+                    return namespace, lambda grid, *args, cls=value, name=name: getattr(cls(grid), name)(*args)
+    for name in ('find_path', 'findPath'):
+        if callable(namespace.get(name)):
+            return namespace, namespace[name]
+    raise LookupError('code.py: no class with find_path(start_row, start_col, end_row, end_col) '
+                      'and no function find_path(grid, start_row, start_col, end_row, end_col)')
+
+
+def main():
+    capacity = int(sys.argv[2])
+    with open(sys.argv[1], 'rb') as f:
+        cells = mmap.mmap(f.fileno(), capacity, access=mmap.ACCESS_READ)
+    memory = memoryview(cells)
+    requests = sys.stdin.buffer
+    channel = os.fdopen(os.dup(1), 'wb')
+    os.dup2(2, 1)
+
+    def reply(sequence, status, length=0, payload=b'', setup_ns=0, search_ns=0):
+        sys.stdout.flush()
+        channel.write(RESPONSE.pack(RESPONSE_MAGIC, sequence, status, length, setup_ns, search_ns) + payload)
+        channel.flush()
+
+    def reply_error(sequence, search_ns=0):
+        # 只保留用户代码中的调用栈
+        kind, value, frames = sys.exc_info()
+        while frames is not None and frames.tb_frame.f_code.co_filename != 'code.py':
+            frames = frames.tb_next
+        message = ''.join(traceback.format_exception(kind, value, frames)).encode('utf-8')
+        reply(sequence, USER_ERROR, len(message), message, 0, search_ns)
+
+    namespace, solver = None, None
+    while True:
+        header = read_exactly(requests, REQUEST.size)
+        if header is None:
+            break
+        magic, command, rows, cols, start_x, start_y, end_x, end_y, sequence, payload_bytes = REQUEST.unpack(header)
+        if magic != REQUEST_MAGIC:
+            break
+        payload = read_exactly(requests, payload_bytes) if payload_bytes else b''
+
+        if command == LOAD_CODE:
+            try:
+                namespace, solver = load(payload.decode('utf-8'))
+                reply(sequence, PATH_FOUND)
+            except BaseException:
+                namespace, solver = None, None
+                reply_error(sequence)
+            continue
+        if command != SOLVE or solver is None or rows * cols > capacity:
+            message = b'no code loaded' if solver is None else b'invalid request'
+            reply(sequence, USER_ERROR, len(message), message)
+            continue
+
+        setup_start = time.perf_counter()
+        grid = [list(cells[row * cols:(row + 1) * cols]) for row in range(rows)]
+        namespace['grid_buffer'] = memory[:rows * cols].cast('B', (rows, cols))
+        search_start = time.perf_counter()
+        setup_ns = int((search_start - setup_start) * 1e9)
+        try:
+            path = solver(grid, start_y, start_x, end_y, end_x)
+            search_ns = int((time.perf_counter() - search_start) * 1e9)
+            points = []
+            for point in path or ():
+                points.append(int(point[1]))
+                points.append(int(point[0]))
+        except BaseException:
+            reply_error(sequence, int((time.perf_counter() - search_start) * 1e9))
+            continue
+        reply(sequence, PATH_FOUND if points else NO_PATH, len(points) // 2,
+              struct.pack('=%di' % len(points), *points), setup_ns, search_ns)
+
+
+main()
+)";
+
+PythonCodeRunner::PythonCodeRunner(QObject *parent)
+    : QObject(parent),
+      interpreter(findInterpreter()),
+      worker(new SolverWorker(this)),
+      hasQueuedRun(false)
+{
+    workingDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (workingDirectory.isEmpty()) {
+        workingDirectory = QDir::tempPath() + QStringLiteral("/GridMapEditor");
+    }
+    workingDirectory += QStringLiteral("/python");
+    connect(worker, &SolverWorker::finished, this, &PythonCodeRunner::onWorkerFinished);
+}
+
+QString PythonCodeRunner::findInterpreter()
+{
+    const QString fromEnvironment = qEnvironmentVariable("PYTHON");
+    if (!fromEnvironment.isEmpty()) {
+        const QString path = QStandardPaths::findExecutable(fromEnvironment);
+        return path.isEmpty() && QFileInfo(fromEnvironment).isExecutable() ? fromEnvironment : path;
+    }
+    for (const QString& name : {QStringLiteral("python3"), QStringLiteral("python")}) {
+        const QString path = QStandardPaths::findExecutable(name);
+        if (!path.isEmpty()) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+bool PythonCodeRunner::hasEntryPoint(const QString& code)
+{
+    static const QRegularExpression pattern(QStringLiteral("^\\s*def\\s+(find_path|findPath)\\s*\\("),
+                                            QRegularExpression::MultilineOption);
+    return pattern.match(code).hasMatch();
+}
+
+bool PythonCodeRunner::startWorker(qint64 cellCount, QString* error)
+{
+    // 脚本随程序版本变化，每次启动时重写
+    QDir().mkpath(workingDirectory);
+    const QString scriptPath = workingDirectory + QStringLiteral("/gridmap_worker.py");
+    QFile script(scriptPath);
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Truncate) || script.write(kWorkerScript) < 0) {
+        *error = tr("无法写入工作进程脚本：%1").arg(scriptPath);
+        return false;
+    }
+    script.close();
+
+    // 子进程不能创建线程，数值库只用单线程
+    QProcessEnvironment environment;
+    environment.insert(QStringLiteral("OPENBLAS_NUM_THREADS"), QStringLiteral("1"));
+    environment.insert(QStringLiteral("OMP_NUM_THREADS"), QStringLiteral("1"));
+    environment.insert(QStringLiteral("PYTHONIOENCODING"), QStringLiteral("utf-8"));
+    loadedCode.clear();
+    return worker->start(interpreter, {QStringLiteral("-B"), scriptPath},
+                         workingDirectory + QStringLiteral("/sandbox"), cellCount, error, environment);
+}
+
+bool PythonCodeRunner::load(const QByteArray& source, QString* error)
+{
+    loadedCode.clear();
+    if (!worker->loadCode(source, error)) {
+        return false;
+    }
+    loadingCode = source;
+    return true;
+}
+
+bool PythonCodeRunner::prepare(const QString& code, QString* error)
+{
+    GRIDMAP_TRACE_SCOPE("PythonCodeRunner::prepare");
+    if (worker->isBusy()) {
+        return true;
+    }
+    if (!worker->isRunning() && !startWorker(0, error)) {
+        return false;
+    }
+    const QByteArray source = code.toUtf8();
+    if (source == loadedCode) {
+        return true;
+    }
+    return load(source, error);
+}
+
+bool PythonCodeRunner::run(const QString& code,
+                           const GridMap& grid,
+                           const QPoint& start,
+                           const QPoint& end,
+                           QString* error)
+{
+    GRIDMAP_TRACE_SCOPE("PythonCodeRunner::run");
+    if (hasQueuedRun) {
+        *error = tr("上一次运行还没有结束！");
+        return false;
+    }
+    hasQueuedRun = true;
+    queuedCode = code.toUtf8();
+    queuedGrid = grid;
+    queuedStart = start;
+    queuedEnd = end;
+    // prepare 的加载还没有完成时等它的结果
+    if (worker->isBusy()) {
+        return true;
+    }
+    if (!continueRun(error)) {
+        hasQueuedRun = false;
+        queuedGrid = GridMap();
+        return false;
+    }
+    return true;
+}
+
+bool PythonCodeRunner::continueRun(QString* error)
+{
+    // 栅格变大或请求过多时重启解释器，并重新加载代码
+    const qint64 cellCount = qint64(queuedGrid.rows()) * queuedGrid.cols();
+    if (worker->needsRestart(cellCount) && !startWorker(cellCount, error)) {
+        return false;
+    }
+    if (queuedCode != loadedCode) {
+        return load(queuedCode, error);
+    }
+    return worker->solve(queuedGrid, queuedStart, queuedEnd, error);
+}
+
+void PythonCodeRunner::onWorkerFinished(bool ok, const QList<QPoint>& path, const PathSearch::SearchStats& stats,
+                                        const QString& error)
+{
+    if (!loadingCode.isEmpty()) {
+        const QByteArray source = loadingCode;
+        loadingCode.clear();
+        if (ok) {
+            loadedCode = source;
+        }
+        if (!hasQueuedRun) {
+            // prepare 的提前加载，错误在运行时报告
+            return;
+        }
+        // 要运行的代码加载失败时报告加载错误；prepare 加载的是别的代码时加载要运行的代码
+        QString startError = error;
+        if ((ok || source != queuedCode) && continueRun(&startError)) {
+            return;
+        }
+        hasQueuedRun = false;
+        queuedGrid = GridMap();
+        emit runFinished(false, QList<QPoint>(), PathSearch::SearchStats(), startError);
+        return;
+    }
+    if (!hasQueuedRun) {
+        return;
+    }
+    hasQueuedRun = false;
+    queuedGrid = GridMap();
+    emit runFinished(ok, path, stats, error);
+}
@@ -0,0 +1,103 @@
+#include "../include/raceresultdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+
+RaceResultDialog::RaceResultDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("算法竞速"));
+    resize(560, 280);
+    
+    resultTable = new QTableWidget(this);
+    resultTable->setColumnCount(5);
+    resultTable->setHorizontalHeaderLabels({tr("算法"), tr("耗时 (ms)"), tr("扩展节点"),
+                                            tr("峰值内存"), tr("路径长度")});
+    resultTable->verticalHeader()->setVisible(false);
+    resultTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    resultTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    resultTable->setSelectionMode(QAbstractItemView::NoSelection);
+    
+    statusLabel = new QLabel(this);
+    statusLabel->setStyleSheet("color: gray; font-size: 11px;");
+    
+    clearOverlayButton = new QPushButton(tr("清除叠加路径"), this);
+    closeButton = new QPushButton(tr("关闭"), this);
+    
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(statusLabel);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(clearOverlayButton);
+    buttonLayout->addWidget(closeButton);
+    
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(resultTable);
+    mainLayout->addLayout(buttonLayout);
+    
+    connect(clearOverlayButton, &QPushButton::clicked, this, &RaceResultDialog::overlayCleared);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+    
+    resetRace();
+}
+
+QColor RaceResultDialog::engineColor(int slot)
+{
+    static const QColor colors[] = {
+        QColor(230, 57, 70),    // A*：红
+        QColor(244, 162, 97),   // Dijkstra：橙
+        QColor(42, 130, 218),   // BFS：蓝
+        QColor(142, 68, 173),   // DFS：紫
+        QColor(42, 157, 143)    // D*：青
+    };
+    const int count = sizeof(colors) / sizeof(colors[0]);
+    return colors[((slot % count) + count) % count];
+}
+
+void RaceResultDialog::resetRace()
+{
+    const QList<PathSearch::AlgorithmType> engines = PathfindingRace::engines();
+    resultTable->setRowCount(engines.size());
+    
+    for (int slot = 0; slot < engines.size(); ++slot) {
+        QTableWidgetItem *nameItem = new QTableWidgetItem(PathSearch::algorithmName(engines[slot]));
+        nameItem->setForeground(engineColor(slot));
+        QFont font = nameItem->font();
+        font.setBold(true);
+        nameItem->setFont(font);
+        resultTable->setItem(slot, 0, nameItem);
+        
+        for (int column = 1; column < resultTable->columnCount(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem(tr("运行中…"));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            resultTable->setItem(slot, column, item);
+        }
+    }
+    
+    statusLabel->setText(tr("正在并行运行 %1 个算法…").arg(engines.size()));
+}
+
+void RaceResultDialog::setEngineResult(int slot, const PathfindingRace::EngineResult& result)
+{
+    if (slot < 0 || slot >= resultTable->rowCount()) {
+        return;
+    }
+    
+    auto formatBytes = [](qint64 bytes) {
+        if (bytes >= 1024 * 1024) {
+            return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 2);
+        }
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    };
+    
+    resultTable->item(slot, 1)->setText(QString::number(result.wallTimeNs / 1.0e6, 'f', 3));
+    resultTable->item(slot, 2)->setText(QString::number(result.stats.nodesExpanded));
+    resultTable->item(slot, 3)->setText(formatBytes(result.stats.workspaceBytes));
+    // 路径长度按步数计算（格子数减一）
+    resultTable->item(slot, 4)->setText(result.path.isEmpty() ? tr("无路径")
+                                                              : QString::number(result.path.size() - 1));
+}
+
+void RaceResultDialog::setRaceFinished()
+{
+    statusLabel->setText(tr("全部算法已完成"));
+}
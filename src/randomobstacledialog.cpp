@@ -6,17 +6,20 @@ RandomObstacleDialog::RandomObstacleDialog(QWidget *parent)
 {
     setWindowTitle(tr("随机生成障碍物"));
     setModal(true);
-    setFixedSize(350, 400);
+    setFixedSize(350, 480);
     
     setupUI();
     
     // 连接信号和槽
     connect(generateButton, &QPushButton::clicked, this, &QDialog::accept);
     connect(cancelButton, &QPushButton::clicked, this, &QDialog::reject);
+    connect(patternComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &RandomObstacleDialog::onPatternChanged);
     connect(connectivityGroup, SIGNAL(buttonClicked(int)), this, SLOT(onConnectivityChanged()));
     connect(useSeedCheckBox, &QCheckBox::toggled, this, &RandomObstacleDialog::onUseSeedChanged);
     
     // 初始化状态
+    onPatternChanged();
     onConnectivityChanged();
     onUseSeedChanged();
 }
@@ -27,6 +30,22 @@ void RandomObstacleDialog::setupUI()
     mainLayout->setSpacing(15);
     mainLayout->setContentsMargins(20, 20, 20, 20);
     
+    // 生成方式设置
+    QGroupBox *patternGroup = new QGroupBox(tr("生成方式"), this);
+    QVBoxLayout *patternLayout = new QVBoxLayout(patternGroup);
+    
+    patternComboBox = new QComboBox(this);
+    patternComboBox->addItem(tr("随机噪声"), UniformNoise);
+    patternComboBox->addItem(tr("迷宫（递归回溯）"), Maze);
+    patternComboBox->addItem(tr("洞穴（元胞自动机）"), Cave);
+    patternComboBox->addItem(tr("房间与走廊"), Rooms);
+    patternLayout->addWidget(patternComboBox);
+    
+    patternTip = new QLabel(this);
+    patternTip->setStyleSheet("color: gray; font-size: 11px;");
+    patternTip->setWordWrap(true);
+    patternLayout->addWidget(patternTip);
+    
     // 障碍物密度设置
     QGroupBox *densityGroup = new QGroupBox(tr("障碍物密度"), this);
     QFormLayout *densityLayout = new QFormLayout(densityGroup);
@@ -45,8 +64,8 @@ void RandomObstacleDialog::setupUI()
     densityLayout->addRow(densityTip);
     
     // 连通性设置
-    QGroupBox *connectivityGroup = new QGroupBox(tr("连通性设置"), this);
-    QVBoxLayout *connectivityLayout = new QVBoxLayout(connectivityGroup);
+    connectivityBox = new QGroupBox(tr("连通性设置"), this);
+    QVBoxLayout *connectivityLayout = new QVBoxLayout(connectivityBox);
     
     this->connectivityGroup = new QButtonGroup(this);
     
@@ -69,7 +88,8 @@ void RandomObstacleDialog::setupUI()
     multipleLayout->addWidget(multiplePathsRadio);
     
     pathCountSpinBox = new QSpinBox(this);
-    pathCountSpinBox->setRange(2, 10);
+    // 四连通栅格中起点最多只有4个相邻格子，因此不相交通路最多4条
+    pathCountSpinBox->setRange(2, 4);
     pathCountSpinBox->setValue(3);
     pathCountSpinBox->setSuffix(tr(" 条"));
     pathCountSpinBox->setMaximumWidth(80);
@@ -123,13 +143,39 @@ void RandomObstacleDialog::setupUI()
     buttonLayout->addWidget(generateButton);
     
     // 添加到主布局
+    mainLayout->addWidget(patternGroup);
     mainLayout->addWidget(densityGroup);
-    mainLayout->addWidget(connectivityGroup);
+    mainLayout->addWidget(connectivityBox);
     mainLayout->addWidget(seedGroup);
     mainLayout->addStretch();
     mainLayout->addLayout(buttonLayout);
 }
 
+void RandomObstacleDialog::onPatternChanged()
+{
+    GenerationPattern pattern = getPattern();
+    
+    // 程序化生成总是保证起点和终点连通，连通性设置只对随机噪声有效；
+    // 迷宫的墙体由网格结构决定，不使用密度
+    connectivityBox->setEnabled(pattern == UniformNoise);
+    densitySpinBox->setEnabled(pattern != Maze);
+    
+    switch (pattern) {
+        case UniformNoise:
+            patternTip->setText(tr("提示：按密度均匀撒布障碍物"));
+            break;
+        case Maze:
+            patternTip->setText(tr("提示：完美迷宫，任意两点之间只有一条通路"));
+            break;
+        case Cave:
+            patternTip->setText(tr("提示：密度为初始填充率，0.45左右效果较好"));
+            break;
+        case Rooms:
+            patternTip->setText(tr("提示：密度越低，房间之间的额外走廊越多"));
+            break;
+    }
+}
+
 void RandomObstacleDialog::onConnectivityChanged()
 {
     int checkedId = connectivityGroup->checkedId();
@@ -142,6 +188,11 @@ void RandomObstacleDialog::onUseSeedChanged()
     seedSpinBox->setEnabled(useSeed);
 }
 
+RandomObstacleDialog::GenerationPattern RandomObstacleDialog::getPattern() const
+{
+    return static_cast<GenerationPattern>(patternComboBox->currentData().toInt());
+}
+
 double RandomObstacleDialog::getObstacleDensity() const
 {
     return densitySpinBox->value();
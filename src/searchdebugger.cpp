@@ -0,0 +1,192 @@
+#include "../include/searchdebugger.h"
+#include "../include/traceprofiler.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+
+// 对当前的搜索实例调用 function；没有调试会话时返回 fallback
+template <typename Kernel, typename Result, typename Function>
+Result withSearch(Kernel& kernel, Result fallback, Function function)
+{
+    return std::visit([&](auto& search) -> Result {
+        if constexpr (std::is_same_v<std::decay_t<decltype(search)>, std::monostate>) {
+            return fallback;
+        } else {
+            return function(search);
+        }
+    }, kernel);
+}
+
+} // namespace
+
+SearchDebugger::SearchDebugger()
+    : currentAlgorithm(PathSearch::Unknown), grid(nullptr)
+{
+}
+
+SearchDebugger::~SearchDebugger()
+{
+    stop();
+}
+
+bool SearchDebugger::supports(PathSearch::AlgorithmType algorithm)
+{
+    switch (algorithm) {
+        case PathSearch::AStar:
+        case PathSearch::Dijkstra:
+        case PathSearch::BFS:
+        case PathSearch::DFS:
+        case PathSearch::DStar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SearchDebugger::start(PathSearch::AlgorithmType algorithm,
+                           const GridMap& searchGrid,
+                           const QPoint& start,
+                           const QPoint& end)
+{
+    GRIDMAP_TRACE_SCOPE("SearchDebugger::start");
+    stop();
+    if (!supports(algorithm) || searchGrid.isEmpty() || PathSearch::needsChunkedSearch(searchGrid)) {
+        return false;
+    }
+
+    currentAlgorithm = algorithm;
+    searchStats = PathSearch::SearchStats();
+    searchStats.algorithm = algorithm;
+    grid = new SearchKernel::PaddedGrid(searchGrid);
+    breakpointMask.fill(0, grid->size());
+
+    switch (algorithm) {
+        case PathSearch::AStar:
+            kernel.emplace<SearchKernel::AStarSearch>(*grid, start, end, &searchStats, nullptr, &changes);
+            break;
+        case PathSearch::Dijkstra:
+            kernel.emplace<SearchKernel::DijkstraSearch>(*grid, start, end, &searchStats, nullptr, &changes);
+            break;
+        case PathSearch::BFS:
+            kernel.emplace<SearchKernel::BreadthFirstSearch>(*grid, start, end, &searchStats, nullptr, &changes);
+            break;
+        case PathSearch::DFS:
+            kernel.emplace<SearchKernel::DepthFirstSearch>(*grid, start, end, &searchStats, nullptr, &changes);
+            break;
+        default:
+            // D*：从终点向起点搜索，path() 中再翻转
+            kernel.emplace<SearchKernel::AStarSearch>(*grid, end, start, &searchStats, nullptr, &changes);
+            break;
+    }
+    return true;
+}
+
+void SearchDebugger::stop()
+{
+    // 先销毁搜索实例，再释放它引用的栅格
+    kernel.emplace<std::monostate>();
+    delete grid;
+    grid = nullptr;
+    currentAlgorithm = PathSearch::Unknown;
+    changes.clear();
+    breakpointMask.clear();
+}
+
+bool SearchDebugger::isFinished() const
+{
+    return withSearch(kernel, true, [](const auto& search) { return search.isFinished(); });
+}
+
+bool SearchDebugger::found() const
+{
+    return withSearch(kernel, false, [](const auto& search) { return search.found(); });
+}
+
+bool SearchDebugger::step()
+{
+    return withSearch(kernel, false, [](auto& search) { return search.step(); });
+}
+
+bool SearchDebugger::runToBreakpoint(const QList<QPoint>& breakpoints)
+{
+    GRIDMAP_TRACE_SCOPE("SearchDebugger::runToBreakpoint");
+    if (!isActive()) {
+        return false;
+    }
+    for (const QPoint& pos : breakpoints) {
+        if (grid->contains(pos)) {
+            breakpointMask[grid->index(pos)] = 1;
+        }
+    }
+
+    // 至少扩展一个格子，停在断点上时继续运行不会原地不动
+    const bool hit = withSearch(kernel, false, [this](auto& search) {
+        while (!search.isFinished()) {
+            search.step();
+            const int index = search.lastExpanded();
+            if (index >= 0 && breakpointMask[index]) {
+                return true;
+            }
+        }
+        return false;
+    });
+
+    for (const QPoint& pos : breakpoints) {
+        if (grid->contains(pos)) {
+            breakpointMask[grid->index(pos)] = 0;
+        }
+    }
+    return hit;
+}
+
+void SearchDebugger::runToEnd()
+{
+    GRIDMAP_TRACE_SCOPE("SearchDebugger::runToEnd");
+    withSearch(kernel, false, [](auto& search) {
+        search.run();
+        return true;
+    });
+}
+
+QPoint SearchDebugger::lastExpanded() const
+{
+    const int index = withSearch(kernel, -1, [](const auto& search) { return search.lastExpanded(); });
+    return index >= 0 ? grid->point(index) : QPoint(-1, -1);
+}
+
+SearchDebugger::CellState SearchDebugger::cellState(const QPoint& pos) const
+{
+    if (!isActive() || !grid->contains(pos)) {
+        return Unseen;
+    }
+    const int index = grid->index(pos);
+    return withSearch(kernel, Unseen, [index](const auto& search) {
+        return static_cast<CellState>(search.cellState(index));
+    });
+}
+
+int SearchDebugger::openSize() const
+{
+    return withSearch(kernel, 0, [](const auto& search) { return search.openSize(); });
+}
+
+QList<QPoint> SearchDebugger::path() const
+{
+    QList<QPoint> result = withSearch(kernel, QList<QPoint>(), [](const auto& search) { return search.path(); });
+    if (currentAlgorithm == PathSearch::DStar) {
+        std::reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+QList<QPoint> SearchDebugger::takeChangedCells()
+{
+    QList<QPoint> cells;
+    cells.reserve(changes.size());
+    for (int index : changes) {
+        cells.append(grid->point(index));
+    }
+    changes.clear();
+    return cells;
+}
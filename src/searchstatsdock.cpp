@@ -0,0 +1,108 @@
+#include "../include/searchstatsdock.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QHeaderView>
+#include <QStringList>
+
+SearchStatsDock::SearchStatsDock(QWidget *parent)
+    : QDockWidget(tr("搜索统计"), parent)
+{
+    setObjectName("SearchStatsDock");
+    
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(5, 5, 5, 5);
+    layout->setSpacing(5);
+    
+    // 历史记录数量和清空按钮
+    QHBoxLayout *toolLayout = new QHBoxLayout();
+    QLabel *limitLabel = new QLabel(tr("保留最近:"), content);
+    historyLimitSpinBox = new QSpinBox(content);
+    historyLimitSpinBox->setRange(1, 1000);
+    historyLimitSpinBox->setValue(20);
+    historyLimitSpinBox->setSuffix(tr(" 次"));
+    clearButton = new QPushButton(tr("清空"), content);
+    
+    toolLayout->addWidget(limitLabel);
+    toolLayout->addWidget(historyLimitSpinBox);
+    toolLayout->addStretch();
+    toolLayout->addWidget(clearButton);
+    
+    historyTable = new QTableWidget(content);
+    historyTable->setColumnCount(10);
+    historyTable->setHorizontalHeaderLabels({tr("时间"), tr("算法"), tr("路径长度"), tr("扩展节点"),
+                                             tr("生成节点"), tr("开放列表峰值"), tr("工作内存"),
+                                             tr("准备 (ms)"), tr("搜索 (ms)"), tr("回溯 (ms)")});
+    historyTable->verticalHeader()->setVisible(false);
+    historyTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    historyTable->horizontalHeader()->setStretchLastSection(true);
+    historyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    historyTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    
+    layout->addLayout(toolLayout);
+    layout->addWidget(historyTable);
+    setWidget(content);
+    
+    connect(historyLimitSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &SearchStatsDock::onHistoryLimitChanged);
+    connect(clearButton, &QPushButton::clicked, this, &SearchStatsDock::clearHistory);
+}
+
+void SearchStatsDock::addRun(const PathSearch::SearchStats& stats, int pathLength)
+{
+    historyTable->insertRow(0);
+    setRow(0, QTime::currentTime(), stats, pathLength);
+    trimRows(historyLimitSpinBox->value());
+}
+
+void SearchStatsDock::clearHistory()
+{
+    historyTable->setRowCount(0);
+}
+
+void SearchStatsDock::onHistoryLimitChanged(int limit)
+{
+    trimRows(limit);
+}
+
+void SearchStatsDock::trimRows(int limit)
+{
+    while (historyTable->rowCount() > limit) {
+        historyTable->removeRow(historyTable->rowCount() - 1);
+    }
+}
+
+void SearchStatsDock::setRow(int row, const QTime& time, const PathSearch::SearchStats& stats, int pathLength)
+{
+    auto formatMs = [](qint64 ns) {
+        return QString::number(ns / 1.0e6, 'f', 3);
+    };
+    auto formatBytes = [](qint64 bytes) {
+        if (bytes >= 1024 * 1024) {
+            return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 2);
+        }
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    };
+    
+    const QStringList cells = {
+        time.toString("HH:mm:ss"),
+        PathSearch::algorithmName(stats.algorithm),
+        pathLength < 0 ? tr("无路径") : QString::number(pathLength),
+        QString::number(stats.nodesExpanded),
+        QString::number(stats.nodesGenerated),
+        QString::number(stats.peakOpenSize),
+        formatBytes(stats.workspaceBytes),
+        formatMs(stats.setupTimeNs),
+        formatMs(stats.searchTimeNs),
+        formatMs(stats.reconstructionTimeNs)
+    };
+    
+    for (int column = 0; column < cells.size(); ++column) {
+        QTableWidgetItem *item = new QTableWidgetItem(cells[column]);
+        if (column >= 2) {
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        historyTable->setItem(row, column, item);
+    }
+}
@@ -0,0 +1,645 @@
+#include "../include/solverworker.h"
+#include "../include/gridmap.h"
+#include "../include/traceprofiler.h"
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTimer>
+#include <QDebug>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QDir>
+#include <QtMath>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#endif
+
+static const int kRunTimeoutMs = 10000;           // 单个请求的时间上限
+static const int kMaxRuns = 1000;                 // 处理这么多请求后重启
+static const qint64 kMemoryLimit = qint64(4) << 30;
+static const int kErrorTailBytes = 2048;
+static const qint32 kMaxPayloadLength = 1 << 26;
+
+struct WorkerRequest {
+    qint32 magic;
+    qint32 command;
+    qint32 rows;
+    qint32 cols;
+    qint32 startX;
+    qint32 startY;
+    qint32 endX;
+    qint32 endY;
+    qint32 sequence;
+    qint32 payloadBytes;
+};
+
+struct WorkerResponseHeader {
+    qint32 magic;
+    qint32 sequence;
+    qint32 status;
+    qint32 length;
+    qint64 setupNs;
+    qint64 searchNs;
+};
+
+namespace {
+
+#ifdef Q_OS_UNIX
+// 在子进程 exec 之前执行（只能调用异步信号安全的函数，不分配内存）：
+// - 地址空间不超过 4GB，不产生 core 文件
+// - RLIMIT_FSIZE 为 0：不能把文件写大
+// - RLIMIT_NPROC 为 0：同一用户已有进程时不能再创建进程和线程（root 不受这一限制）
+// Linux 上还会隔离子进程（见 isolateProcess）：新的用户和网络命名空间，seccomp 过滤器拒绝网络、
+// 以写方式打开文件、修改文件系统、向其他进程发信号或读写其他进程等系统调用
+// 仍然可以读取编辑器用户能读的文件；其他 Unix 平台只有资源限制
+void setLimit(int resource, rlim_t value)
+{
+    struct rlimit limit;
+    if (getrlimit(resource, &limit) == 0 && limit.rlim_max != RLIM_INFINITY && limit.rlim_max < value) {
+        // 硬限制已经更低时保持不变，抬高硬限制会失败，整个限制都不会生效
+        value = limit.rlim_max;
+    }
+    limit.rlim_cur = limit.rlim_max = value;
+    setrlimit(resource, &limit);
+}
+
+#ifdef Q_OS_LINUX
+#if defined(__x86_64__)
+#define GRIDMAP_AUDIT_ARCH AUDIT_ARCH_X86_64
+#elif defined(__aarch64__)
+#define GRIDMAP_AUDIT_ARCH AUDIT_ARCH_AARCH64
+#elif defined(__i386__)
+#define GRIDMAP_AUDIT_ARCH AUDIT_ARCH_I386
+#endif
+
+#ifdef GRIDMAP_AUDIT_ARCH
+// 用户代码调用时返回 EPERM 的系统调用；io_uring 的操作不经过 seccomp，整个拒绝
+// 只在部分架构上存在的旧调用（open、unlink 等）按宏是否定义加入
+static const int kDeniedSyscalls[] = {
+    // 网络（有的架构用 socketcall 复用全部套接字调用）
+    SYS_socket, SYS_socketpair,
+#ifdef SYS_socketcall
+    SYS_socketcall,
+#endif
+    // 调试或读写其他进程，绕过 kill 检查的 pidfd 信号
+    SYS_ptrace, SYS_process_vm_readv, SYS_process_vm_writev,
+#ifdef SYS_pidfd_open
+    SYS_pidfd_open, SYS_pidfd_send_signal,
+#endif
+#ifdef SYS_pidfd_getfd
+    SYS_pidfd_getfd,
+#endif
+    // 修改文件系统
+    SYS_unlinkat, SYS_linkat, SYS_symlinkat, SYS_mkdirat, SYS_mknodat,
+    SYS_fchmod, SYS_fchmodat, SYS_fchown, SYS_fchownat, SYS_truncate, SYS_ftruncate,
+    SYS_setxattr, SYS_lsetxattr, SYS_fsetxattr, SYS_removexattr, SYS_lremovexattr, SYS_fremovexattr,
+    SYS_name_to_handle_at, SYS_open_by_handle_at,
+#ifdef SYS_renameat
+    SYS_renameat,
+#endif
+#ifdef SYS_renameat2
+    SYS_renameat2,
+#endif
+#ifdef SYS_fchmodat2
+    SYS_fchmodat2,
+#endif
+#ifdef SYS_fchown32
+    SYS_fchown32, SYS_chown32, SYS_lchown32,
+#endif
+#ifdef SYS_openat2
+    SYS_openat2,
+#endif
+#ifdef SYS_unlink
+    SYS_unlink, SYS_rmdir, SYS_rename, SYS_link, SYS_symlink, SYS_mkdir, SYS_mknod,
+    SYS_chmod, SYS_chown, SYS_lchown, SYS_creat,
+#endif
+    // 命名空间和挂载
+    SYS_unshare, SYS_setns, SYS_mount, SYS_umount2, SYS_pivot_root, SYS_chroot,
+    // 内核接口
+    SYS_bpf, SYS_perf_event_open, SYS_keyctl, SYS_add_key, SYS_request_key, SYS_userfaultfd,
+    SYS_init_module, SYS_finit_module, SYS_delete_module, SYS_kexec_load,
+#ifdef SYS_io_uring_setup
+    SYS_io_uring_setup, SYS_io_uring_enter, SYS_io_uring_register,
+#endif
+};
+
+// 以写方式打开文件的标志
+static const quint32 kWriteOpenFlags = O_WRONLY | O_RDWR | O_CREAT | O_TRUNC | O_APPEND;
+
+// 用 BPF 指令拼出的 seccomp 过滤器，在子进程的栈上构造
+class SyscallFilter
+{
+public:
+    static const int kMaxInstructions = 256;
+
+    SyscallFilter() : size(0) {}
+
+    void loadSyscall() { add(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr))); }
+
+    // 第 index 个参数的低 32 位
+    void loadArgument(int index)
+    {
+        const quint32 low = Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 0 : 4;
+        add(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, quint32(offsetof(struct seccomp_data, args) + index * 8 + low)));
+    }
+
+    // 系统调用号不是 arch 架构的时结束进程（防止用另一种调用约定绕过过滤器）
+    void requireArch(quint32 arch)
+    {
+        add(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch)));
+        add(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, arch, 1, 0));
+#ifdef SECCOMP_RET_KILL_PROCESS
+        add(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+#else
+        add(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL));
+#endif
+    }
+
+    // 已载入系统调用号：不小于 nr 的调用号都拒绝
+    void denyFrom(quint32 nr)
+    {
+        add(BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, nr, 0, 1));
+        deny();
+    }
+
+    void deny(int nr)
+    {
+        add(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, quint32(nr), 0, 1));
+        deny();
+    }
+
+    // 第 index 个参数含有 flags 中的位时拒绝，否则允许
+    void denyFlags(int nr, int index, quint32 flags)
+    {
+        add(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, quint32(nr), 0, 4));
+        loadArgument(index);
+        add(BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, flags, 0, 1));
+        deny();
+        allow();
+    }
+
+    // 第 index 个参数等于 value 时允许，否则拒绝
+    void allowOnly(int nr, int index, quint32 value)
+    {
+        add(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, quint32(nr), 0, 4));
+        loadArgument(index);
+        add(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, value, 1, 0));
+        deny();
+        allow();
+    }
+
+    void allow() { add(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW)); }
+    void deny() { add(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | (EPERM & SECCOMP_RET_DATA))); }
+
+    bool install()
+    {
+        struct sock_fprog program;
+        program.len = size;
+        program.filter = code;
+        return prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program, 0, 0) == 0;
+    }
+
+private:
+    void add(const struct sock_filter& instruction) { code[size++] = instruction; }
+
+    struct sock_filter code[kMaxInstructions];
+    unsigned short size;
+};
+
+void installSyscallFilter()
+{
+    // 每个拒绝的调用两条指令，另外最多 40 条
+    static_assert(sizeof(kDeniedSyscalls) / sizeof(kDeniedSyscalls[0]) * 2 + 40 <= SyscallFilter::kMaxInstructions,
+                  "seccomp filter does not fit");
+    const quint32 pid = quint32(getpid());
+    SyscallFilter filter;
+    filter.requireArch(GRIDMAP_AUDIT_ARCH);
+    filter.loadSyscall();
+#ifdef __x86_64__
+    // x32 调用约定的系统调用号带 0x40000000
+    filter.denyFrom(0x40000000);
+#endif
+    for (int nr : kDeniedSyscalls) {
+        filter.deny(nr);
+    }
+    // 可以只读打开文件；信号只能发给自己（abort 等）
+#ifdef SYS_open
+    filter.denyFlags(SYS_open, 1, kWriteOpenFlags);
+#endif
+    filter.denyFlags(SYS_openat, 2, kWriteOpenFlags);
+    filter.allowOnly(SYS_kill, 0, pid);
+    filter.allowOnly(SYS_tkill, 0, pid);
+    filter.allowOnly(SYS_tgkill, 0, pid);
+    filter.allow();
+    filter.install();
+}
+#endif
+
+// 新的用户命名空间里的网络命名空间只有未启用的回环接口，连不上任何地址；
+// 系统禁用了非特权用户命名空间时跳过，seccomp 仍然拒绝创建套接字
+void isolateProcess()
+{
+    unshare(CLONE_NEWUSER | CLONE_NEWNET);
+    // 编辑器退出时工作进程随之结束
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+#ifdef GRIDMAP_AUDIT_ARCH
+    installSyscallFilter();
+#endif
+}
+#endif
+
+void applyResourceLimits()
+{
+    setLimit(RLIMIT_AS, rlim_t(kMemoryLimit));
+    setLimit(RLIMIT_FSIZE, 0);
+    setLimit(RLIMIT_CORE, 0);
+    setLimit(RLIMIT_NPROC, 0);
+#ifdef Q_OS_LINUX
+    isolateProcess();
+#endif
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+// Qt 5 没有 setChildProcessModifier，在 setupChildProcess 中设置限制
+class LimitedProcess : public QProcess
+{
+public:
+    explicit LimitedProcess(QObject *parent) : QProcess(parent) {}
+
+protected:
+    void setupChildProcess() override { applyResourceLimits(); }
+};
+#endif
+#endif
+
+QProcess* createProcess(QObject *parent)
+{
+#if defined(Q_OS_UNIX) && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    return new LimitedProcess(parent);
+#else
+    QProcess* process = new QProcess(parent);
+#ifdef Q_OS_UNIX
+    process->setChildProcessModifier(applyResourceLimits);
+#endif
+    return process;
+#endif
+}
+
+} // namespace
+
+SolverWorker::SolverWorker(QObject *parent)
+    : QObject(parent),
+      process(nullptr),
+      timeoutTimer(new QTimer(this)),
+      gridFile(nullptr),
+      gridMemory(nullptr),
+      gridCapacity(0),
+      sequence(0),
+      runs(0),
+      activeCommand(0),
+      headerReceived(false),
+      payloadBytes(0)
+{
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, &SolverWorker::onTimeout);
+}
+
+SolverWorker::~SolverWorker()
+{
+    stop();
+    releaseGridMemory();
+}
+
+bool SolverWorker::canLimitResources()
+{
+#ifdef Q_OS_UNIX
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SolverWorker::ensureGridMemory(qint64 cellCount, QString* error)
+{
+    if (gridMemory && gridCapacity >= cellCount) {
+        return true;
+    }
+    releaseGridMemory();
+
+    // Linux 上放在 /dev/shm（内存文件系统），其他平台放在临时目录，由系统页缓存共享
+    const QFileInfo shm(QStringLiteral("/dev/shm"));
+    const QString dir = shm.isDir() && shm.isWritable() ? shm.filePath() : QDir::tempPath();
+    const qint64 capacity = qint64(qNextPowerOfTwo(quint64(qMax<qint64>(cellCount, 4096))));
+    // 文件名随机，以独占方式（O_CREAT | O_EXCL）新建、只有当前用户能读写：
+    // 共享目录中别人预先放好的同名文件或符号链接不会被打开，换一个名字重试
+    gridFile = new QTemporaryFile(dir + QStringLiteral("/gridmap-XXXXXX.grid"), this);
+    if (!gridFile->open() || !gridFile->resize(capacity)) {
+        *error = gridFile->errorString();
+        releaseGridMemory();
+        return false;
+    }
+    gridMemory = gridFile->map(0, capacity);
+    if (!gridMemory) {
+        *error = gridFile->errorString();
+        releaseGridMemory();
+        return false;
+    }
+    gridCapacity = capacity;
+    return true;
+}
+
+void SolverWorker::releaseGridMemory()
+{
+    if (gridMemory) {
+        gridFile->unmap(gridMemory);
+        gridMemory = nullptr;
+    }
+    // QTemporaryFile 析构时关闭并删除文件；下次重新创建，不会以非独占方式再次打开同一个名字
+    delete gridFile;
+    gridFile = nullptr;
+    gridCapacity = 0;
+}
+
+bool SolverWorker::start(const QString& program,
+                         const QStringList& arguments,
+                         const QString& workingDirectory,
+                         qint64 cellCount,
+                         QString* error,
+                         const QProcessEnvironment& environment)
+{
+    GRIDMAP_TRACE_SCOPE("SolverWorker::start");
+    stop();
+    QString fileError;
+    if (!ensureGridMemory(cellCount, &fileError)) {
+        *error = tr("无法创建共享栅格：%1").arg(fileError);
+        return false;
+    }
+    QDir().mkpath(workingDirectory);
+
+    if (!canLimitResources()) {
+        static bool warned = false;
+        if (!warned) {
+            warned = true;
+            qWarning().noquote() << tr("当前平台不能限制求解子进程的内存和文件写入，用户代码只有超时保护。");
+        }
+    }
+
+    process = createProcess(this);
+    process->setProgram(program);
+    process->setArguments(QStringList(arguments)
+                          << QDir::toNativeSeparators(gridFile->fileName())
+                          << QString::number(gridCapacity));
+    process->setWorkingDirectory(workingDirectory);
+    // 不把编辑器的环境变量传给用户代码（至少放一个变量，空环境会被当作继承父进程的环境）
+    QProcessEnvironment workerEnvironment(environment);
+    workerEnvironment.insert(QStringLiteral("GRIDMAP_SOLVER_WORKER"), QStringLiteral("1"));
+#ifdef Q_OS_WIN
+    workerEnvironment.insert(QStringLiteral("SystemRoot"), qEnvironmentVariable("SystemRoot"));
+#endif
+    process->setProcessEnvironment(workerEnvironment);
+    connect(process, &QProcess::readyReadStandardOutput, this, &SolverWorker::onReadyRead);
+    connect(process, &QProcess::readyReadStandardError, this, &SolverWorker::collectOutput);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &SolverWorker::onProcessFinished);
+    process->start();
+    if (!process->waitForStarted(5000)) {
+        *error = tr("无法启动 %1：%2").arg(program, process->errorString());
+        stop();
+        return false;
+    }
+    runs = 0;
+    errorTail.clear();
+    return true;
+}
+
+void SolverWorker::stop()
+{
+    activeCommand = 0;
+    timeoutTimer->stop();
+    if (!process) {
+        return;
+    }
+    process->disconnect(this);
+    // 关闭标准输入后工作进程读到文件结束，自行退出
+    process->closeWriteChannel();
+    if (!process->waitForFinished(200)) {
+        process->kill();
+        process->waitForFinished(1000);
+    }
+    // 可能在这个进程的信号中调用，不能直接删除
+    process->deleteLater();
+    process = nullptr;
+}
+
+bool SolverWorker::isRunning() const
+{
+    return process && process->state() == QProcess::Running;
+}
+
+bool SolverWorker::needsRestart(qint64 cellCount) const
+{
+    return !isRunning() || cellCount > gridCapacity || runs >= kMaxRuns;
+}
+
+void SolverWorker::collectOutput()
+{
+    if (!process) {
+        return;
+    }
+    errorTail += process->readAllStandardError();
+    if (errorTail.size() > kErrorTailBytes) {
+        errorTail = errorTail.right(kErrorTailBytes);
+    }
+}
+
+bool SolverWorker::send(qint32 command, int rows, int cols, const QPoint& start, const QPoint& end,
+                        const QByteArray& payload, QString* error)
+{
+    if (!isRunning()) {
+        *error = tr("求解进程没有运行！");
+        return false;
+    }
+    if (isBusy()) {
+        *error = tr("求解进程正在处理上一个请求！");
+        return false;
+    }
+
+    WorkerRequest request;
+    request.magic = kRequestMagic;
+    request.command = command;
+    request.rows = rows;
+    request.cols = cols;
+    request.startX = start.x();
+    request.startY = start.y();
+    request.endX = end.x();
+    request.endY = end.y();
+    request.sequence = ++sequence;
+    request.payloadBytes = payload.size();
+    process->write(reinterpret_cast<const char*>(&request), sizeof(request));
+    if (!payload.isEmpty()) {
+        process->write(payload);
+    }
+    ++runs;
+
+    activeCommand = command;
+    headerReceived = false;
+    response = Response();
+    payloadBytes = 0;
+    timeoutTimer->start(kRunTimeoutMs);
+    return true;
+}
+
+void SolverWorker::onReadyRead()
+{
+    if (!isBusy()) {
+        // 没有请求时的输出不属于任何结果
+        process->readAllStandardOutput();
+        return;
+    }
+    if (!headerReceived) {
+        WorkerResponseHeader header;
+        if (process->bytesAvailable() < qint64(sizeof(header))) {
+            return;
+        }
+        process->read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (header.magic != kResponseMagic || header.sequence != sequence
+            || header.length < 0 || header.length > kMaxPayloadLength) {
+            failRequest(tr("求解进程返回了无法识别的结果。"));
+            return;
+        }
+        headerReceived = true;
+        response.status = header.status;
+        response.length = header.length;
+        response.setupNs = header.setupNs;
+        response.searchNs = header.searchNs;
+        payloadBytes = header.status == PathFound ? qint64(header.length) * 2 * sizeof(qint32)
+                     : header.status == UserError ? header.length : 0;
+    }
+    if (process->bytesAvailable() < payloadBytes) {
+        return;
+    }
+    response.payload = process->read(payloadBytes);
+    finishRequest();
+}
+
+void SolverWorker::onTimeout()
+{
+    if (isBusy()) {
+        failRequest(tr("用户代码运行超过 %1 秒，已终止。").arg(kRunTimeoutMs / 1000));
+    }
+}
+
+void SolverWorker::onProcessFinished()
+{
+    if (!isBusy()) {
+        return;
+    }
+    // 进程退出前写出的结果仍然有效
+    onReadyRead();
+    if (!isBusy()) {
+        return;
+    }
+    failRequest(process->exitStatus() == QProcess::CrashExit
+                    ? tr("用户代码异常退出（崩溃或超出内存限制）。")
+                    : tr("用户代码异常退出（退出码 %1）。").arg(process->exitCode()));
+}
+
+void SolverWorker::failRequest(const QString& message)
+{
+    collectOutput();
+    QString error = message;
+    if (!errorTail.trimmed().isEmpty()) {
+        error += tr("\n程序输出：\n%1").arg(QString::fromLocal8Bit(errorTail).trimmed());
+    }
+    stop();
+    emit finished(false, QList<QPoint>(), PathSearch::SearchStats(), error);
+}
+
+void SolverWorker::finishRequest()
+{
+    GRIDMAP_TRACE_SCOPE("SolverWorker::finishRequest");
+    const qint32 command = activeCommand;
+    activeCommand = 0;
+    timeoutTimer->stop();
+    collectOutput();
+
+    QList<QPoint> path;
+    PathSearch::SearchStats stats;
+    if (response.status == UserError) {
+        const QString message = QString::fromUtf8(response.payload).trimmed();
+        QString error = message;
+        if (command == Solve) {
+            error = message.isEmpty() ? tr("用户代码抛出了异常。") : tr("用户代码抛出了异常：\n%1").arg(message);
+        }
+        emit finished(false, path, stats, error);
+        return;
+    }
+
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+    if (response.status == PathFound) {
+        const qint32* points = reinterpret_cast<const qint32*>(response.payload.constData());
+        path.reserve(response.length);
+        for (int i = 0; i < response.length; ++i) {
+            path.append(QPoint(points[2 * i], points[2 * i + 1]));
+        }
+    }
+    response.payload.clear();
+
+    // 求解时间在子进程中测量；写栅格、子进程整理栅格和进程间往返计入准备阶段
+    stats.searchTimeNs = response.searchNs;
+    stats.reconstructionTimeNs = decodeTimer.nsecsElapsed();
+    stats.setupTimeNs = qMax<qint64>(0, requestTimer.nsecsElapsed() - stats.searchTimeNs - stats.reconstructionTimeNs);
+    emit finished(true, path, stats, QString());
+}
+
+bool SolverWorker::loadCode(const QByteArray& code, QString* error)
+{
+    GRIDMAP_TRACE_SCOPE("SolverWorker::loadCode");
+    requestTimer.start();
+    return send(LoadCode, 0, 0, QPoint(), QPoint(), code, error);
+}
+
+bool SolverWorker::solve(const GridMap& grid,
+                         const QPoint& start,
+                         const QPoint& end,
+                         QString* error)
+{
+    GRIDMAP_TRACE_SCOPE("SolverWorker::solve");
+    requestTimer.start();
+
+    const int rows = grid.rows();
+    const int cols = grid.cols();
+    if (qint64(rows) * cols > gridCapacity) {
+        *error = tr("栅格超出共享内存容量！");
+        return false;
+    }
+    if (isBusy()) {
+        *error = tr("求解进程正在处理上一个请求！");
+        return false;
+    }
+
+    // 写入共享栅格：0 可通行，1 不可通行，按行存放；直接从地图块读到共享内存，不经过中间的栅格
+    for (int y = 0; y < rows; ++y) {
+        uchar* target = gridMemory + qint64(y) * cols;
+        grid.readRow(y, target);
+        for (int x = 0; x < cols; ++x) {
+            target[x] = target[x] == GridMap::Obstacle ? 1 : 0;
+        }
+    }
+    return send(Solve, rows, cols, start, end, QByteArray(), error);
+}
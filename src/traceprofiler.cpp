@@ -0,0 +1,131 @@
+#include "../include/traceprofiler.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QHash>
+#include <QFile>
+#include <QThread>
+
+TraceProfiler::TraceProfiler()
+    : enabled(0), capacity(1 << 18), written(0)
+{
+    clock.start();
+}
+
+TraceProfiler& TraceProfiler::instance()
+{
+    static TraceProfiler profiler;
+    return profiler;
+}
+
+bool TraceProfiler::isCompiledIn()
+{
+#ifdef GRIDMAP_ENABLE_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TraceProfiler::setEnabled(bool enable)
+{
+    QMutexLocker locker(&mutex);
+    if (enable && events.size() != capacity) {
+        events = QVector<Event>(capacity);
+        written = 0;
+    }
+    enabled.storeRelaxed(enable ? 1 : 0);
+}
+
+void TraceProfiler::setCapacity(int eventCount)
+{
+    QMutexLocker locker(&mutex);
+    capacity = qMax(1, eventCount);
+    if (!events.isEmpty()) {
+        events = QVector<Event>(capacity);
+        written = 0;
+    }
+}
+
+void TraceProfiler::clear()
+{
+    QMutexLocker locker(&mutex);
+    written = 0;
+}
+
+bool TraceProfiler::hasRecords() const
+{
+    QMutexLocker locker(&mutex);
+    return written > 0 && !events.isEmpty();
+}
+
+void TraceProfiler::record(const char* name, qint64 startNs, qint64 durationNs)
+{
+    Event event;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    QMutexLocker locker(&mutex);
+    if (events.isEmpty()) {
+        return;
+    }
+    events[written % events.size()] = event;
+    ++written;
+}
+
+QByteArray TraceProfiler::toChromeTrace(qint64 windowNs) const
+{
+    const qint64 from = now() - windowNs;
+
+    // 先在锁内按写入顺序复制出时间窗口内的记录
+    QVector<Event> selected;
+    {
+        QMutexLocker locker(&mutex);
+        const quint64 size = events.size();
+        const quint64 count = qMin<quint64>(written, size);
+        selected.reserve(int(count));
+        for (quint64 i = written - count; i < written; ++i) {
+            const Event& event = events[int(i % size)];
+            if (event.startNs >= from) {
+                selected.append(event);
+            }
+        }
+    }
+
+    // 线程按首次出现的顺序编号，时间戳单位为微秒
+    QHash<quintptr, int> threadNumbers;
+    QJsonArray traceEvents;
+    for (const Event& event : selected) {
+        auto it = threadNumbers.constFind(event.threadId);
+        if (it == threadNumbers.constEnd()) {
+            it = threadNumbers.insert(event.threadId, threadNumbers.size() + 1);
+            traceEvents.append(QJsonObject{
+                {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", it.value()},
+                {"args", QJsonObject{{"name", QStringLiteral("thread %1").arg(it.value())}}}});
+        }
+        traceEvents.append(QJsonObject{
+            {"name", QString::fromUtf8(event.name)},
+            {"cat", "gridmap"},
+            {"ph", "X"},
+            {"ts", event.startNs / 1000.0},
+            {"dur", event.durationNs / 1000.0},
+            {"pid", 1},
+            {"tid", it.value()}});
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = traceEvents;
+    trace["displayTimeUnit"] = "ms";
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool TraceProfiler::save(const QString& filename, qint64 windowNs) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(toChromeTrace(windowNs)) >= 0;
+}
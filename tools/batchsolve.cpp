@@ -0,0 +1,414 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+#include <QStringList>
+#include "../include/pathsearch.h"
+#include "../include/gridmap.h"
+#include "../include/mapfile.h"
+
+// 批量寻路工具：读取地图文件和查询列表，在线程池上并行求解，按查询顺序输出JSON Lines
+// 示例：GridMapSolve --queries queries.jsonl --algorithm astar -j 8 -o results.jsonl
+//       GridMapSolve map/new_map1.json map/new_map2.json --algorithm all
+//
+// 查询文件每行一个JSON对象，空行和以 # 开头的行会被忽略：
+//   {"id": "q1", "map": "new_map1.json", "start": [0, 0], "end": [9, 9], "algorithm": "bfs"}
+// map 为相对路径时相对于查询文件所在目录；命令行只给出一张地图时可以省略 map；
+// start/end 也可以写成 {"x": 0, "y": 0}；algorithm 省略时使用 --algorithm。
+// 没有查询文件时，对命令行给出的每张地图求解其自身保存的起点到终点。
+
+namespace {
+
+struct LoadedMap {
+    QString name;                    // 输出中使用的路径（与输入一致）
+    QString filePath;
+    GridMap grid;                    // 格子按块存放，多个线程同时只读
+    QPoint startPos = QPoint(-1, -1);
+    QPoint endPos = QPoint(-1, -1);
+    QString error;                   // 非空表示读取失败
+};
+
+struct Query {
+    QString id;
+    int mapIndex = -1;
+    QPoint start = QPoint(-1, -1);
+    QPoint end = QPoint(-1, -1);
+    PathSearch::AlgorithmType algorithm = PathSearch::Unknown;
+    QString error;                   // 解析阶段的错误，非空时不求解
+};
+
+// 解析算法名称；"all" 展开为全部内置算法
+bool parseAlgorithms(const QString& text, QVector<PathSearch::AlgorithmType>* algorithms)
+{
+    const QString name = text.trimmed().toLower();
+    if (name == "all") {
+        *algorithms = {PathSearch::AStar, PathSearch::Dijkstra, PathSearch::BFS, PathSearch::DFS, PathSearch::DStar};
+    } else if (name == "astar" || name == "a*") {
+        *algorithms = {PathSearch::AStar};
+    } else if (name == "dijkstra") {
+        *algorithms = {PathSearch::Dijkstra};
+    } else if (name == "bfs") {
+        *algorithms = {PathSearch::BFS};
+    } else if (name == "dfs") {
+        *algorithms = {PathSearch::DFS};
+    } else if (name == "dstar" || name == "d*") {
+        *algorithms = {PathSearch::DStar};
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 坐标可以是 [x, y] 或 {"x": x, "y": y}
+bool parsePoint(const QJsonValue& value, QPoint* point)
+{
+    if (value.isArray()) {
+        const QJsonArray array = value.toArray();
+        if (array.size() != 2 || !array[0].isDouble() || !array[1].isDouble()) {
+            return false;
+        }
+        *point = QPoint(array[0].toInt(), array[1].toInt());
+        return true;
+    }
+    if (value.isObject()) {
+        const QJsonObject object = value.toObject();
+        if (!object["x"].isDouble() || !object["y"].isDouble()) {
+            return false;
+        }
+        *point = QPoint(object["x"].toInt(), object["y"].toInt());
+        return true;
+    }
+    return false;
+}
+
+class BatchSolver
+{
+public:
+    BatchSolver(int threads, bool writePaths, QTextStream& out)
+        : writePaths(writePaths), out(out)
+    {
+        if (threads > 0) {
+            pool.setMaxThreadCount(threads);
+        }
+    }
+
+    int threadCount() const { return pool.maxThreadCount(); }
+
+    // 同一文件只读取一次，返回地图下标
+    int addMap(const QString& name, const QString& filePath)
+    {
+        const QString key = QFileInfo(filePath).absoluteFilePath();
+        auto it = mapIndex.constFind(key);
+        if (it != mapIndex.constEnd()) {
+            return it.value();
+        }
+        LoadedMap map;
+        map.name = name;
+        map.filePath = filePath;
+        maps.append(map);
+        mapIndex.insert(key, maps.size() - 1);
+        return maps.size() - 1;
+    }
+
+    const LoadedMap& map(int index) const { return maps[index]; }
+    int mapCount() const { return maps.size(); }
+
+    void addQuery(const Query& query) { queries.append(query); }
+    int queryCount() const { return queries.size(); }
+
+    // 并行读取全部地图
+    void loadMaps()
+    {
+        LoadedMap* data = maps.data();
+        for (int i = 0; i < maps.size(); ++i) {
+            pool.start([data, i]() {
+                LoadedMap& map = data[i];
+                MapFile::GridData mapData;
+                if (!MapFile::load(map.filePath, &mapData, &map.error)) {
+                    if (map.error.isEmpty()) {
+                        map.error = QCoreApplication::translate("main", "无法读取地图文件");
+                    }
+                    return;
+                }
+                map.grid = mapData.grid;
+                map.startPos = mapData.startPos;
+                map.endPos = mapData.endPos;
+            });
+        }
+        pool.waitForDone();
+    }
+
+    // 并行求解全部查询；结果按查询顺序写出，已完成的连续前缀会立即写出
+    void solve()
+    {
+        pending = QVector<QByteArray>(queries.size());
+        ready = QVector<bool>(queries.size(), false);
+        nextToWrite = 0;
+
+        for (int i = 0; i < queries.size(); ++i) {
+            pool.start([this, i]() {
+                const QJsonObject record = solveQuery(i);
+                deliver(i, record["status"].toString(), QJsonDocument(record).toJson(QJsonDocument::Compact));
+            });
+        }
+        pool.waitForDone();
+        out.flush();
+    }
+
+    int count(const QString& status) const { return statusCounts.value(status); }
+
+private:
+    QJsonObject solveQuery(int index) const
+    {
+        const Query& query = queries[index];
+
+        QJsonObject record;
+        record["query"] = index;
+        if (!query.id.isEmpty()) {
+            record["id"] = query.id;
+        }
+        if (query.mapIndex >= 0) {
+            record["map"] = maps[query.mapIndex].name;
+        }
+        if (query.algorithm != PathSearch::Unknown) {
+            record["algorithm"] = PathSearch::algorithmName(query.algorithm);
+        }
+        record["start"] = QJsonArray{query.start.x(), query.start.y()};
+        record["end"] = QJsonArray{query.end.x(), query.end.y()};
+
+        auto invalid = [&record](const QString& message) {
+            record["status"] = "invalid";
+            record["error"] = message;
+            return record;
+        };
+
+        if (!query.error.isEmpty()) {
+            return invalid(query.error);
+        }
+        const LoadedMap& map = maps[query.mapIndex];
+        if (!map.error.isEmpty()) {
+            return invalid(map.error);
+        }
+        if (!map.grid.contains(query.start) || map.grid.isBlocked(query.start.x(), query.start.y())) {
+            return invalid(QCoreApplication::translate("main", "起点位置不可通行！"));
+        }
+        if (!map.grid.contains(query.end) || map.grid.isBlocked(query.end.x(), query.end.y())) {
+            return invalid(QCoreApplication::translate("main", "终点位置不可通行！"));
+        }
+
+        // 直接读取地图块；needsChunkedSearch 的大地图按块搜索，不展开整张栅格
+        PathSearch::SearchStats stats;
+        const QList<QPoint> path = PathSearch::runAlgorithm(query.algorithm, map.grid, query.start, query.end, &stats);
+
+        record["status"] = path.isEmpty() ? "no_path" : "ok";
+        record["pathLength"] = path.isEmpty() ? -1 : path.size() - 1;
+        record["nodesExpanded"] = stats.nodesExpanded;
+        record["nodesGenerated"] = stats.nodesGenerated;
+        record["peakOpenSize"] = stats.peakOpenSize;
+        record["workspaceBytes"] = double(stats.workspaceBytes);
+        record["setupNs"] = double(stats.setupTimeNs);
+        record["searchNs"] = double(stats.searchTimeNs);
+        record["reconstructionNs"] = double(stats.reconstructionTimeNs);
+        if (writePaths && !path.isEmpty()) {
+            QJsonArray points;
+            for (const QPoint& point : path) {
+                points.append(QJsonArray{point.x(), point.y()});
+            }
+            record["path"] = points;
+        }
+        return record;
+    }
+
+    void deliver(int index, const QString& status, const QByteArray& line)
+    {
+        QMutexLocker locker(&outputMutex);
+        statusCounts[status] += 1;
+        pending[index] = line;
+        ready[index] = true;
+        while (nextToWrite < pending.size() && ready[nextToWrite]) {
+            out << pending[nextToWrite] << '\n';
+            pending[nextToWrite].clear();
+            ++nextToWrite;
+        }
+    }
+
+    bool writePaths;
+    QTextStream& out;
+    QThreadPool pool;
+    QVector<LoadedMap> maps;
+    QHash<QString, int> mapIndex;
+    QVector<Query> queries;
+
+    QMutex outputMutex;               // 保护以下输出状态
+    QVector<QByteArray> pending;
+    QVector<bool> ready;
+    int nextToWrite = 0;
+    QHash<QString, int> statusCounts;
+};
+
+// 读取查询文件；返回 false 表示文件无法打开
+bool readQueries(const QString& fileName, const QVector<PathSearch::AlgorithmType>& defaultAlgorithms,
+                 int defaultMap, BatchSolver* solver, QTextStream& err)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        err << QCoreApplication::translate("main", "无法打开查询文件: %1").arg(fileName) << Qt::endl;
+        return false;
+    }
+    const QDir baseDir = QFileInfo(fileName).absoluteDir();
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        Query query;
+        QVector<PathSearch::AlgorithmType> algorithms = defaultAlgorithms;
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        const QJsonObject object = doc.object();
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            query.error = QCoreApplication::translate("main", "第 %1 行不是有效的JSON对象").arg(lineNumber);
+        } else {
+            query.id = object["id"].toVariant().toString();
+            if (object.contains("map")) {
+                const QString mapName = object["map"].toString();
+                query.mapIndex = solver->addMap(mapName, QDir::isAbsolutePath(mapName) ? mapName
+                                                                                      : baseDir.filePath(mapName));
+            } else {
+                query.mapIndex = defaultMap;
+            }
+
+            if (query.mapIndex < 0) {
+                query.error = QCoreApplication::translate("main", "第 %1 行缺少 map").arg(lineNumber);
+            } else if (!parsePoint(object["start"], &query.start) || !parsePoint(object["end"], &query.end)) {
+                query.error = QCoreApplication::translate("main", "第 %1 行的 start 或 end 无效").arg(lineNumber);
+            } else if (object.contains("algorithm") && !parseAlgorithms(object["algorithm"].toString(), &algorithms)) {
+                query.error = QCoreApplication::translate("main", "第 %1 行的算法未知: %2")
+                                  .arg(lineNumber).arg(object["algorithm"].toString());
+            }
+        }
+
+        if (!query.error.isEmpty()) {
+            solver->addQuery(query);
+            continue;
+        }
+        for (PathSearch::AlgorithmType algorithm : algorithms) {
+            query.algorithm = algorithm;
+            solver->addQuery(query);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("GridMapSolve");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "批量求解寻路查询，结果按查询顺序输出为JSON Lines"));
+    parser.addHelpOption();
+    parser.addPositionalArgument("maps", QCoreApplication::translate("main", "地图文件"), "[maps...]");
+
+    QCommandLineOption queriesOption({"q", "queries"}, QCoreApplication::translate("main", "查询文件（JSON Lines）"), "file");
+    QCommandLineOption algorithmOption({"a", "algorithm"},
+                                       QCoreApplication::translate("main", "默认算法：astar | dijkstra | bfs | dfs | dstar | all"),
+                                       "name", "astar");
+    QCommandLineOption threadsOption({"j", "threads"}, QCoreApplication::translate("main", "线程数（0 为全部核心）"), "n", "0");
+    QCommandLineOption outputOption({"o", "output"}, QCoreApplication::translate("main", "结果输出文件（默认标准输出）"), "file");
+    QCommandLineOption noPathOption("no-path", QCoreApplication::translate("main", "只输出统计信息，不输出路径坐标"));
+    parser.addOptions({queriesOption, algorithmOption, threadsOption, outputOption, noPathOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    QVector<PathSearch::AlgorithmType> algorithms;
+    if (!parseAlgorithms(parser.value(algorithmOption), &algorithms)) {
+        err << QCoreApplication::translate("main", "未知的算法: %1").arg(parser.value(algorithmOption)) << Qt::endl;
+        return 2;
+    }
+
+    const QStringList mapFiles = parser.positionalArguments();
+    if (mapFiles.isEmpty() && !parser.isSet(queriesOption)) {
+        parser.showHelp(2);
+    }
+
+    QFile outputFile;
+    QTextStream out(stdout);
+    if (parser.isSet(outputOption)) {
+        outputFile.setFileName(parser.value(outputOption));
+        if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            err << QCoreApplication::translate("main", "无法写入输出文件: %1").arg(outputFile.fileName()) << Qt::endl;
+            return 2;
+        }
+        out.setDevice(&outputFile);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    BatchSolver solver(parser.value(threadsOption).toInt(), !parser.isSet(noPathOption), out);
+    // 同一文件（包括同一路径的不同写法）只登记一次，按命令行位置记下各自的地图下标
+    QVector<int> fileMaps;
+    for (const QString& fileName : mapFiles) {
+        fileMaps.append(solver.addMap(fileName, fileName));
+    }
+
+    // 查询文件中引用的地图在读取查询时登记，随后一起并行读取
+    if (parser.isSet(queriesOption)) {
+        const int defaultMap = fileMaps.size() == 1 ? fileMaps.first() : -1;
+        if (!readQueries(parser.value(queriesOption), algorithms, defaultMap, &solver, err)) {
+            return 2;
+        }
+    }
+    solver.loadMaps();
+
+    for (int i = 0; i < solver.mapCount(); ++i) {
+        if (!solver.map(i).error.isEmpty()) {
+            err << QCoreApplication::translate("main", "无法读取地图 %1: %2")
+                       .arg(solver.map(i).name, solver.map(i).error) << Qt::endl;
+        }
+    }
+
+    // 没有查询文件：求解每张地图自身保存的起点和终点
+    if (!parser.isSet(queriesOption)) {
+        for (int mapIndex : fileMaps) {
+            const LoadedMap& map = solver.map(mapIndex);
+            Query query;
+            query.mapIndex = mapIndex;
+            query.start = map.startPos;
+            query.end = map.endPos;
+            if (map.error.isEmpty() && (query.start == QPoint(-1, -1) || query.end == QPoint(-1, -1))) {
+                query.error = QCoreApplication::translate("main", "地图没有起点或终点");
+            }
+            for (PathSearch::AlgorithmType algorithm : algorithms) {
+                query.algorithm = algorithm;
+                solver.addQuery(query);
+            }
+        }
+    }
+
+    solver.solve();
+
+    err << QCoreApplication::translate("main", "已求解 %1 个查询：%2 条路径，%3 个无路径，%4 个无效；用时 %5 ms（%6 线程）")
+               .arg(solver.queryCount()).arg(solver.count("ok")).arg(solver.count("no_path"))
+               .arg(solver.count("invalid")).arg(timer.elapsed()).arg(solver.threadCount()) << Qt::endl;
+
+    return solver.count("invalid") == 0 ? 0 : 1;
+}
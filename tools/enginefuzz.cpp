@@ -0,0 +1,515 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QRandomGenerator>
+#include <QDir>
+#include <QQueue>
+#include "../include/pathsearch.h"
+#include "../include/pathscript.h"
+#include "../include/gridmap.h"
+#include "../include/obstaclegenerator.h"
+#include "../include/mapdatasetgenerator.h"
+#include "../include/mapfile.h"
+
+// 差分模糊测试：用随机障碍生成器生成地图，运行全部内置算法并与参考BFS比较
+// 路径按 GridEditor::executePathfinding 的规则检查（起终点、越界、障碍、相邻步），
+// 最优算法还要求路径长度等于BFS最短距离；另外三种格子存放方式（按行、按小块、按地图块）的路径和计数必须相同
+// 寻路规则（PathScript）同样检查：曼哈顿启发得到最短路径，启发为 0 时路径和扩展节点数与 Dijkstra 相同；
+// 开始前还检查一组编译错误和运行错误报告的行号
+// 发现差异时缩小地图并写出可复现的地图文件
+// 示例：GridMapFuzz --iterations 2000 --seed 1 --max-size 48 -o fuzz_repro
+
+namespace {
+
+struct FuzzCase {
+    QVector<QVector<int>> grid;   // 0-可通行，1-障碍
+    QPoint start;
+    QPoint end;
+};
+
+struct Failure {
+    PathSearch::AlgorithmType algorithm = PathSearch::Unknown;
+    int script = -1;               // 寻路规则在 kScripts 中的下标，内置算法为 -1
+    QString message;
+    bool isEmpty() const { return message.isEmpty(); }
+};
+
+const PathSearch::AlgorithmType kEngines[] = {
+    PathSearch::AStar, PathSearch::Dijkstra, PathSearch::BFS, PathSearch::DFS, PathSearch::DStar
+};
+
+// 只影响访存的格子存放方式，与按行存放比较
+const PathSearch::CellLayout kOtherLayouts[] = {PathSearch::TiledLayout, PathSearch::ChunkedLayout};
+
+QString layoutKey(PathSearch::CellLayout layout)
+{
+    return layout == PathSearch::TiledLayout ? QStringLiteral("tiled") : QStringLiteral("chunked");
+}
+
+// 随机地图上运行的寻路规则；reference 不是 Unknown 时路径和扩展节点数必须与这个内置算法相同
+struct ScriptCase {
+    const char* key;
+    const char* source;
+    PathSearch::AlgorithmType reference;
+};
+
+const ScriptCase kScripts[] = {
+    // 默认 priority = g + h，曼哈顿距离不超过真实代价，路径最短
+    {"script-manhattan", "heuristic = dx + dy", PathSearch::Unknown},
+    // priority = g，先进先出，与 Dijkstra 的扩展顺序相同
+    {"script-dijkstra", "heuristic = 0", PathSearch::Dijkstra},
+};
+
+// 编译或运行时出错的规则，错误信息必须以 "第 line 行" 开头
+struct ScriptErrorCase {
+    const char* source;
+    int line;
+    bool runtime;                  // 编译成功、运行时才出错
+};
+
+const ScriptErrorCase kScriptErrors[] = {
+    {"heuristic = dx +", 1, false},
+    {"# 注释\n\ncost = 1 + foo", 3, false},
+    {"heuristic = dx\n// 注释\nheuristic = dy", 3, false},
+    {"cost = 1\norder = random", 2, false},
+    {"tie = h\n\n\ncost = h + 1", 4, false},
+    {"priority = g\nheuristic = (dx + dy", 2, false},
+    {"heuristic = dx\n  speed = 2", 2, false},
+    {"heuristic = dx + dy\ncost = x - x", 2, true},
+};
+
+// 四连通、单位代价下这些算法必须给出最短路径
+bool isOptimal(PathSearch::AlgorithmType algorithm)
+{
+    return algorithm != PathSearch::DFS;
+}
+
+// 参考实现：最简单的BFS，返回最短路径的步数，不连通返回 -1
+int referenceDistance(const FuzzCase& c)
+{
+    const int rows = c.grid.size();
+    const int cols = c.grid[0].size();
+    QVector<int> dist(rows * cols, -1);
+    QQueue<QPoint> queue;
+    dist[c.start.y() * cols + c.start.x()] = 0;
+    queue.enqueue(c.start);
+    const QPoint directions[] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    while (!queue.isEmpty()) {
+        const QPoint current = queue.dequeue();
+        const int d = dist[current.y() * cols + current.x()];
+        if (current == c.end) {
+            return d;
+        }
+        for (const QPoint& dir : directions) {
+            const QPoint next = current + dir;
+            if (next.x() < 0 || next.x() >= cols || next.y() < 0 || next.y() >= rows
+                || c.grid[next.y()][next.x()] != 0 || dist[next.y() * cols + next.x()] >= 0) {
+                continue;
+            }
+            dist[next.y() * cols + next.x()] = d + 1;
+            queue.enqueue(next);
+        }
+    }
+    return -1;
+}
+
+// 与 GridEditor::executePathfinding 相同的路径检查，返回错误描述
+QString validatePath(const FuzzCase& c, const QList<QPoint>& path)
+{
+    const int rows = c.grid.size();
+    const int cols = c.grid[0].size();
+    if (path.first() != c.start || path.last() != c.end) {
+        return QStringLiteral("path does not run from start to end");
+    }
+    for (int i = 0; i < path.size(); ++i) {
+        const QPoint& pos = path[i];
+        if (pos.x() < 0 || pos.x() >= cols || pos.y() < 0 || pos.y() >= rows) {
+            return QStringLiteral("invalid coordinate (%1, %2)").arg(pos.x()).arg(pos.y());
+        }
+        if (i > 0 && i < path.size() - 1 && c.grid[pos.y()][pos.x()] != 0) {
+            return QStringLiteral("path crosses obstacle (%1, %2)").arg(pos.x()).arg(pos.y());
+        }
+        if (i > 0) {
+            const QPoint& prev = path[i - 1];
+            if (qAbs(pos.x() - prev.x()) + qAbs(pos.y() - prev.y()) != 1) {
+                return QStringLiteral("discontinuous step (%1, %2) -> (%3, %4)")
+                    .arg(prev.x()).arg(prev.y()).arg(pos.x()).arg(pos.y());
+            }
+        }
+    }
+    return QString();
+}
+
+// 路径与参考距离比较：可达性一致、路径合法，optimal 时长度等于最短距离
+QString checkPath(const FuzzCase& c, const QList<QPoint>& path, bool optimal, int expected)
+{
+    if (path.isEmpty()) {
+        return expected >= 0 ? QStringLiteral("no path, reference distance %1").arg(expected) : QString();
+    }
+    if (expected < 0) {
+        return QStringLiteral("found a path of length %1 but end is unreachable").arg(path.size() - 1);
+    }
+    QString message = validatePath(c, path);
+    if (message.isEmpty() && optimal && path.size() - 1 != expected) {
+        message = QStringLiteral("path length %1, shortest %2").arg(path.size() - 1).arg(expected);
+    }
+    return message;
+}
+
+// 运行一个算法并与参考距离比较
+Failure checkEngine(const FuzzCase& c, PathSearch::AlgorithmType algorithm, int expected)
+{
+    Failure failure;
+    failure.algorithm = algorithm;
+
+    PathSearch::SearchStats stats;
+    const QList<QPoint> path = PathSearch::runAlgorithm(algorithm, c.grid, c.start, c.end, &stats);
+    for (PathSearch::CellLayout layout : kOtherLayouts) {
+        PathSearch::SearchStats layoutStats;
+        const QList<QPoint> layoutPath = PathSearch::runAlgorithm(algorithm, c.grid, c.start, c.end,
+                                                                  &layoutStats, nullptr, layout);
+        if (layoutPath != path) {
+            failure.message = QStringLiteral("%1 layout path differs from rowmajor").arg(layoutKey(layout));
+        } else if (layoutStats.nodesExpanded != stats.nodesExpanded
+                   || layoutStats.nodesGenerated != stats.nodesGenerated) {
+            failure.message = QStringLiteral("%1 layout expanded/generated %2/%3, rowmajor %4/%5")
+                                  .arg(layoutKey(layout))
+                                  .arg(layoutStats.nodesExpanded).arg(layoutStats.nodesGenerated)
+                                  .arg(stats.nodesExpanded).arg(stats.nodesGenerated);
+        }
+        if (!failure.isEmpty()) {
+            return failure;
+        }
+    }
+    failure.message = checkPath(c, path, isOptimal(algorithm), expected);
+    return failure;
+}
+
+// 运行一个寻路规则并与参考距离（和对应的内置算法）比较
+Failure checkScript(const FuzzCase& c, int script, int expected)
+{
+    Failure failure;
+    failure.algorithm = PathSearch::Script;
+    failure.script = script;
+
+    const ScriptCase& scriptCase = kScripts[script];
+    PathScript pathScript;
+    QString error;
+    if (!pathScript.compile(QString::fromUtf8(scriptCase.source), &error)) {
+        failure.message = QStringLiteral("compile error: %1").arg(error);
+        return failure;
+    }
+    QList<QPoint> path;
+    PathSearch::SearchStats stats;
+    if (!pathScript.run(GridMap::fromCells(c.grid).snapshot(), c.start, c.end, &path, &stats, nullptr, &error)) {
+        failure.message = QStringLiteral("run error: %1").arg(error);
+        return failure;
+    }
+    if (scriptCase.reference != PathSearch::Unknown) {
+        PathSearch::SearchStats referenceStats;
+        const QList<QPoint> referencePath = PathSearch::runAlgorithm(scriptCase.reference, c.grid, c.start, c.end,
+                                                                     &referenceStats);
+        if (path != referencePath) {
+            failure.message = QStringLiteral("path differs from %1").arg(PathSearch::algorithmName(scriptCase.reference));
+        } else if (stats.nodesExpanded != referenceStats.nodesExpanded) {
+            failure.message = QStringLiteral("expanded %1, %2 expanded %3")
+                                  .arg(stats.nodesExpanded)
+                                  .arg(PathSearch::algorithmName(scriptCase.reference))
+                                  .arg(referenceStats.nodesExpanded);
+        }
+        if (!failure.isEmpty()) {
+            return failure;
+        }
+    }
+    failure.message = checkPath(c, path, true, expected);
+    return failure;
+}
+
+// 重新运行出错的同一个算法或寻路规则
+Failure recheck(const FuzzCase& c, const Failure& failure, int expected)
+{
+    return failure.script >= 0 ? checkScript(c, failure.script, expected) : checkEngine(c, failure.algorithm, expected);
+}
+
+Failure checkCase(const FuzzCase& c)
+{
+    const int expected = referenceDistance(c);
+    for (PathSearch::AlgorithmType algorithm : kEngines) {
+        Failure failure = checkEngine(c, algorithm, expected);
+        if (!failure.isEmpty()) {
+            return failure;
+        }
+    }
+    for (int script = 0; script < int(sizeof(kScripts) / sizeof(kScripts[0])); ++script) {
+        Failure failure = checkScript(c, script, expected);
+        if (!failure.isEmpty()) {
+            return failure;
+        }
+    }
+    return Failure();
+}
+
+// 编译错误和运行错误报告的行号，返回出错的数量
+int checkScriptErrors(QTextStream& err)
+{
+    const GridSnapshot grid = GridMap(4, 4).snapshot();
+    int failures = 0;
+    for (const ScriptErrorCase& errorCase : kScriptErrors) {
+        const QString source = QString::fromUtf8(errorCase.source);
+        PathScript pathScript;
+        QString error;
+        const bool compiled = pathScript.compile(source, &error);
+        bool failed = !compiled;
+        if (compiled && errorCase.runtime) {
+            QList<QPoint> path;
+            failed = !pathScript.run(grid, QPoint(0, 0), QPoint(3, 3), &path, nullptr, nullptr, &error);
+        }
+        // 运行错误要求编译通过，编译错误要求编译失败
+        const bool expectedStage = errorCase.runtime ? compiled : !compiled;
+        if (failed && expectedStage && error.startsWith(PathScript::tr("第 %1 行").arg(errorCase.line))) {
+            continue;
+        }
+        ++failures;
+        err << "FAIL script \"" << QString(source).replace(QLatin1Char('\n'), QLatin1String("\\n")) << "\": expected "
+            << (errorCase.runtime ? "run" : "compile") << " error at line " << errorCase.line
+            << ", got " << (failed ? error : QStringLiteral("no error")) << Qt::endl;
+    }
+    return failures;
+}
+
+// 第 index 个用例：种子由基础种子派生，任意一个用例都可以单独复现
+FuzzCase generateCase(quint64 baseSeed, int index, int maxSize)
+{
+    const quint64 seed = MapDatasetGenerator::mapSeed(baseSeed, index);
+    const quint32 seedWords[2] = {static_cast<quint32>(seed), static_cast<quint32>(seed >> 32)};
+    QRandomGenerator generator(seedWords, 2);
+
+    const int rows = 2 + generator.bounded(qMax(1, maxSize - 1));
+    const int cols = 2 + generator.bounded(qMax(1, maxSize - 1));
+    const QPoint start(generator.bounded(cols), generator.bounded(rows));
+    QPoint end;
+    do {
+        end = QPoint(generator.bounded(cols), generator.bounded(rows));
+    } while (end == start);
+
+    // 大部分用例使用随机噪声（覆盖三种连通性），其余使用程序化生成
+    ObstacleGenerator obstacleGenerator(rows, cols, start, end);
+    const double density = generator.bounded(0.6);
+    if (generator.bounded(10) < 7) {
+        const int connectivityType = generator.bounded(3);
+        const int pathCount = 1 + generator.bounded(3);
+        obstacleGenerator.generate(density, connectivityType, pathCount, &generator);
+    } else {
+        const int pattern = 1 + generator.bounded(3);
+        obstacleGenerator.generatePattern(pattern, density, &generator);
+    }
+
+    FuzzCase c;
+    c.start = start;
+    c.end = end;
+    c.grid = QVector<QVector<int>>(rows, QVector<int>(cols, 0));
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            c.grid[y][x] = obstacleGenerator.isObstacle(x, y) ? 1 : 0;
+        }
+    }
+    return c;
+}
+
+FuzzCase removeRow(const FuzzCase& c, int row)
+{
+    FuzzCase result = c;
+    result.grid.removeAt(row);
+    if (result.start.y() > row) {
+        result.start.ry() -= 1;
+    }
+    if (result.end.y() > row) {
+        result.end.ry() -= 1;
+    }
+    return result;
+}
+
+FuzzCase removeColumn(const FuzzCase& c, int col)
+{
+    FuzzCase result = c;
+    for (QVector<int>& line : result.grid) {
+        line.removeAt(col);
+    }
+    if (result.start.x() > col) {
+        result.start.rx() -= 1;
+    }
+    if (result.end.x() > col) {
+        result.end.rx() -= 1;
+    }
+    return result;
+}
+
+// 贪心缩小：删除不含起终点的行和列、清除障碍，只要同一个算法（或寻路规则）仍然出错就保留修改
+FuzzCase shrink(FuzzCase c, const Failure& failure)
+{
+    auto stillFails = [&failure](const FuzzCase& candidate) {
+        return !recheck(candidate, failure, referenceDistance(candidate)).isEmpty();
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int row = c.grid.size() - 1; row >= 0 && c.grid.size() > 1; --row) {
+            if (row == c.start.y() || row == c.end.y()) {
+                continue;
+            }
+            FuzzCase candidate = removeRow(c, row);
+            if (stillFails(candidate)) {
+                c = candidate;
+                changed = true;
+            }
+        }
+        for (int col = c.grid[0].size() - 1; col >= 0 && c.grid[0].size() > 1; --col) {
+            if (col == c.start.x() || col == c.end.x()) {
+                continue;
+            }
+            FuzzCase candidate = removeColumn(c, col);
+            if (stillFails(candidate)) {
+                c = candidate;
+                changed = true;
+            }
+        }
+        for (int y = 0; y < c.grid.size(); ++y) {
+            for (int x = 0; x < c.grid[y].size(); ++x) {
+                if (c.grid[y][x] == 0) {
+                    continue;
+                }
+                FuzzCase candidate = c;
+                candidate.grid[y][x] = 0;
+                if (stillFails(candidate)) {
+                    c = candidate;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return c;
+}
+
+MapFile::MapData toMapData(const FuzzCase& c)
+{
+    MapFile::MapData map;
+    map.rows = c.grid.size();
+    map.cols = c.grid[0].size();
+    map.cells = c.grid;
+    map.cells[c.start.y()][c.start.x()] = 2;
+    map.cells[c.end.y()][c.end.x()] = 3;
+    map.startPos = c.start;
+    map.endPos = c.end;
+    return map;
+}
+
+// 复现文件名中使用的算法标识
+QString engineKey(PathSearch::AlgorithmType algorithm)
+{
+    switch (algorithm) {
+        case PathSearch::AStar:
+            return QStringLiteral("astar");
+        case PathSearch::Dijkstra:
+            return QStringLiteral("dijkstra");
+        case PathSearch::BFS:
+            return QStringLiteral("bfs");
+        case PathSearch::DFS:
+            return QStringLiteral("dfs");
+        case PathSearch::DStar:
+            return QStringLiteral("dstar");
+        default:
+            return QStringLiteral("unknown");
+    }
+}
+
+// 输出和复现文件名中使用的名称：内置算法为算法名和算法标识，寻路规则为 kScripts 中的标识
+QString failureName(const Failure& failure)
+{
+    return failure.script >= 0 ? QString::fromLatin1(kScripts[failure.script].key)
+                               : PathSearch::algorithmName(failure.algorithm);
+}
+
+QString failureKey(const Failure& failure)
+{
+    return failure.script >= 0 ? QString::fromLatin1(kScripts[failure.script].key) : engineKey(failure.algorithm);
+}
+
+// 文本形式：# 障碍，S 起点，E 终点
+QString toAscii(const FuzzCase& c)
+{
+    QString text;
+    for (int y = 0; y < c.grid.size(); ++y) {
+        for (int x = 0; x < c.grid[y].size(); ++x) {
+            const QPoint pos(x, y);
+            text += pos == c.start ? 'S' : pos == c.end ? 'E' : c.grid[y][x] != 0 ? '#' : '.';
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("GridMapFuzz");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "内置寻路算法和寻路规则的差分模糊测试（以BFS为参考）"));
+    parser.addHelpOption();
+
+    QCommandLineOption iterationsOption({"n", "iterations"}, QCoreApplication::translate("main", "用例数量"), "n", "2000");
+    QCommandLineOption seedOption("seed", QCoreApplication::translate("main", "基础随机种子"), "seed", "1");
+    QCommandLineOption maxSizeOption("max-size", QCoreApplication::translate("main", "地图最大边长"), "n", "48");
+    QCommandLineOption outputOption({"o", "output"}, QCoreApplication::translate("main", "复现地图的输出目录"), "dir",
+                                    "fuzz_repro");
+    QCommandLineOption maxFailuresOption("max-failures", QCoreApplication::translate("main", "发现多少个差异后停止"), "n", "5");
+    parser.addOptions({iterationsOption, seedOption, maxSizeOption, outputOption, maxFailuresOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const quint64 baseSeed = parser.value(seedOption).toULongLong();
+    const int maxSize = qMax(2, parser.value(maxSizeOption).toInt());
+    const int maxFailures = qMax(1, parser.value(maxFailuresOption).toInt());
+    const QDir outputDir(parser.value(outputOption));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 规则的编译错误与地图无关，只检查一次
+    int failures = checkScriptErrors(err);
+    int checked = 0;
+    for (int index = 0; index < iterations && failures < maxFailures; ++index) {
+        const FuzzCase c = generateCase(baseSeed, index, maxSize);
+        ++checked;
+        const Failure failure = checkCase(c);
+        if (failure.isEmpty()) {
+            continue;
+        }
+
+        ++failures;
+        const FuzzCase minimal = shrink(c, failure);
+        const Failure minimalFailure = recheck(minimal, failure, referenceDistance(minimal));
+        const QString fileName = outputDir.filePath(QStringLiteral("case_%1_%2.json")
+                                                       .arg(index).arg(failureKey(failure)));
+        QDir().mkpath(outputDir.path());
+        const bool saved = MapFile::save(fileName, toMapData(minimal));
+
+        err << "FAIL case " << index << " (seed " << baseSeed << ") "
+            << failureName(failure) << ": " << failure.message << Qt::endl;
+        err << "  minimal " << minimal.grid.size() << "x" << minimal.grid[0].size() << ": "
+            << minimalFailure.message << Qt::endl;
+        err << toAscii(minimal);
+        err << "  " << (saved ? fileName : QCoreApplication::translate("main", "无法写入复现地图 %1").arg(fileName))
+            << Qt::endl;
+    }
+
+    err << QCoreApplication::translate("main", "已检查 %1 个用例，%2 个差异，用时 %3 ms")
+               .arg(checked).arg(failures).arg(timer.elapsed()) << Qt::endl;
+    return failures == 0 ? 0 : 1;
+}
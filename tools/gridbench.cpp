@@ -0,0 +1,432 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QHash>
+#include <QStringList>
+#include <algorithm>
+#include <functional>
+#include "../include/pathsearch.h"
+#include "../include/obstaclegenerator.h"
+#include "../include/mapfile.h"
+
+// 性能基准工具：对全部内置算法和地图生成器计时，每个用例输出一行JSON（JSON Lines）
+// 示例：GridMapBench --sizes 64,256,1024 --densities 0.2,0.3 --map-dir map -o bench.jsonl
+//       GridMapBench --maps-only --map-dir map --compare bench/baseline_maps.jsonl
+//       GridMapBench --sizes 2048,8192 --densities 0.1 --layouts rowmajor,tiled   （比较两种格子存放方式）
+
+namespace {
+
+// 与基准比较时必须完全一致的字段（与机器无关的计数）
+const char* const kExactFields[] = {"status", "rows", "cols", "obstacles", "connected", "nodesExpanded",
+                                    "nodesGenerated", "peakOpenSize", "pathLength"};
+
+// 基准中位耗时低于这个值的记录只比较计数：示例地图只要几微秒，计时误差比回归还大
+const double kMinTimedNs = 1e6;
+
+struct BenchSettings {
+    int repeat = 3;
+    qint64 budgetNs = 2000000000LL;   // 单个用例超过预算后，同一系列更大的尺寸不再运行
+    quint32 seed = 12345;
+    QList<PathSearch::CellLayout> layouts = {PathSearch::RowMajorLayout};
+};
+
+const char* layoutName(PathSearch::CellLayout layout)
+{
+    return layout == PathSearch::TiledLayout ? "tiled" : "rowmajor";
+}
+
+struct Timing {
+    qint64 minNs = 0;
+    qint64 medianNs = 0;
+    int runs = 0;
+};
+
+// 重复运行 body，返回最短和中位耗时；累计时间超过预算后提前结束
+Timing measure(const BenchSettings& settings, const std::function<void()>& body)
+{
+    QVector<qint64> samples;
+    qint64 total = 0;
+    for (int i = 0; i < settings.repeat; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        qint64 elapsed = timer.nsecsElapsed();
+        samples.append(elapsed);
+        total += elapsed;
+        if (total > settings.budgetNs) {
+            break;
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Timing timing;
+    timing.runs = samples.size();
+    timing.minNs = samples.first();
+    timing.medianNs = samples[samples.size() / 2];
+    return timing;
+}
+
+QVector<QVector<int>> toEngineGrid(const QVector<QVector<int>>& cells)
+{
+    // 与 GridMap::toSearchGrid 一致：只有障碍不可通行
+    QVector<QVector<int>> grid(cells.size());
+    for (int i = 0; i < cells.size(); ++i) {
+        grid[i].resize(cells[i].size());
+        for (int j = 0; j < cells[i].size(); ++j) {
+            grid[i][j] = cells[i][j] == 1 ? 1 : 0;
+        }
+    }
+    return grid;
+}
+
+class Bench
+{
+public:
+    Bench(const BenchSettings& settings, QTextStream& out)
+        : settings(settings), out(out)
+    {
+    }
+
+    const QVector<QJsonObject>& records() const { return results; }
+
+    void runEngines(const QString& caseName, const QVector<QVector<int>>& grid,
+                    const QPoint& start, const QPoint& end, const QString& series)
+    {
+        const QList<PathSearch::AlgorithmType> engines = {
+            PathSearch::AStar, PathSearch::Dijkstra, PathSearch::BFS, PathSearch::DFS, PathSearch::DStar};
+
+        for (PathSearch::AlgorithmType algorithm : engines) {
+            for (PathSearch::CellLayout layout : settings.layouts) {
+                runEngine(algorithm, layout, caseName, grid, start, end, series);
+            }
+        }
+    }
+
+    // 生成一张地图并计时；返回生成的格子状态，供算法基准复用
+    QVector<QVector<int>> runGenerator(const QString& name, int pattern, int rows, int cols, double density)
+    {
+        const QString caseName = QString("%1x%2-%3").arg(rows).arg(cols).arg(density, 0, 'f', 2);
+        QJsonObject record = baseRecord("generator", name, caseName, rows, cols);
+        record["density"] = density;
+
+        if (exhaustedSeries.contains(name)) {
+            emitRecord(skipped(record, "budget"));
+            return QVector<QVector<int>>();
+        }
+
+        const QPoint start(0, 0);
+        const QPoint end(cols - 1, rows - 1);
+        QVector<QVector<int>> cells;
+        bool connected = false;
+        Timing timing = measure(settings, [&]() {
+            // 每次重复使用相同的种子，保证每次生成的地图相同
+            QRandomGenerator generator(settings.seed);
+            ObstacleGenerator obstacleGenerator(rows, cols, start, end);
+            if (pattern == ObstacleGenerator::UniformNoise) {
+                connected = obstacleGenerator.generate(density, ObstacleGenerator::OnePath, 1, &generator) > 0;
+            } else {
+                connected = obstacleGenerator.generatePattern(pattern, density, &generator);
+            }
+            cells = obstacleGenerator.toCellStates();
+        });
+
+        int obstacles = 0;
+        for (const QVector<int>& row : cells) {
+            obstacles += std::count(row.begin(), row.end(), 1);
+        }
+
+        record["status"] = "ok";
+        record["seed"] = double(settings.seed);
+        record["runs"] = timing.runs;
+        record["minNs"] = double(timing.minNs);
+        record["medianNs"] = double(timing.medianNs);
+        record["obstacles"] = obstacles;
+        record["connected"] = connected;
+        emitRecord(record);
+
+        if (timing.medianNs > settings.budgetNs) {
+            exhaustedSeries.insert(name, true);
+        }
+        return cells;
+    }
+
+private:
+    // 同一个算法在一种格子存放方式下的一条记录；按行存放的记录键与加入存放方式之前相同
+    void runEngine(PathSearch::AlgorithmType algorithm, PathSearch::CellLayout layout, const QString& caseName,
+                   const QVector<QVector<int>>& grid, const QPoint& start, const QPoint& end, const QString& series)
+    {
+        const int rows = grid.size();
+        const int cols = rows > 0 ? grid[0].size() : 0;
+        QJsonObject record = baseRecord("engine", PathSearch::algorithmName(algorithm), caseName, rows, cols);
+        record["layout"] = layoutName(layout);
+        const QString seriesKey = series.isEmpty()
+            ? QString() : record["name"].toString() + "|" + layoutName(layout) + "|" + series;
+
+        if (exhaustedSeries.contains(seriesKey)) {
+            emitRecord(skipped(record, "budget"));
+            return;
+        }
+
+        PathSearch::SearchStats stats;
+        QList<QPoint> path;
+        Timing timing = measure(settings, [&]() {
+            path = PathSearch::runAlgorithm(algorithm, grid, start, end, &stats, nullptr, layout);
+        });
+
+        record["status"] = "ok";
+        record["runs"] = timing.runs;
+        record["minNs"] = double(timing.minNs);
+        record["medianNs"] = double(timing.medianNs);
+        record["nodesExpanded"] = stats.nodesExpanded;
+        record["nodesGenerated"] = stats.nodesGenerated;
+        record["peakOpenSize"] = stats.peakOpenSize;
+        record["workspaceBytes"] = double(stats.workspaceBytes);
+        record["setupNs"] = double(stats.setupTimeNs);
+        record["searchNs"] = double(stats.searchTimeNs);
+        record["reconstructionNs"] = double(stats.reconstructionTimeNs);
+        record["pathLength"] = path.isEmpty() ? -1 : path.size() - 1;
+        emitRecord(record);
+
+        if (!seriesKey.isEmpty() && timing.medianNs > settings.budgetNs) {
+            exhaustedSeries.insert(seriesKey, true);
+        }
+    }
+
+    QJsonObject baseRecord(const QString& kind, const QString& name, const QString& caseName, int rows, int cols)
+    {
+        QJsonObject record;
+        record["kind"] = kind;
+        record["name"] = name;
+        record["case"] = caseName;
+        record["rows"] = rows;
+        record["cols"] = cols;
+        return record;
+    }
+
+    QJsonObject skipped(QJsonObject record, const QString& reason)
+    {
+        record["status"] = "skipped";
+        record["reason"] = reason;
+        return record;
+    }
+
+    void emitRecord(const QJsonObject& record)
+    {
+        results.append(record);
+        out << QJsonDocument(record).toJson(QJsonDocument::Compact) << "\n";
+        out.flush();
+    }
+
+    BenchSettings settings;
+    QTextStream& out;
+    QHash<QString, bool> exhaustedSeries;
+    QVector<QJsonObject> results;
+};
+
+QString recordKey(const QJsonObject& record)
+{
+    QString key = record["kind"].toString() + "|" + record["name"].toString() + "|" + record["case"].toString();
+    const QString layout = record["layout"].toString();
+    if (!layout.isEmpty() && layout != layoutName(PathSearch::RowMajorLayout)) {
+        key += "|" + layout;
+    }
+    return key;
+}
+
+// 与基准逐条比较：计数必须一致；timeTolerance > 0 时，中位耗时（基准不短于 kMinTimedNs 的记录）
+// 不得超过基准的 (1 + timeTolerance) 倍，一条这样的记录都没有时也算失败
+int compareWithBaseline(const QVector<QJsonObject>& results, const QString& baselineFile,
+                        double timeTolerance, QTextStream& err)
+{
+    QFile file(baselineFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << QCoreApplication::translate("main", "无法读取基准文件: %1").arg(baselineFile) << Qt::endl;
+        return 1;
+    }
+
+    QHash<QString, QJsonObject> current;
+    for (const QJsonObject& record : results) {
+        current.insert(recordKey(record), record);
+    }
+
+    int failures = 0;
+    int compared = 0;
+    int timed = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        const QJsonObject baseline = QJsonDocument::fromJson(line).object();
+        const QString key = recordKey(baseline);
+        if (!current.contains(key)) {
+            err << "MISSING " << key << Qt::endl;
+            ++failures;
+            continue;
+        }
+
+        const QJsonObject record = current.value(key);
+        ++compared;
+        for (const char* field : kExactFields) {
+            if (baseline.contains(field) && baseline.value(field) != record.value(field)) {
+                err << "MISMATCH " << key << " " << field << ": "
+                    << QJsonDocument(QJsonObject{{"baseline", baseline.value(field)}}).toJson(QJsonDocument::Compact)
+                    << " -> "
+                    << QJsonDocument(QJsonObject{{"current", record.value(field)}}).toJson(QJsonDocument::Compact)
+                    << Qt::endl;
+                ++failures;
+            }
+        }
+
+        // 要求比较耗时而基准没有记录耗时（例如提交的只含计数的基准）时报错，不能当作通过
+        if (timeTolerance > 0 && (!baseline.contains("medianNs") || !record.contains("medianNs"))) {
+            err << "NO-TIMING " << key << Qt::endl;
+            ++failures;
+        } else if (timeTolerance > 0 && baseline["medianNs"].toDouble() >= kMinTimedNs) {
+            ++timed;
+            double limit = baseline["medianNs"].toDouble() * (1.0 + timeTolerance);
+            if (record["medianNs"].toDouble() > limit) {
+                err << "SLOWER " << key << ": " << baseline["medianNs"].toDouble() << " ns -> "
+                    << record["medianNs"].toDouble() << " ns" << Qt::endl;
+                ++failures;
+            }
+        }
+    }
+
+    if (timeTolerance > 0 && timed == 0) {
+        err << "NO-TIMED-RECORDS" << Qt::endl;
+        ++failures;
+    }
+    err << QCoreApplication::translate("main", "已比较 %1 条记录（%2 条比较了耗时），%3 处回归")
+               .arg(compared).arg(timed).arg(failures) << Qt::endl;
+    if (timeTolerance > 0 && failures > 0) {
+        err << QCoreApplication::translate("main", "比较耗时需要在本机用 -o 生成的带耗时的基准") << Qt::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("GridMapBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "寻路算法与地图生成器的性能基准"));
+    parser.addHelpOption();
+
+    QCommandLineOption sizesOption("sizes", QCoreApplication::translate("main", "栅格边长列表"), "list",
+                                   "64,128,256,512,1024,2048,4096,8192");
+    QCommandLineOption densitiesOption("densities", QCoreApplication::translate("main", "障碍物密度列表"), "list",
+                                       "0.1,0.2,0.3,0.4");
+    QCommandLineOption mapDirOption("map-dir", QCoreApplication::translate("main", "额外测试的地图文件目录"), "dir");
+    QCommandLineOption mapsOnlyOption("maps-only", QCoreApplication::translate("main", "只测试地图文件，不生成地图"));
+    QCommandLineOption repeatOption("repeat", QCoreApplication::translate("main", "每个用例的重复次数"), "n", "3");
+    QCommandLineOption budgetOption("budget-ms", QCoreApplication::translate("main", "单个用例的时间预算，超出后跳过同系列更大的尺寸"),
+                                    "ms", "2000");
+    QCommandLineOption seedOption("seed", QCoreApplication::translate("main", "生成地图使用的随机种子"), "seed", "12345");
+    QCommandLineOption outputOption({"o", "output"}, QCoreApplication::translate("main", "结果输出文件（默认标准输出）"), "file");
+    QCommandLineOption compareOption("compare", QCoreApplication::translate("main", "与基准文件比较，有回归时返回非零"), "file");
+    QCommandLineOption layoutsOption("layouts", QCoreApplication::translate("main", "内置算法的格子存放方式列表（rowmajor、tiled）"),
+                                     "list", "rowmajor");
+    QCommandLineOption toleranceOption("time-tolerance", QCoreApplication::translate("main", "允许的耗时增长比例（0 表示不比较耗时）"),
+                                       "ratio", "0");
+    parser.addOptions({sizesOption, densitiesOption, mapDirOption, mapsOnlyOption, repeatOption, budgetOption,
+                       seedOption, outputOption, compareOption, toleranceOption, layoutsOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    BenchSettings settings;
+    settings.repeat = qMax(1, parser.value(repeatOption).toInt());
+    settings.budgetNs = qMax(1LL, parser.value(budgetOption).toLongLong()) * 1000000LL;
+    settings.seed = parser.value(seedOption).toUInt();
+    settings.layouts.clear();
+    for (const QString& name : parser.value(layoutsOption).split(',', Qt::SkipEmptyParts)) {
+        if (name == layoutName(PathSearch::TiledLayout)) {
+            settings.layouts.append(PathSearch::TiledLayout);
+        } else if (name == layoutName(PathSearch::RowMajorLayout)) {
+            settings.layouts.append(PathSearch::RowMajorLayout);
+        } else {
+            err << QCoreApplication::translate("main", "未知的格子存放方式: %1").arg(name) << Qt::endl;
+            return 2;
+        }
+    }
+    if (settings.layouts.isEmpty()) {
+        settings.layouts.append(PathSearch::RowMajorLayout);
+    }
+
+    QFile outputFile;
+    QTextStream out(stdout);
+    if (parser.isSet(outputOption)) {
+        outputFile.setFileName(parser.value(outputOption));
+        if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            err << QCoreApplication::translate("main", "无法写入输出文件: %1").arg(outputFile.fileName()) << Qt::endl;
+            return 2;
+        }
+        out.setDevice(&outputFile);
+    }
+
+    Bench bench(settings, out);
+
+    // 生成的地图：起点左上角、终点右下角，随机噪声地图保证至少一条通路
+    if (!parser.isSet(mapsOnlyOption)) {
+        const QStringList sizes = parser.value(sizesOption).split(',', Qt::SkipEmptyParts);
+        const QStringList densities = parser.value(densitiesOption).split(',', Qt::SkipEmptyParts);
+
+        for (const QString& sizeText : sizes) {
+            const int size = sizeText.toInt();
+            if (size < 2) {
+                continue;
+            }
+            for (const QString& densityText : densities) {
+                const double density = qBound(0.0, densityText.toDouble(), 1.0);
+                QVector<QVector<int>> cells = bench.runGenerator("noise", ObstacleGenerator::UniformNoise,
+                                                                 size, size, density);
+                if (!cells.isEmpty()) {
+                    bench.runEngines(QString("noise-%1x%1-%2").arg(size).arg(density, 0, 'f', 2),
+                                     toEngineGrid(cells), QPoint(0, 0), QPoint(size - 1, size - 1),
+                                     QString("noise-%1").arg(density, 0, 'f', 2));
+                }
+            }
+
+            // 程序化生成器与密度关系不大，每个尺寸只测一次（洞穴使用典型的0.45）
+            bench.runGenerator("maze", ObstacleGenerator::Maze, size, size, 0.0);
+            bench.runGenerator("cave", ObstacleGenerator::Cave, size, size, 0.45);
+            bench.runGenerator("rooms", ObstacleGenerator::Rooms, size, size, 0.3);
+        }
+    }
+
+    // 地图文件：按文件名排序，保证输出顺序稳定
+    if (parser.isSet(mapDirOption)) {
+        QDir mapDir(parser.value(mapDirOption));
+        const QStringList files = mapDir.entryList({"*.json"}, QDir::Files, QDir::Name);
+        for (const QString& fileName : files) {
+            MapFile::MapData map;
+            QString errorMessage;
+            if (!MapFile::load(mapDir.filePath(fileName), &map, &errorMessage)) {
+                err << QCoreApplication::translate("main", "跳过无法读取的地图 %1: %2").arg(fileName, errorMessage) << Qt::endl;
+                continue;
+            }
+            if (map.startPos == QPoint(-1, -1) || map.endPos == QPoint(-1, -1)) {
+                err << QCoreApplication::translate("main", "跳过没有起点或终点的地图 %1").arg(fileName) << Qt::endl;
+                continue;
+            }
+            bench.runEngines("file:" + fileName, toEngineGrid(map.cells), map.startPos, map.endPos, QString());
+        }
+    }
+
+    if (parser.isSet(compareOption)) {
+        return compareWithBaseline(bench.records(), parser.value(compareOption),
+                                   parser.value(toleranceOption).toDouble(), err);
+    }
+    return 0;
+}
@@ -0,0 +1,232 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QRandomGenerator>
+#include "../include/gridmap.h"
+#include "../include/editjournal.h"
+#include "../include/mapdatasetgenerator.h"
+
+// 编辑记录的差分模糊测试：随机的笔画（逐格记录）、整块改动（按块比较前后版本）、撤销和重做，
+// 每一步之后的地图都要与保存的完整地图副本一致；同时检查撤销记录不超过预算、撤销后整块同一个值的块已收回
+// 一半的序列使用 --budget-bytes 给出的小预算，覆盖丢弃最早编辑和单个编辑超出预算的情况
+// 示例：GridMapJournalFuzz --iterations 2000 --seed 1 --max-size 150 --budget-bytes 2048
+
+namespace {
+
+// 路径显示的取值按空地记录（EditJournal::journalValue），这里只使用编辑器能画出的取值
+const int kValues[] = {GridMap::Empty, GridMap::Obstacle, GridMap::Start, GridMap::End};
+const int kValueCount = 4;
+
+enum Operation {
+    Stroke,
+    BulkEdit,
+    Undo,
+    Redo
+};
+
+const char* operationName(Operation operation)
+{
+    switch (operation) {
+        case Stroke:
+            return "stroke";
+        case BulkEdit:
+            return "bulk";
+        case Undo:
+            return "undo";
+        default:
+            return "redo";
+    }
+}
+
+bool sameCells(const GridMap& a, const GridMap& b)
+{
+    if (a.rows() != b.rows() || a.cols() != b.cols()) {
+        return false;
+    }
+    QVector<quint8> lineA(a.cols());
+    QVector<quint8> lineB(b.cols());
+    for (int y = 0; y < a.rows(); ++y) {
+        a.readRow(y, lineA.data());
+        b.readRow(y, lineB.data());
+        if (lineA != lineB) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 一次鼠标拖动：沿随机方向逐格写入，与 GridEditor 一样每格记录一次并收回变成同一个值的块
+bool stroke(GridMap* grid, EditJournal* journal, QRandomGenerator* generator)
+{
+    const int length = 1 + generator->bounded(30);
+    const int value = kValues[generator->bounded(kValueCount)];
+    int x = generator->bounded(grid->cols());
+    int y = generator->bounded(grid->rows());
+    bool changed = false;
+    journal->beginEdit();
+    for (int i = 0; i < length; ++i) {
+        if (generator->bounded(3) == 0) {
+            y = generator->bounded(grid->rows());
+        }
+        x = (x + generator->bounded(3) - 1 + grid->cols()) % grid->cols();
+        const int before = grid->cell(x, y);
+        const int after = generator->bounded(5) == 0 ? kValues[generator->bounded(kValueCount)] : value;
+        journal->record(x, y, before, after);
+        grid->setCell(x, y, after);
+        grid->compact(x, y, 1, 1);
+        changed = changed || before != after;
+    }
+    journal->endEdit();
+    return changed;
+}
+
+// 清空或生成：整张地图或一段整行改写，按块比较前后两个版本记录
+bool bulkEdit(GridMap* grid, EditJournal* journal, QRandomGenerator* generator)
+{
+    const GridMap before = *grid;
+    if (generator->bounded(2) == 0) {
+        grid->fill(kValues[generator->bounded(2)]);
+    } else {
+        const int top = generator->bounded(grid->rows());
+        const int height = 1 + generator->bounded(grid->rows());
+        const int value = kValues[generator->bounded(kValueCount)];
+        for (int y = top; y < grid->rows() && y < top + height; ++y) {
+            for (int x = 0; x < grid->cols(); ++x) {
+                grid->setCell(x, y, value);
+            }
+        }
+        grid->compact();
+    }
+    journal->recordDiff(before, *grid);
+    return !sameCells(before, *grid);
+}
+
+struct SequenceResult {
+    int steps = 0;
+    QString message;
+};
+
+// 第 index 个序列：种子由基础种子派生，任意一个序列都可以单独复现
+SequenceResult runSequence(quint64 baseSeed, int index, int maxSize, int stepCount, qint64 smallBudget)
+{
+    const quint64 seed = MapDatasetGenerator::mapSeed(baseSeed, index);
+    const quint32 seedWords[2] = {static_cast<quint32>(seed), static_cast<quint32>(seed >> 32)};
+    QRandomGenerator generator(seedWords, 2);
+
+    const int rows = 1 + generator.bounded(maxSize);
+    const int cols = 1 + generator.bounded(maxSize);
+    GridMap grid(rows, cols);
+    EditJournal journal;
+    const bool smallBudgetUsed = generator.bounded(2) == 0;
+    if (smallBudgetUsed) {
+        journal.setBudget(smallBudget);
+    }
+
+    // 每个编辑之后的完整地图副本，position 是当前地图在其中的位置
+    QVector<GridMap> history{grid};
+    int position = 0;
+
+    SequenceResult result;
+    for (int step = 0; step < stepCount; ++step) {
+        const int roll = generator.bounded(10);
+        const Operation operation = roll < 5 ? Stroke : roll < 6 ? BulkEdit : roll < 8 ? Undo : Redo;
+        bool changed = false;
+        switch (operation) {
+            case Stroke:
+                changed = stroke(&grid, &journal, &generator);
+                break;
+            case BulkEdit:
+                changed = bulkEdit(&grid, &journal, &generator);
+                break;
+            case Undo:
+                if (journal.undo(&grid, nullptr) && --position < 0) {
+                    result.message = QStringLiteral("undo went past the first version");
+                }
+                break;
+            case Redo:
+                if (journal.redo(&grid, nullptr) && ++position >= history.size()) {
+                    result.message = QStringLiteral("redo went past the latest version");
+                }
+                break;
+        }
+        ++result.steps;
+        if (changed) {
+            history.resize(position + 1);
+            history.append(grid);
+            ++position;
+        }
+
+        GridMap compacted = grid;
+        compacted.compact();
+        if (result.message.isEmpty() && !sameCells(grid, history.at(position))) {
+            result.message = QStringLiteral("map differs from the saved copy");
+        } else if (result.message.isEmpty() && compacted.allocatedChunks() != grid.allocatedChunks()) {
+            result.message = QStringLiteral("uniform chunks left allocated");
+        } else if (result.message.isEmpty() && journal.memoryBytes() > journal.budget()) {
+            result.message = QStringLiteral("journal uses %1 bytes, budget %2")
+                                 .arg(journal.memoryBytes()).arg(journal.budget());
+        } else if (result.message.isEmpty() && !smallBudgetUsed && position > 0 && !journal.canUndo()) {
+            result.message = QStringLiteral("undo history lost within the default budget");
+        }
+        if (!result.message.isEmpty()) {
+            result.message = QStringLiteral("step %1 (%2), %3x%4, budget %5: %6")
+                                 .arg(step).arg(operationName(operation)).arg(rows).arg(cols)
+                                 .arg(journal.budget()).arg(result.message);
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("GridMapJournalFuzz");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "撤销和重做的差分模糊测试（以完整地图副本为参考）"));
+    parser.addHelpOption();
+
+    QCommandLineOption iterationsOption({"n", "iterations"}, QCoreApplication::translate("main", "编辑序列数量"), "n", "1000");
+    QCommandLineOption stepsOption("steps", QCoreApplication::translate("main", "每个序列的操作数"), "n", "40");
+    QCommandLineOption seedOption("seed", QCoreApplication::translate("main", "基础随机种子"), "seed", "1");
+    QCommandLineOption maxSizeOption("max-size", QCoreApplication::translate("main", "地图最大边长"), "n", "150");
+    QCommandLineOption budgetOption("budget-bytes", QCoreApplication::translate("main", "一半序列使用的撤销记录预算（字节）"),
+                                    "bytes", "2048");
+    QCommandLineOption maxFailuresOption("max-failures", QCoreApplication::translate("main", "发现多少个差异后停止"), "n", "5");
+    parser.addOptions({iterationsOption, stepsOption, seedOption, maxSizeOption, budgetOption, maxFailuresOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const int stepCount = qMax(1, parser.value(stepsOption).toInt());
+    const quint64 baseSeed = parser.value(seedOption).toULongLong();
+    const int maxSize = qMax(1, parser.value(maxSizeOption).toInt());
+    const qint64 smallBudget = qMax(0LL, parser.value(budgetOption).toLongLong());
+    const int maxFailures = qMax(1, parser.value(maxFailuresOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int failures = 0;
+    int checked = 0;
+    qint64 steps = 0;
+    for (int index = 0; index < iterations && failures < maxFailures; ++index) {
+        const SequenceResult result = runSequence(baseSeed, index, maxSize, stepCount, smallBudget);
+        ++checked;
+        steps += result.steps;
+        if (result.message.isEmpty()) {
+            continue;
+        }
+        ++failures;
+        err << "FAIL sequence " << index << " (seed " << baseSeed << ") " << result.message << Qt::endl;
+    }
+
+    err << QCoreApplication::translate("main", "已检查 %1 个序列（%2 步），%3 个差异，用时 %4 ms")
+               .arg(checked).arg(steps).arg(failures).arg(timer.elapsed()) << Qt::endl;
+    return failures == 0 ? 0 : 1;
+}
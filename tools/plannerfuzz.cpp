@@ -0,0 +1,249 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QRandomGenerator>
+#include <QQueue>
+#include "../include/gridmap.h"
+#include "../include/incrementalplanner.h"
+#include "../include/mapdatasetgenerator.h"
+
+// 增量重新规划的差分模糊测试：同一个 IncrementalPlanner 上，起点沿上次的路径前进、随机切换格子的障碍后重新规划，
+// 每一步的路径都要合法，长度等于参考BFS的最短距离
+// 切换少量格子时走局部修复，一次切换超过地图 1/8 的格子时走整体重新搜索，偶尔换终点时重新开始
+// 示例：GridMapPlannerFuzz --iterations 2000 --seed 1 --max-size 64
+
+namespace {
+
+enum Operation {
+    Move,
+    Toggle,
+    BulkToggle,
+    NewGoal
+};
+
+const char* operationName(Operation operation)
+{
+    switch (operation) {
+        case Move:
+            return "move";
+        case Toggle:
+            return "toggle";
+        case BulkToggle:
+            return "bulk";
+        default:
+            return "goal";
+    }
+}
+
+bool isOpen(const GridMap& grid, const QPoint& pos)
+{
+    return grid.contains(pos) && !grid.isBlocked(pos.x(), pos.y());
+}
+
+// 参考实现：最简单的BFS，返回最短路径的步数，不连通返回 -1
+int referenceDistance(const GridMap& grid, const QPoint& start, const QPoint& goal)
+{
+    const int cols = grid.cols();
+    QVector<int> dist(grid.rows() * cols, -1);
+    QQueue<QPoint> queue;
+    dist[start.y() * cols + start.x()] = 0;
+    queue.enqueue(start);
+    const QPoint directions[] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    while (!queue.isEmpty()) {
+        const QPoint current = queue.dequeue();
+        const int d = dist[current.y() * cols + current.x()];
+        if (current == goal) {
+            return d;
+        }
+        for (const QPoint& dir : directions) {
+            const QPoint next = current + dir;
+            if (!isOpen(grid, next) || dist[next.y() * cols + next.x()] >= 0) {
+                continue;
+            }
+            dist[next.y() * cols + next.x()] = d + 1;
+            queue.enqueue(next);
+        }
+    }
+    return -1;
+}
+
+// 路径从起点走到终点、只走四邻域、不穿过障碍，返回错误描述
+QString validatePath(const GridMap& grid, const QPoint& start, const QPoint& goal, const QList<QPoint>& path)
+{
+    if (path.first() != start || path.last() != goal) {
+        return QStringLiteral("path does not run from start to goal");
+    }
+    for (int i = 0; i < path.size(); ++i) {
+        const QPoint& pos = path[i];
+        if (!isOpen(grid, pos)) {
+            return QStringLiteral("path crosses obstacle or leaves the map at (%1, %2)").arg(pos.x()).arg(pos.y());
+        }
+        if (i > 0) {
+            const QPoint& prev = path[i - 1];
+            if (qAbs(pos.x() - prev.x()) + qAbs(pos.y() - prev.y()) != 1) {
+                return QStringLiteral("discontinuous step (%1, %2) -> (%3, %4)")
+                    .arg(prev.x()).arg(prev.y()).arg(pos.x()).arg(pos.y());
+            }
+        }
+    }
+    return QString();
+}
+
+QPoint randomOpenCell(const GridMap& grid, QRandomGenerator* generator)
+{
+    for (;;) {
+        const QPoint pos(generator->bounded(grid.cols()), generator->bounded(grid.rows()));
+        if (isOpen(grid, pos)) {
+            return pos;
+        }
+    }
+}
+
+// 切换 count 个随机格子（起点和终点除外）的障碍
+void toggleCells(GridMap* grid, int count, const QPoint& start, const QPoint& goal, QRandomGenerator* generator)
+{
+    for (int i = 0; i < count; ++i) {
+        const QPoint pos(generator->bounded(grid->cols()), generator->bounded(grid->rows()));
+        if (pos != start && pos != goal) {
+            grid->setCell(pos.x(), pos.y(), grid->isBlocked(pos.x(), pos.y()) ? GridMap::Empty : GridMap::Obstacle);
+        }
+    }
+}
+
+struct SequenceResult {
+    int steps = 0;
+    int bulkEdits = 0;
+    QString message;
+};
+
+// 第 index 个序列：种子由基础种子派生，任意一个序列都可以单独复现
+SequenceResult runSequence(quint64 baseSeed, int index, int maxSize, int stepCount)
+{
+    const quint64 seed = MapDatasetGenerator::mapSeed(baseSeed, index);
+    const quint32 seedWords[2] = {static_cast<quint32>(seed), static_cast<quint32>(seed >> 32)};
+    QRandomGenerator generator(seedWords, 2);
+
+    const int rows = 2 + generator.bounded(qMax(1, maxSize - 1));
+    const int cols = 2 + generator.bounded(qMax(1, maxSize - 1));
+    GridMap grid(rows, cols);
+    const double density = generator.bounded(0.4);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            if (generator.generateDouble() < density) {
+                grid.setCell(x, y, GridMap::Obstacle);
+            }
+        }
+    }
+    // 至少留一个可通行的格子；起点和终点只取可通行的格子，编辑器也不会在障碍上规划
+    grid.setCell(0, 0, GridMap::Empty);
+    QPoint start = randomOpenCell(grid, &generator);
+    QPoint goal = randomOpenCell(grid, &generator);
+
+    IncrementalPlanner planner;
+    QList<QPoint> path;
+    SequenceResult result;
+    for (int step = 0; step < stepCount; ++step) {
+        Operation operation = Move;
+        if (step > 0) {
+            const int roll = generator.bounded(20);
+            operation = roll < 8 ? Move : roll < 17 ? Toggle : roll < 19 ? BulkToggle : NewGoal;
+        }
+        switch (operation) {
+            case Move:
+                // 小车沿上次的路径走几步，没有路径或已经到达时换一个起点
+                if (path.size() > 1) {
+                    start = path.at(qMin(int(path.size()) - 1, 1 + int(generator.bounded(3))));
+                } else {
+                    start = randomOpenCell(grid, &generator);
+                }
+                break;
+            case Toggle:
+                toggleCells(&grid, 1 + generator.bounded(4), start, goal, &generator);
+                break;
+            case BulkToggle:
+                // 切换约 1/4 的格子，变化超过 1/8 时规划器整体重新搜索
+                toggleCells(&grid, rows * cols / 4 + 1, start, goal, &generator);
+                ++result.bulkEdits;
+                break;
+            case NewGoal:
+                goal = randomOpenCell(grid, &generator);
+                break;
+        }
+        ++result.steps;
+
+        path = planner.plan(grid, start, goal, nullptr);
+        const int expected = referenceDistance(grid, start, goal);
+        if (path.isEmpty()) {
+            if (expected >= 0) {
+                result.message = QStringLiteral("no path, reference distance %1").arg(expected);
+            }
+        } else if (expected < 0) {
+            result.message = QStringLiteral("found a path of length %1 but goal is unreachable").arg(path.size() - 1);
+        } else {
+            result.message = validatePath(grid, start, goal, path);
+            if (result.message.isEmpty() && path.size() - 1 != expected) {
+                result.message = QStringLiteral("path length %1, shortest %2").arg(path.size() - 1).arg(expected);
+            }
+        }
+        if (!result.message.isEmpty()) {
+            result.message = QStringLiteral("step %1 (%2), %3x%4, start (%5, %6), goal (%7, %8): %9")
+                                 .arg(step).arg(operationName(operation)).arg(rows).arg(cols)
+                                 .arg(start.x()).arg(start.y()).arg(goal.x()).arg(goal.y())
+                                 .arg(result.message);
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("GridMapPlannerFuzz");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "增量重新规划的差分模糊测试（以BFS为参考）"));
+    parser.addHelpOption();
+
+    QCommandLineOption iterationsOption({"n", "iterations"}, QCoreApplication::translate("main", "规划序列数量"), "n", "1000");
+    QCommandLineOption stepsOption("steps", QCoreApplication::translate("main", "每个序列的操作数"), "n", "40");
+    QCommandLineOption seedOption("seed", QCoreApplication::translate("main", "基础随机种子"), "seed", "1");
+    QCommandLineOption maxSizeOption("max-size", QCoreApplication::translate("main", "地图最大边长"), "n", "64");
+    QCommandLineOption maxFailuresOption("max-failures", QCoreApplication::translate("main", "发现多少个差异后停止"), "n", "5");
+    parser.addOptions({iterationsOption, stepsOption, seedOption, maxSizeOption, maxFailuresOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const int stepCount = qMax(1, parser.value(stepsOption).toInt());
+    const quint64 baseSeed = parser.value(seedOption).toULongLong();
+    const int maxSize = qMax(2, parser.value(maxSizeOption).toInt());
+    const int maxFailures = qMax(1, parser.value(maxFailuresOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int failures = 0;
+    int checked = 0;
+    qint64 steps = 0;
+    qint64 bulkEdits = 0;
+    for (int index = 0; index < iterations && failures < maxFailures; ++index) {
+        const SequenceResult result = runSequence(baseSeed, index, maxSize, stepCount);
+        ++checked;
+        steps += result.steps;
+        bulkEdits += result.bulkEdits;
+        if (result.message.isEmpty()) {
+            continue;
+        }
+        ++failures;
+        err << "FAIL sequence " << index << " (seed " << baseSeed << ") " << result.message << Qt::endl;
+    }
+
+    err << QCoreApplication::translate("main", "已检查 %1 个序列（%2 步，其中 %3 步大范围改动），%4 个差异，用时 %5 ms")
+               .arg(checked).arg(steps).arg(bulkEdits).arg(failures).arg(timer.elapsed()) << Qt::endl;
+    return failures == 0 ? 0 : 1;
+}